@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "physics/Integrator.h"
+#include "physics/PhysicsConstants.h"
+
+#pragma once
+
+#ifndef _BENCHMARK_H_
+#define _BENCHMARK_H_
+
+namespace Bench {
+
+    // Keeps the optimizer from discarding a computed value.
+    template <typename T>
+    inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    struct Options {
+        double minBatchSeconds = 0.05;  // each timed batch runs at least this long
+        int warmupBatches = 1;          // untimed batches after calibration
+        int repetitions = 5;            // timed batches per benchmark
+        std::string filter;             // only run benchmarks whose name contains this
+    };
+
+    // One benchmark: `ops` units of work (pair interactions, steps, ...) per call.
+    struct Result {
+        std::string name;
+        std::string unit;                // what one op is, e.g. "pair" or "step"
+        double opsPerCall = 1.0;
+        long long callsPerBatch = 0;
+        int repetitions = 0;
+        std::vector<double> nsPerOp;     // one entry per repetition
+
+        double mean() const {
+            double sum = 0.0;
+            for (double v : nsPerOp) sum += v;
+            return nsPerOp.empty() ? 0.0 : sum / nsPerOp.size();
+        }
+        double stddev() const {
+            if (nsPerOp.size() < 2) return 0.0;
+            double m = mean(), sum = 0.0;
+            for (double v : nsPerOp) sum += (v - m) * (v - m);
+            return std::sqrt(sum / (nsPerOp.size() - 1));
+        }
+        double median() const {
+            std::vector<double> sorted = nsPerOp;
+            std::sort(sorted.begin(), sorted.end());
+            if (sorted.empty()) return 0.0;
+            size_t mid = sorted.size() / 2;
+            return sorted.size() % 2 ? sorted[mid] : 0.5 * (sorted[mid - 1] + sorted[mid]);
+        }
+        double min() const { return nsPerOp.empty() ? 0.0 : *std::min_element(nsPerOp.begin(), nsPerOp.end()); }
+        double max() const { return nsPerOp.empty() ? 0.0 : *std::max_element(nsPerOp.begin(), nsPerOp.end()); }
+        double opsPerSecond() const { double m = median(); return m > 0.0 ? 1e9 / m : 0.0; }
+    };
+
+    class Runner {
+    public:
+        explicit Runner(const Options& options) : options(options) {}
+
+        // Calibrates a batch size, warms up, then times `repetitions` batches.
+        // Returns false when the benchmark is filtered out.
+        bool run(const std::string& name, const std::string& unit, double opsPerCall, const std::function<void()>& fn) {
+            if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return false;
+
+            long long calls = 1;
+            for (;;) {
+                double seconds = timeBatch(fn, calls);
+                if (seconds >= options.minBatchSeconds || calls >= (1LL << 40)) break;
+                // Grow towards the target with some headroom, at most 10x per round.
+                double factor = seconds > 0.0 ? 1.4 * options.minBatchSeconds / seconds : 10.0;
+                calls = static_cast<long long>(calls * std::min(10.0, std::max(2.0, factor)));
+            }
+            for (int i = 0; i < options.warmupBatches; ++i) timeBatch(fn, calls);
+
+            Result result;
+            result.name = name;
+            result.unit = unit;
+            result.opsPerCall = opsPerCall;
+            result.callsPerBatch = calls;
+            result.repetitions = options.repetitions;
+            for (int i = 0; i < options.repetitions; ++i) {
+                double seconds = timeBatch(fn, calls);
+                result.nsPerOp.push_back(seconds * 1e9 / (static_cast<double>(calls) * opsPerCall));
+            }
+            results.push_back(result);
+            return true;
+        }
+
+        const std::vector<Result>& getResults() const { return results; }
+
+        void printTable(std::ostream& out) const {
+            out << "benchmark                                  median ns/op    cv%        ops/s  unit\n";
+            for (const Result& r : results) {
+                char line[256];
+                double cv = r.mean() > 0.0 ? 100.0 * r.stddev() / r.mean() : 0.0;
+                std::snprintf(line, sizeof(line), "%-40s %14.3f %6.2f %12.4g  %s\n",
+                    r.name.c_str(), r.median(), cv, r.opsPerSecond(), r.unit.c_str());
+                out << line;
+            }
+        }
+
+        void writeJson(std::ostream& out, const std::string& buildType) const {
+            out << "{\n  \"build_type\": \"" << buildType << "\",\n  \"benchmarks\": [";
+            for (size_t i = 0; i < results.size(); ++i) {
+                const Result& r = results[i];
+                out << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit
+                    << "\", \"ops_per_call\": " << r.opsPerCall
+                    << ", \"calls_per_batch\": " << r.callsPerBatch
+                    << ", \"repetitions\": " << r.repetitions
+                    << ", \"median_ns\": " << r.median()
+                    << ", \"mean_ns\": " << r.mean()
+                    << ", \"stddev_ns\": " << r.stddev()
+                    << ", \"min_ns\": " << r.min()
+                    << ", \"max_ns\": " << r.max()
+                    << ", \"ops_per_second\": " << r.opsPerSecond()
+                    << ", \"samples_ns\": [";
+                for (size_t k = 0; k < r.nsPerOp.size(); ++k) out << (k ? ", " : "") << r.nsPerOp[k];
+                out << "]}";
+            }
+            out << "\n  ]\n}\n";
+        }
+
+    private:
+        static double timeBatch(const std::function<void()>& fn, long long calls) {
+            auto start = std::chrono::steady_clock::now();
+            for (long long i = 0; i < calls; ++i) fn();
+            auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double>(end - start).count();
+        }
+
+        Options options;
+        std::vector<Result> results;
+    };
+
+    // Workloads shared by ThreeBodyBenchmarks and ThreeBodyPerfGate.
+
+    // Deterministic pseudo-random cluster within ~10 AU (same generator as the unit tests).
+    inline void makeCluster(size_t n, Physics::SystemState& state, std::vector<double>& masses) {
+        unsigned long long seed = 12345;
+        auto next = [&seed]() {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            return static_cast<double>(seed >> 11) / 9007199254740992.0 - 0.5;
+        };
+        state = Physics::SystemState(n);
+        masses.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            state.positions[i] = Vector3D(next(), next(), next()) * (20.0 * PhysicsConstants::AU);
+            state.velocities[i] = Vector3D(next(), next(), next()) * 3.0e4;
+            masses[i] = PhysicsConstants::SOLAR_MASS * (0.5 + next());
+        }
+    }
+
+    // Sun, an Earth-like planet and a Jupiter-like planet.
+    inline Physics::SystemState makeSolarSystem(std::vector<double>& masses) {
+        using PhysicsConstants::G;
+        using PhysicsConstants::AU;
+        using PhysicsConstants::SOLAR_MASS;
+        masses = { SOLAR_MASS, PhysicsConstants::EARTH_MASS, 1.9e27 };
+        Physics::SystemState state(3);
+        state.positions[1] = Vector3D(AU, 0, 0);
+        state.velocities[1] = Vector3D(0, std::sqrt(G * SOLAR_MASS / AU), 0);
+        state.positions[2] = Vector3D(0, 5.2 * AU, 0);
+        state.velocities[2] = Vector3D(-std::sqrt(G * SOLAR_MASS / (5.2 * AU)), 0, 0);
+        return state;
+    }
+
+} // namespace Bench
+
+#endif
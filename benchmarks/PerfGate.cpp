@@ -0,0 +1,234 @@
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "Benchmark.h"
+#include "physics/GravityEngine.h"
+#include "physics/Integrator.h"
+#include "physics/PhysicsConstants.h"
+#include "utils/Json.h"
+
+#ifndef THREEBODY_BENCH_BUILD_TYPE
+#define THREEBODY_BENCH_BUILD_TYPE ""
+#endif
+
+using namespace Physics;
+
+// Performance regression gate: runs a fixed set of workloads and compares their
+// best-of-N throughput against benchmarks/baseline.json. Throughput is recorded
+// relative to a calibration loop timed right before each workload, so the
+// baselines carry over between hosts of different speed. Baselines are kept per
+// build type (the empty key is an unoptimised build) because -O0 and -O2 change
+// the workloads and the calibration loop by different amounts.
+namespace {
+
+    // Self-contained floating-point kernel (softened inverse-cube sums over 32
+    // points in plain arrays). It shares no code with the workloads, so a
+    // regression in the engine cannot hide by slowing the reference too.
+    class Calibration {
+    public:
+        static const size_t POINTS = 32;
+
+        Calibration() {
+            for (size_t i = 0; i < POINTS; ++i) {
+                x[i] = std::sin(1.0 + i);
+                y[i] = std::cos(2.0 + 3.0 * i);
+                z[i] = std::sin(0.5 * i) * std::cos(1.0 * i);
+            }
+        }
+
+        // Nanoseconds per pair interaction, best of the runner's repetitions.
+        double measure(const Bench::Options& options) {
+            Bench::Runner runner(options);
+            runner.run("calibration", "pair", static_cast<double>(POINTS * (POINTS - 1)), [this]() {
+                for (size_t i = 0; i < POINTS; ++i) {
+                    double ax = 0.0, ay = 0.0, az = 0.0;
+                    for (size_t j = 0; j < POINTS; ++j) {
+                        if (j == i) continue;
+                        double dx = x[j] - x[i], dy = y[j] - y[i], dz = z[j] - z[i];
+                        double r2 = dx * dx + dy * dy + dz * dz + 1e-3;
+                        double inv = 1.0 / (r2 * std::sqrt(r2));
+                        ax += dx * inv;
+                        ay += dy * inv;
+                        az += dz * inv;
+                    }
+                    a[i] = ax + ay + az;
+                }
+                Bench::doNotOptimize(a);
+            });
+            return runner.getResults().front().min();
+        }
+
+    private:
+        double x[POINTS], y[POINTS], z[POINTS], a[POINTS];
+    };
+
+    // One workload timed right after its own calibration run.
+    struct Measurement {
+        Bench::Result result;
+        double calibrationNs = 0.0;
+
+        // Workload ops per calibration pair, i.e. throughput in units of the calibration loop.
+        double relative() const {
+            double best = result.min();
+            return best > 0.0 ? calibrationNs / best : 0.0;
+        }
+    };
+
+    void runThreeBody(Bench::Runner& runner, const char* name, Integrator::Method method) {
+        std::vector<double> masses;
+        SystemState state = Bench::makeSolarSystem(masses);
+        DerivativeFunction f = [&masses](const SystemState& s, SystemState& d) {
+            GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        };
+        Integrator integrator(method);
+        runner.run(name, "step", 1.0, [&]() {
+            integrator.step(state, f, 3600.0);
+            state.time += 3600.0;
+        });
+    }
+
+    void runPairs(Bench::Runner& runner, const char* name, size_t n) {
+        SystemState state, derivatives(n);
+        std::vector<double> masses;
+        Bench::makeCluster(n, state, masses);
+        runner.run(name, "pair", static_cast<double>(n) * (n - 1), [&]() {
+            GravityEngine::calculateGravitationalDerivatives(state, derivatives, masses);
+            Bench::doNotOptimize(derivatives.velocities[0]);
+        });
+    }
+
+    void printUsage() {
+        std::cout << "Usage: ThreeBodyPerfGate --baseline <file> [--threshold <fraction>] [--build-type <name>]\n"
+                  << "                         [--update] [--repetitions <n>] [--rounds <n>]\n"
+                  << "  Fails when a workload's throughput, relative to an in-process calibration loop, drops\n"
+                  << "  more than <fraction> (default 0.25) below the baseline. --update records the measured\n"
+                  << "  relative throughput as the new baseline instead.\n"
+                  << "  THREEBODY_PERF_THRESHOLD in the environment overrides --threshold.\n";
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string baselinePath;
+    std::string buildType = THREEBODY_BENCH_BUILD_TYPE;
+    double threshold = 0.25;
+    bool update = false;
+    Bench::Options options;
+    options.minBatchSeconds = 0.1;
+    options.repetitions = 3;
+    int rounds = 3;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--baseline" && hasValue) baselinePath = argv[++i];
+        else if (arg == "--threshold" && hasValue) threshold = std::atof(argv[++i]);
+        else if (arg == "--build-type" && hasValue) buildType = argv[++i];
+        else if (arg == "--repetitions" && hasValue) options.repetitions = std::atoi(argv[++i]);
+        else if (arg == "--rounds" && hasValue) rounds = std::atoi(argv[++i]);
+        else if (arg == "--update") update = true;
+        else {
+            printUsage();
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+    if (const char* env = std::getenv("THREEBODY_PERF_THRESHOLD")) {
+        threshold = std::atof(env);
+    }
+    if (baselinePath.empty() || threshold <= 0.0 || threshold >= 1.0 || options.repetitions < 1 || rounds < 1) {
+        printUsage();
+        return 2;
+    }
+
+    // Calibrate immediately before each workload so that clock changes during the run
+    // (frequency scaling, a noisy neighbour) affect both sides of the ratio alike, and
+    // keep the best of several rounds spread over the run.
+    const std::vector<std::function<void(Bench::Runner&)>> workloads = {
+        [](Bench::Runner& r) { runThreeBody(r, "rk4_three_body", Integrator::RUNGE_KUTTA_4); },
+        [](Bench::Runner& r) { runThreeBody(r, "verlet_three_body", Integrator::VERLET); },
+        [](Bench::Runner& r) { runPairs(r, "pairs_4096", 4096); },
+    };
+    Calibration calibration;
+    std::vector<Measurement> measurements(workloads.size());
+    for (int round = 0; round < rounds; ++round) {
+        for (size_t w = 0; w < workloads.size(); ++w) {
+            Measurement m;
+            m.calibrationNs = calibration.measure(options);
+            Bench::Runner runner(options);
+            workloads[w](runner);
+            m.result = runner.getResults().front();
+            if (round == 0 || m.relative() > measurements[w].relative()) measurements[w] = m;
+        }
+    }
+
+    try {
+        if (update) {
+            Utils::JsonValue root = Utils::JsonValue::object();
+            std::ifstream existing(baselinePath);
+            if (existing) {
+                existing.close();
+                root = Utils::JsonValue::parseFile(baselinePath);
+            }
+            Utils::JsonValue builds = root.find("builds") ? root.at("builds") : Utils::JsonValue::object();
+            Utils::JsonValue section = Utils::JsonValue::object();
+            for (const Measurement& m : measurements) {
+                Utils::JsonValue entry = Utils::JsonValue::object();
+                entry.set("unit", m.result.unit);
+                entry.set("relative_throughput", m.relative());
+                section.set(m.result.name, entry);
+            }
+            builds.set(buildType, section);
+            root.set("builds", builds);
+
+            std::ofstream out(baselinePath, std::ios::trunc);
+            if (!out) {
+                std::cerr << "Cannot write " << baselinePath << "\n";
+                return 1;
+            }
+            root.write(out);
+            std::cout << "Updated baseline '" << buildType << "' in " << baselinePath << "\n";
+            return 0;
+        }
+
+        Utils::JsonValue root = Utils::JsonValue::parseFile(baselinePath);
+        const Utils::JsonValue* section = root.at("builds").find(buildType);
+        if (section == nullptr) {
+            // Fall back to the unoptimised baseline, which can only be more lenient.
+            std::cout << "No baseline for build type '" << buildType << "', using the unoptimised baseline\n";
+            section = &root.at("builds").at("");
+        }
+
+        int failures = 0;
+        for (const Measurement& m : measurements) {
+            const Bench::Result& r = m.result;
+            const Utils::JsonValue* entry = section->find(r.name);
+            double measured = m.relative();
+            if (entry == nullptr) {
+                std::cout << "[  SKIP  ] " << r.name << ": no baseline\n";
+                continue;
+            }
+            double baseline = entry->at("relative_throughput").asNumber();
+            double ratio = measured / baseline;
+            bool ok = ratio >= 1.0 - threshold;
+            char line[256];
+            std::snprintf(line, sizeof(line), "[ %s ] %-20s %10.4g %s/cal  baseline %10.4g  (%+.1f%%, %.4g %s/s)\n",
+                ok ? "  OK  " : " FAIL ", r.name.c_str(), measured, r.unit.c_str(), baseline, 100.0 * (ratio - 1.0),
+                1e9 / r.min(), r.unit.c_str());
+            std::cout << line;
+            if (!ok) ++failures;
+        }
+        if (failures > 0) {
+            std::cerr << failures << " workload(s) regressed by more than " << 100.0 * threshold << "%\n";
+            return 1;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Perf gate failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
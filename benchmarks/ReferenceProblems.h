@@ -0,0 +1,119 @@
+#include <cmath>
+#include <string>
+#include <vector>
+#include "physics/Integrator.h"
+#include "physics/PhysicsConstants.h"
+
+#pragma once
+
+#ifndef _REFERENCEPROBLEMS_H_
+#define _REFERENCEPROBLEMS_H_
+
+namespace Bench {
+
+    // Canonical gravitational problems in N-body units. GravityEngine works in SI,
+    // so every mass is divided by G: with positions read as metres and times as
+    // seconds this gives G*m = m, i.e. the usual G = 1 formulation.
+    struct ReferenceProblem {
+        std::string name;
+        Physics::SystemState initial;
+        std::vector<double> masses;
+        double duration = 0.0;
+        double lengthScale = 1.0;        // phase error is reported relative to this
+        bool hasExactSolution = false;   // otherwise the harness computes a tight-tolerance reference
+        Physics::SystemState exact;      // state at initial.time + duration when known
+    };
+
+    inline std::vector<double> nbodyMasses(std::initializer_list<double> values) {
+        std::vector<double> masses;
+        for (double m : values) masses.push_back(m / PhysicsConstants::G);
+        return masses;
+    }
+
+    // Chenciner-Montgomery figure-eight choreography, one period.
+    inline ReferenceProblem figureEight() {
+        ReferenceProblem p;
+        p.name = "figure_eight";
+        p.masses = nbodyMasses({ 1.0, 1.0, 1.0 });
+        p.initial = Physics::SystemState(3);
+        p.initial.positions[0] = Vector3D(0.97000436, -0.24308753, 0.0);
+        p.initial.positions[1] = Vector3D(-0.97000436, 0.24308753, 0.0);
+        Vector3D v3(-0.93240737, -0.86473146, 0.0);
+        p.initial.velocities[0] = v3 * -0.5;
+        p.initial.velocities[1] = v3 * -0.5;
+        p.initial.velocities[2] = v3;
+        p.duration = 6.32591398;
+        return p;
+    }
+
+    // Burrau's Pythagorean problem (masses 3, 4, 5 at rest on a 3-4-5 triangle),
+    // up to t = 10, which already includes several close encounters.
+    inline ReferenceProblem pythagorean() {
+        ReferenceProblem p;
+        p.name = "pythagorean";
+        p.masses = nbodyMasses({ 3.0, 4.0, 5.0 });
+        p.initial = Physics::SystemState(3);
+        p.initial.positions[0] = Vector3D(1.0, 3.0, 0.0);
+        p.initial.positions[1] = Vector3D(-2.0, -1.0, 0.0);
+        p.initial.positions[2] = Vector3D(1.0, -1.0, 0.0);
+        p.duration = 10.0;
+        p.lengthScale = 3.0;
+        return p;
+    }
+
+    // Eccentric (e = 0.5) two-body orbit about the barycentre, three periods:
+    // the exact final state equals the initial one.
+    inline ReferenceProblem kepler() {
+        const double m1 = 1.0, m2 = 1e-3, e = 0.5, a = 1.0, total = m1 + m2;
+        const double pi = std::acos(-1.0);
+        ReferenceProblem p;
+        p.name = "kepler";
+        p.masses = nbodyMasses({ m1, m2 });
+        p.initial = Physics::SystemState(2);
+        Vector3D r(a * (1.0 - e), 0.0, 0.0);
+        Vector3D v(0.0, std::sqrt(total * (1.0 + e) / (a * (1.0 - e))), 0.0);
+        p.initial.positions[0] = r * (-m2 / total);
+        p.initial.positions[1] = r * (m1 / total);
+        p.initial.velocities[0] = v * (-m2 / total);
+        p.initial.velocities[1] = v * (m1 / total);
+        p.duration = 3.0 * 2.0 * pi * std::sqrt(a * a * a / total);
+        p.hasExactSolution = true;
+        p.exact = p.initial;
+        p.exact.time = p.initial.time + p.duration;
+        return p;
+    }
+
+    // Lagrange equilateral triangle of equal masses in rigid rotation, two periods.
+    // The configuration is linearly unstable, so errors grow exponentially.
+    inline ReferenceProblem lagrangeTriangle() {
+        const double side = 1.0, m = 1.0;
+        const double pi = std::acos(-1.0);
+        const double radius = side / std::sqrt(3.0);
+        const double omega = std::sqrt(3.0 * m / (side * side * side));
+
+        ReferenceProblem p;
+        p.name = "lagrange_triangle";
+        p.masses = nbodyMasses({ m, m, m });
+        p.initial = Physics::SystemState(3);
+        p.duration = 2.0 * 2.0 * pi / omega;
+        p.exact = Physics::SystemState(3);
+        p.hasExactSolution = true;
+        for (int k = 0; k < 3; ++k) {
+            double theta = 2.0 * pi * k / 3.0;
+            double phi = theta + omega * p.duration;
+            p.initial.positions[k] = Vector3D(radius * std::cos(theta), radius * std::sin(theta), 0.0);
+            p.initial.velocities[k] = Vector3D(-std::sin(theta), std::cos(theta), 0.0) * (omega * radius);
+            p.exact.positions[k] = Vector3D(radius * std::cos(phi), radius * std::sin(phi), 0.0);
+            p.exact.velocities[k] = Vector3D(-std::sin(phi), std::cos(phi), 0.0) * (omega * radius);
+        }
+        p.exact.time = p.initial.time + p.duration;
+        return p;
+    }
+
+    inline std::vector<ReferenceProblem> referenceProblems() {
+        return { figureEight(), pythagorean(), kepler(), lagrangeTriangle() };
+    }
+
+} // namespace Bench
+
+#endif
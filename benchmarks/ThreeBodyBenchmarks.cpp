@@ -0,0 +1,374 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include "Benchmark.h"
+#include "core/Vector3D.h"
+#include "physics/ChaosIndicator.h"
+#include "physics/CollisionDetector.h"
+#include "physics/EjectionDetector.h"
+#include "physics/FixedSystem.h"
+#include "physics/GravityEngine.h"
+#include "physics/Integrator.h"
+#include "physics/PhysicsConstants.h"
+#include "physics/TestParticles.h"
+#include "simulation/Ephemeris.h"
+#include "simulation/EraClassifier.h"
+#include "simulation/Insolation.h"
+#include "utils/ThreadPool.h"
+
+#ifndef THREEBODY_BENCH_BUILD_TYPE
+#define THREEBODY_BENCH_BUILD_TYPE ""
+#endif
+
+using namespace Physics;
+
+namespace {
+
+    struct Config {
+        Bench::Options options;
+        size_t maxBodies = 100000;
+        std::string jsonPath;
+    };
+
+    void benchVector(Bench::Runner& runner) {
+        const size_t n = 1024;
+        std::vector<Vector3D> a(n), b(n);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = Vector3D(1.0 + i, 2.0 - 0.5 * i, 0.25 * i);
+            b[i] = Vector3D(0.5 * i, 3.0, 1.0 + 0.125 * i);
+        }
+        const double ops = static_cast<double>(n);
+
+        runner.run("vector/add", "op", ops, [&]() {
+            Vector3D acc;
+            for (size_t i = 0; i < n; ++i) acc = acc + a[i];
+            Bench::doNotOptimize(acc);
+        });
+        runner.run("vector/sub_scale", "op", ops, [&]() {
+            Vector3D acc;
+            for (size_t i = 0; i < n; ++i) acc = acc + (a[i] - b[i]) * 0.5;
+            Bench::doNotOptimize(acc);
+        });
+        runner.run("vector/dot", "op", ops, [&]() {
+            double acc = 0.0;
+            for (size_t i = 0; i < n; ++i) acc += a[i].dot(b[i]);
+            Bench::doNotOptimize(acc);
+        });
+        runner.run("vector/cross", "op", ops, [&]() {
+            Vector3D acc;
+            for (size_t i = 0; i < n; ++i) acc = acc + a[i].cross(b[i]);
+            Bench::doNotOptimize(acc);
+        });
+        runner.run("vector/magnitude", "op", ops, [&]() {
+            double acc = 0.0;
+            for (size_t i = 0; i < n; ++i) acc += a[i].magnitude();
+            Bench::doNotOptimize(acc);
+        });
+        runner.run("vector/normalized", "op", ops, [&]() {
+            Vector3D acc;
+            for (size_t i = 0; i < n; ++i) acc = acc + a[i].normalized();
+            Bench::doNotOptimize(acc);
+        });
+    }
+
+    void benchPairKernel(Bench::Runner& runner) {
+        const size_t n = 256;
+        SystemState state;
+        std::vector<double> masses;
+        Bench::makeCluster(n, state, masses);
+
+        runner.run("force/pair", "pair", static_cast<double>(n - 1), [&]() {
+            Vector3D acc;
+            for (size_t j = 1; j < n; ++j) {
+                acc = acc + GravityEngine::calculateGravitationalForce(
+                    state.positions[0], masses[0], state.positions[j], masses[j]);
+            }
+            Bench::doNotOptimize(acc);
+        });
+        runner.run("force/net", "pair", static_cast<double>(n - 1), [&]() {
+            Vector3D f = GravityEngine::calculateNetForce(state.positions, masses, 0);
+            Bench::doNotOptimize(f);
+        });
+    }
+
+    void benchDerivatives(Bench::Runner& runner, const Config& config, Utils::ThreadPool& pool) {
+        for (size_t n = 3; n <= config.maxBodies; n = (n == 3 ? 10 : n * 10)) {
+            SystemState state, derivatives;
+            std::vector<double> masses;
+            Bench::makeCluster(n, state, masses);
+            derivatives = SystemState(n);
+            const std::string suffix = "/" + std::to_string(n);
+
+            runner.run("derivatives/double" + suffix, "eval", 1.0, [&]() {
+                GravityEngine::calculateGravitationalDerivatives(state, derivatives, masses);
+                Bench::doNotOptimize(derivatives.velocities[0]);
+            });
+            runner.run("derivatives/fused" + suffix, "eval", 1.0, [&]() {
+                ForceDiagnostics diagnostics;
+                GravityEngine::calculateGravitationalDerivatives(state, derivatives, masses, diagnostics);
+                Bench::doNotOptimize(diagnostics);
+            });
+
+            ExecutionPolicy mixed;
+            mixed.precision = ForcePrecision::MIXED;
+            runner.run("derivatives/mixed" + suffix, "eval", 1.0, [&]() {
+                GravityEngine::calculateGravitationalDerivatives(state, derivatives, masses, mixed);
+                Bench::doNotOptimize(derivatives.velocities[0]);
+            });
+
+            ExecutionPolicy parallel;
+            parallel.pool = &pool;
+            runner.run("derivatives/parallel" + suffix, "eval", 1.0, [&]() {
+                GravityEngine::calculateGravitationalDerivatives(state, derivatives, masses, parallel);
+                Bench::doNotOptimize(derivatives.velocities[0]);
+            });
+        }
+    }
+
+    void benchIntegrators(Bench::Runner& runner) {
+        struct Named { const char* name; Integrator::Method method; };
+        const Named methods[] = {
+            { "integrator/euler", Integrator::EULER },
+            { "integrator/rk4", Integrator::RUNGE_KUTTA_4 },
+            { "integrator/verlet", Integrator::VERLET },
+            { "integrator/dopri45", Integrator::DORMAND_PRINCE_45 }
+        };
+        for (const Named& m : methods) {
+            std::vector<double> masses;
+            SystemState state = Bench::makeSolarSystem(masses);
+            DerivativeFunction f = [&masses](const SystemState& s, SystemState& d) {
+                GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+            };
+            Integrator integrator(m.method);
+            runner.run(m.name, "step", 1.0, [&]() {
+                integrator.step(state, f, 3600.0);
+                state.time += 3600.0;
+            });
+            Bench::doNotOptimize(state.positions[1]);
+        }
+
+        // RK4 with the variational equations carried along (MEGNO / Lyapunov estimate).
+        {
+            std::vector<double> masses;
+            ChaosIndicator chaos(Bench::makeSolarSystem(masses), masses);
+            runner.run("integrator/rk4/variational", "step", 1.0, [&]() {
+                chaos.step(3600.0);
+            });
+            Bench::doNotOptimize(chaos.megno());
+        }
+
+        // Per-step escape test on a bound system (the common, negative case) and one analytic
+        // Kepler propagation of the kind that replaces integration after an ejection.
+        {
+            std::vector<double> masses;
+            SystemState state = Bench::makeSolarSystem(masses);
+            EjectionDetector detector(masses);
+            EjectionEvent event;
+            bool found = false;
+            runner.run("ejection/check", "check", 1.0, [&]() {
+                found ^= detector.check(state, event);
+            });
+            Bench::doNotOptimize(found);
+
+            Vector3D r = state.positions[2] - state.positions[0];
+            Vector3D v = state.velocities[2] - state.velocities[0];
+            const double mu = PhysicsConstants::G * (masses[0] + masses[2]);
+            runner.run("ejection/kepler", "propagate", 1.0, [&]() {
+                propagateKepler(r, v, mu, 86400.0);
+            });
+            Bench::doNotOptimize(r);
+        }
+
+        // Same three-body system through the compile-time N=3 path.
+        for (const Named& m : methods) {
+            std::vector<double> masses;
+            FixedSystemState<3> state(Bench::makeSolarSystem(masses));
+            FixedIntegrator<3> integrator(FixedGravity<3>(masses), m.method);
+            runner.run(std::string(m.name) + "/fixed3", "step", 1.0, [&]() {
+                integrator.step(state, 3600.0);
+                state.time += 3600.0;
+            });
+            Bench::doNotOptimize(state.positions[1]);
+        }
+    }
+
+    void benchCollisions(Bench::Runner& runner, const Config& config) {
+        for (size_t n = 1000; n <= config.maxBodies; n *= 10) {
+            SystemState state;
+            std::vector<double> masses;
+            Bench::makeCluster(n, state, masses);
+            // One day of motion at the cluster's velocities, bodies the size of large planets.
+            std::vector<Vector3D> previous = state.positions;
+            std::vector<double> radii(n, 5.0e7);
+            for (size_t i = 0; i < n; ++i) state.positions[i] = state.positions[i] + state.velocities[i] * 86400.0;
+
+            CollisionDetector detector;
+            const std::string suffix = "/" + std::to_string(n);
+            runner.run("collisions/grid" + suffix, "body", static_cast<double>(n), [&]() {
+                Bench::doNotOptimize(detector.detect(previous, state.positions, radii).size());
+            });
+            if (n <= 10000) {
+                runner.run("collisions/brute" + suffix, "body", static_cast<double>(n), [&]() {
+                    Bench::doNotOptimize(CollisionDetector::detectBruteForce(previous, state.positions, radii).size());
+                });
+            }
+        }
+    }
+
+    // Three suns plus N massless planets, compared with N planets as full bodies (derivatives/double).
+    void benchTestParticles(Bench::Runner& runner, const Config& config, Utils::ThreadPool& pool) {
+        for (size_t n = 1000; n <= config.maxBodies; n *= 10) {
+            SystemState cluster;
+            std::vector<double> clusterMasses;
+            Bench::makeCluster(n + 3, cluster, clusterMasses);
+            SystemState suns(3);
+            std::vector<double> masses(clusterMasses.begin(), clusterMasses.begin() + 3);
+            TestParticleSwarm swarm;
+            swarm.reserve(n);
+            for (size_t i = 0; i < 3; ++i) {
+                suns.positions[i] = cluster.positions[i];
+                suns.velocities[i] = cluster.velocities[i];
+            }
+            for (size_t i = 3; i < n + 3; ++i) swarm.add(cluster.positions[i], cluster.velocities[i]);
+
+            const std::string suffix = "/" + std::to_string(n);
+            runner.run("swarm/step" + suffix, "particle", static_cast<double>(n), [&]() {
+                swarm.step(suns, suns, masses, 60.0);
+            });
+            runner.run("swarm/step_parallel" + suffix, "particle", static_cast<double>(n), [&]() {
+                swarm.step(suns, suns, masses, 60.0, &pool);
+            });
+            Bench::doNotOptimize(swarm.getPosition(0));
+        }
+    }
+
+    // Insolation timeline for the Earth-like planet of makeSolarSystem, read from a one-year ephemeris.
+    void benchInsolation(Bench::Runner& runner) {
+        std::vector<double> masses;
+        SystemState state = Bench::makeSolarSystem(masses);
+        DerivativeFunction f = [&masses](const SystemState& s, SystemState& d) {
+            GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        };
+        Integrator integrator(Integrator::RUNGE_KUTTA_4);
+        std::vector<SystemState> trajectory{ state };
+        const double year = PhysicsConstants::yearsToSeconds(1);
+        integrator.advance(state, f, year, 3600.0, [&](const SystemState& s) {
+            if (std::fmod(s.time, PhysicsConstants::DAY_SECONDS) < 1.0) trajectory.push_back(s);
+        });
+        Simulation::Ephemeris ephemeris = Simulation::Ephemeris::fit(trajectory, { "Sun", "Earth", "Jupiter" }, masses);
+
+        Simulation::CalendarConfig calendar;
+        calendar.planetIndex = 1;
+        Simulation::InsolationOptions options;
+        options.endTime = trajectory.back().time;
+        options.outputStep = options.endTime / 100000.0;
+        Simulation::InsolationTimeline timeline(calendar, masses, options,
+            [&ephemeris](double t, SystemState& s) { ephemeris.evaluateAll(t, s); });
+
+        const size_t n = options.chunkSamples;
+        Simulation::InsolationChunk chunk;
+        size_t next = 0;
+        runner.run("insolation/chunk", "sample", static_cast<double>(n), [&]() {
+            timeline.computeChunk(next, n, chunk);
+            next = (next + n) % (timeline.sampleCount() - n);
+        });
+
+        std::ostringstream out;
+        Simulation::InsolationWriter csv(out, Simulation::InsolationFormat::CSV, { "Sun", "Jupiter" });
+        runner.run("insolation/write_csv", "sample", static_cast<double>(n), [&]() {
+            out.str(std::string());
+            csv(chunk);
+        });
+        Simulation::InsolationWriter binary(out, Simulation::InsolationFormat::BINARY, { "Sun", "Jupiter" });
+        runner.run("insolation/write_binary", "sample", static_cast<double>(n), [&]() {
+            out.str(std::string());
+            binary(chunk);
+        });
+    }
+
+    // Streaming era classification of the Earth-like planet, fed from a pre-integrated year.
+    void benchEraClassifier(Bench::Runner& runner) {
+        std::vector<double> masses;
+        SystemState state = Bench::makeSolarSystem(masses);
+        DerivativeFunction f = [&masses](const SystemState& s, SystemState& d) {
+            GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        };
+        std::vector<SystemState> trajectory;
+        Integrator(Integrator::RUNGE_KUTTA_4).advance(state, f, PhysicsConstants::yearsToSeconds(1),
+            PhysicsConstants::DAY_SECONDS / 4.0, [&](const SystemState& s) { trajectory.push_back(s); });
+
+        Simulation::CalendarConfig calendar;
+        calendar.planetIndex = 1;
+        Simulation::EraClassifier classifier(calendar, masses);
+        size_t next = 0;
+        runner.run("era/push", "step", 1.0, [&]() {
+            classifier.push(trajectory[next]);
+            next = (next + 1) % trajectory.size();
+        });
+        Bench::doNotOptimize(classifier.currentEra());
+    }
+
+    void printUsage() {
+        std::cout << "Usage: ThreeBodyBenchmarks [--json <file>] [--filter <substring>] [--max-n <bodies>]\n"
+                  << "                           [--repetitions <n>] [--min-time <seconds>] [--warmup <batches>] [--quick]\n";
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        auto value = [&](const char* flag) -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << flag << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+        if (std::strcmp(argv[i], "--json") == 0) config.jsonPath = value("--json");
+        else if (std::strcmp(argv[i], "--filter") == 0) config.options.filter = value("--filter");
+        else if (std::strcmp(argv[i], "--max-n") == 0) config.maxBodies = std::strtoull(value("--max-n"), nullptr, 10);
+        else if (std::strcmp(argv[i], "--repetitions") == 0) config.options.repetitions = std::atoi(value("--repetitions"));
+        else if (std::strcmp(argv[i], "--min-time") == 0) config.options.minBatchSeconds = std::atof(value("--min-time"));
+        else if (std::strcmp(argv[i], "--warmup") == 0) config.options.warmupBatches = std::atoi(value("--warmup"));
+        else if (std::strcmp(argv[i], "--quick") == 0) {
+            config.maxBodies = 1000;
+            config.options.repetitions = 3;
+            config.options.minBatchSeconds = 0.01;
+        } else {
+            printUsage();
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+    if (config.options.repetitions < 1) {
+        std::cerr << "--repetitions must be at least 1\n";
+        return 2;
+    }
+
+    Utils::ThreadPool pool;
+    Bench::Runner runner(config.options);
+    benchVector(runner);
+    benchPairKernel(runner);
+    benchDerivatives(runner, config, pool);
+    benchIntegrators(runner);
+    benchCollisions(runner, config);
+    benchTestParticles(runner, config, pool);
+    benchInsolation(runner);
+    benchEraClassifier(runner);
+
+    runner.printTable(std::cout);
+
+    if (!config.jsonPath.empty()) {
+        std::ofstream out(config.jsonPath);
+        if (!out) {
+            std::cerr << "Cannot write " << config.jsonPath << "\n";
+            return 1;
+        }
+        runner.writeJson(out, THREEBODY_BENCH_BUILD_TYPE);
+        std::cout << "Wrote " << runner.getResults().size() << " results to " << config.jsonPath << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,208 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include "ReferenceProblems.h"
+#include "physics/GravityEngine.h"
+
+using namespace Physics;
+
+namespace {
+
+    struct Run {
+        std::string problem;
+        std::string method;
+        double parameter = 0.0;          // step size for fixed-step runs, tolerance for adaptive runs
+        size_t steps = 0;
+        size_t rejected = 0;
+        size_t evaluations = 0;
+        double wallSeconds = 0.0;
+        double energyError = 0.0;
+        double phaseError = 0.0;
+    };
+
+    double totalEnergy(const SystemState& s, const std::vector<double>& masses) {
+        return GravityEngine::calculateTotalEnergy(s.positions, s.velocities, masses);
+    }
+
+    double phaseError(const SystemState& s, const SystemState& reference, double lengthScale) {
+        double err = 0.0;
+        for (size_t i = 0; i < s.positions.size(); ++i) {
+            double d = (s.positions[i] - reference.positions[i]).magnitude();
+            if (!std::isfinite(d)) return std::numeric_limits<double>::infinity();
+            err = std::max(err, d);
+        }
+        return err / lengthScale;
+    }
+
+    void finish(Run& run, const SystemState& final, const Bench::ReferenceProblem& p, const SystemState& reference,
+        double initialEnergy) {
+        double energy = totalEnergy(final, p.masses);
+        run.energyError = std::isfinite(energy) ? std::fabs((energy - initialEnergy) / initialEnergy)
+                                                : std::numeric_limits<double>::infinity();
+        run.phaseError = phaseError(final, reference, p.lengthScale);
+    }
+
+    Run runFixed(const Bench::ReferenceProblem& p, const SystemState& reference, Integrator::Method method,
+        const char* name, size_t steps) {
+        size_t evaluations = 0;
+        DerivativeFunction f = [&p, &evaluations](const SystemState& s, SystemState& d) {
+            ++evaluations;
+            GravityEngine::calculateGravitationalDerivatives(s, d, p.masses);
+        };
+
+        Run run;
+        run.problem = p.name;
+        run.method = name;
+        run.parameter = p.duration / steps;
+        run.steps = steps;
+
+        SystemState state = p.initial;
+        Integrator integrator(method);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < steps; ++i) {
+            integrator.step(state, f, run.parameter);
+            state.time += run.parameter;
+        }
+        run.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        run.evaluations = evaluations;
+        finish(run, state, p, reference, totalEnergy(p.initial, p.masses));
+        return run;
+    }
+
+    Run runAdaptive(const Bench::ReferenceProblem& p, const SystemState& reference, double tolerance) {
+        DerivativeFunction f = [&p](const SystemState& s, SystemState& d) {
+            GravityEngine::calculateGravitationalDerivatives(s, d, p.masses);
+        };
+        AdaptiveOptions options;
+        options.relativeTolerance = tolerance;
+
+        Run run;
+        run.problem = p.name;
+        run.method = "dopri45_adaptive";
+        run.parameter = tolerance;
+
+        SystemState state = p.initial;
+        auto start = std::chrono::steady_clock::now();
+        try {
+            AdaptiveStats stats = Integrator::integrateAdaptive(state, f, p.duration, options);
+            run.steps = stats.acceptedSteps;
+            run.rejected = stats.rejectedSteps;
+            run.evaluations = stats.evaluations;
+            finish(run, state, p, reference, totalEnergy(p.initial, p.masses));
+        } catch (const std::runtime_error&) {
+            // Loose tolerances can run into a spurious collision and stall; record the run as failed.
+            run.energyError = std::numeric_limits<double>::infinity();
+            run.phaseError = std::numeric_limits<double>::infinity();
+        }
+        run.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return run;
+    }
+
+    SystemState referenceSolution(const Bench::ReferenceProblem& p) {
+        if (p.hasExactSolution) return p.exact;
+        DerivativeFunction f = [&p](const SystemState& s, SystemState& d) {
+            GravityEngine::calculateGravitationalDerivatives(s, d, p.masses);
+        };
+        AdaptiveOptions options;
+        options.relativeTolerance = 1e-14;
+        SystemState state = p.initial;
+        Integrator::integrateAdaptive(state, f, p.duration, options);
+        return state;
+    }
+
+    void writeCsv(std::ostream& out, const std::vector<Run>& runs) {
+        out.precision(10);
+        out << "problem,method,parameter,steps,rejected,evaluations,wall_seconds,energy_error,phase_error\n";
+        for (const Run& r : runs) {
+            out << r.problem << ',' << r.method << ',' << r.parameter << ',' << r.steps << ',' << r.rejected << ','
+                << r.evaluations << ',' << r.wallSeconds << ',' << r.energyError << ',' << r.phaseError << '\n';
+        }
+    }
+
+    // For each problem and target phase error, the cheapest run (in force evaluations) of every method.
+    void printSummary(std::ostream& out, const std::vector<Run>& runs, const std::vector<double>& targets) {
+        out << "\nForce evaluations needed to reach a phase error (\"-\" = not reached in the sweep)\n";
+        std::vector<std::string> problems, methods;
+        for (const Run& r : runs) {
+            if (std::find(problems.begin(), problems.end(), r.problem) == problems.end()) problems.push_back(r.problem);
+            if (std::find(methods.begin(), methods.end(), r.method) == methods.end()) methods.push_back(r.method);
+        }
+        for (const std::string& problem : problems) {
+            out << problem << "\n";
+            for (double target : targets) {
+                out << "  <= " << target << ":";
+                for (const std::string& method : methods) {
+                    size_t best = 0;
+                    for (const Run& r : runs) {
+                        if (r.problem == problem && r.method == method && r.phaseError <= target &&
+                            (best == 0 || r.evaluations < best)) {
+                            best = r.evaluations;
+                        }
+                    }
+                    out << "  " << method << "=" << (best ? std::to_string(best) : std::string("-"));
+                }
+                out << "\n";
+            }
+        }
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string csvPath, filter;
+    int fixedLevels = 10;
+    int toleranceLevels = 10;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csvPath = argv[++i];
+        else if (std::strcmp(argv[i], "--problem") == 0 && i + 1 < argc) filter = argv[++i];
+        else if (std::strcmp(argv[i], "--quick") == 0) { fixedLevels = 5; toleranceLevels = 5; }
+        else {
+            std::cout << "Usage: ThreeBodyWorkPrecision [--csv <file>] [--problem <name>] [--quick]\n";
+            return std::strcmp(argv[i], "--help") == 0 ? 0 : 2;
+        }
+    }
+
+    struct Named { const char* name; Integrator::Method method; };
+    const Named methods[] = {
+        { "euler", Integrator::EULER },
+        { "rk4", Integrator::RUNGE_KUTTA_4 },
+        { "verlet", Integrator::VERLET },
+        { "dopri45_fixed", Integrator::DORMAND_PRINCE_45 }
+    };
+
+    std::vector<Run> runs;
+    for (const Bench::ReferenceProblem& p : Bench::referenceProblems()) {
+        if (!filter.empty() && p.name != filter) continue;
+        SystemState reference = referenceSolution(p);
+
+        // Fixed-step sweep: 64, 128, ... steps over the whole interval.
+        for (const Named& m : methods) {
+            for (int level = 0; level < fixedLevels; ++level) {
+                runs.push_back(runFixed(p, reference, m.method, m.name, size_t(64) << level));
+            }
+        }
+        // Tolerance sweep: 1e-3 down to 1e-12.
+        for (int level = 0; level < toleranceLevels; ++level) {
+            runs.push_back(runAdaptive(p, reference, std::pow(10.0, -3.0 - level * 9.0 / std::max(1, toleranceLevels - 1))));
+        }
+        std::cerr << "finished " << p.name << "\n";
+    }
+
+    if (csvPath.empty()) {
+        writeCsv(std::cout, runs);
+    } else {
+        std::ofstream out(csvPath);
+        if (!out) {
+            std::cerr << "Cannot write " << csvPath << "\n";
+            return 1;
+        }
+        writeCsv(out, runs);
+    }
+    printSummary(std::cerr, runs, { 1e-3, 1e-6, 1e-9 });
+    return 0;
+}
@@ -3,39 +3,96 @@
 #include <string>
 #endif
 
+#include <cmath>
+
 #pragma once
 
 #ifndef _VECTOR3D_H_
 #define _VECTOR3D_H_
 
 
+// ȫͷļУconstexpr·ϲ뵥Ԫ
 class Vector3D {
 public:
     double x, y, z;
 
     // 캯
-    Vector3D(double x = 0.0, double y = 0.0, double z = 0.0);
+    constexpr Vector3D(double x = 0.0, double y = 0.0, double z = 0.0) : x(x), y(y), z(z) {}
 
     // 
-    Vector3D operator+(const Vector3D& other) const;
-    Vector3D operator-(const Vector3D& other) const;
-    Vector3D operator*(double scalar) const;
-    Vector3D operator/(double scalar) const;
+    constexpr Vector3D operator+(const Vector3D& other) const {
+        return Vector3D(x + other.x, y + other.y, z + other.z);
+    }
+    constexpr Vector3D operator-(const Vector3D& other) const {
+        return Vector3D(x - other.x, y - other.y, z - other.z);
+    }
+    constexpr Vector3D operator-() const {
+        return Vector3D(-x, -y, -z);
+    }
+    constexpr Vector3D operator*(double scalar) const {
+        return Vector3D(x * scalar, y * scalar, z * scalar);
+    }
+    // Ϊ 0 ʱԭ·ӦóԵ
+    constexpr Vector3D operator/(double scalar) const {
+        return scalar == 0.0 ? *this : Vector3D(x / scalar, y / scalar, z / scalar);
+    }
+
+    constexpr Vector3D& operator+=(const Vector3D& other) {
+        x += other.x; y += other.y; z += other.z;
+        return *this;
+    }
+    constexpr Vector3D& operator-=(const Vector3D& other) {
+        x -= other.x; y -= other.y; z -= other.z;
+        return *this;
+    }
+    constexpr Vector3D& operator*=(double scalar) {
+        x *= scalar; y *= scalar; z *= scalar;
+        return *this;
+    }
+
+    // ں㣺*this += v * sʱ󣨿 FMA ʱÿΪһ FMA
+    constexpr Vector3D& addScaled(const Vector3D& v, double s) {
+        x += v.x * s; y += v.y * s; z += v.z * s;
+        return *this;
+    }
+
+    // base + v * s
+    static constexpr Vector3D axpy(const Vector3D& base, const Vector3D& v, double s) {
+        return Vector3D(base.x + v.x * s, base.y + v.y * s, base.z + v.z * s);
+    }
 
     // 
-    double dot(const Vector3D& other) const;
-    Vector3D cross(const Vector3D& other) const;
-    double magnitude() const;
-    double magnitudeSquared() const;
-    Vector3D normalized() const;
+    constexpr double dot(const Vector3D& other) const {
+        return x * other.x + y * other.y + z * other.z;
+    }
+    constexpr Vector3D cross(const Vector3D& other) const {
+        return Vector3D(
+            y * other.z - z * other.y,
+            z * other.x - x * other.z,
+            x * other.y - y * other.x
+        );
+    }
+    double magnitude() const {
+        return std::sqrt(x * x + y * y + z * z);
+    }
+    constexpr double magnitudeSquared() const {
+        return x * x + y * y + z * z;
+    }
+    Vector3D normalized() const {
+        double mag = magnitude();
+        if (mag == 0.0) return Vector3D(0, 0, 0);
+        return *this * (1.0 / mag);
+    }
 
     // ʵú
-    double distanceTo(const Vector3D& other) const;
-    static Vector3D zero();
-    static Vector3D one();
+    double distanceTo(const Vector3D& other) const {
+        return (*this - other).magnitude();
+    }
+    static constexpr Vector3D zero() { return Vector3D(0, 0, 0); }
+    static constexpr Vector3D one() { return Vector3D(1, 1, 1); }
 
     // ַʾ
     std::string toString() const;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -31,12 +31,12 @@ public:
     virtual void updateVelocity(double dt);
 
     // Getter/Setter
-    std::string getName() const { return name; }
+    const std::string& getName() const { return name; }
     double getMass() const { return mass; }
     double getRadius() const { return radius; }
-    Vector3D getPosition() const { return position; }
-    Vector3D getVelocity() const { return velocity; }
-    Vector3D getAcceleration() const { return acceleration; }
+    const Vector3D& getPosition() const { return position; }
+    const Vector3D& getVelocity() const { return velocity; }
+    const Vector3D& getAcceleration() const { return acceleration; }
 
     void setPosition(const Vector3D& pos) { position = pos; }
     void setVelocity(const Vector3D& vel) { velocity = vel; }
@@ -0,0 +1,80 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_CSTDINT_
+#define _INCLUDE_CSTDINT_
+#include <cstdint>
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#pragma once
+
+#ifndef _CHAOSINDICATOR_H_
+#define _CHAOSINDICATOR_H_
+
+namespace Physics {
+
+    // 随轨道一起积分变分方程，给出 MEGNO 与最大 Lyapunov 指数的估计
+    //
+    // 系统与切向量拼成 2n 个“天体”的增广状态，由 GravityEngine::calculateVariationalDerivatives
+    // 在一次成对循环中同时求导，代价约为普通受力计算的两倍，远低于两条影子轨道。
+    // 切向量的范数取 |δr|^2 + τ^2 |δv|^2，τ 为初始构型的动力学时间 sqrt(L^3 / (G M))。
+    // 准周期轨道的 <Y> 趋于 2，混沌轨道随时间近似按 λt/2 增长
+    class ChaosIndicator {
+    public:
+        // seed 决定初始切向量（单位范数的伪随机方向）
+        ChaosIndicator(const SystemState& initial,
+            const std::vector<double>& masses,
+            Integrator::Method method = Integrator::RUNGE_KUTTA_4,
+            uint64_t seed = 1);
+
+        // 推进一步（推进时间），并更新各指标
+        void step(double dt);
+
+        // 多步推进，每步结束后以系统本身的状态调用 onStep（可为空）
+        void advance(double totalTime, double timeStep, const StepCallback& onStep = nullptr);
+
+        // 系统本身的状态（不含切向量）
+        SystemState getState() const;
+        const Vector3D& getPosition(size_t body) const { return augmented.positions[body]; }
+        const Vector3D& getVelocity(size_t body) const { return augmented.velocities[body]; }
+        double getTime() const { return augmented.time; }
+        size_t size() const { return masses.size(); }
+
+        // 时间平均 MEGNO <Y>(t)，以及未平均的 Y(t)
+        double megno() const { return elapsed() > 0.0 ? megnoIntegral / elapsed() : 0.0; }
+        double megnoInstant() const { return instant; }
+
+        // 最大 Lyapunov 指数 ln(|δ(t)| / |δ(0)|) / t (1/s)，以及 MEGNO 斜率给出的估计 2<Y>/t
+        double lyapunovExponent() const { return elapsed() > 0.0 ? logGrowth / elapsed() : 0.0; }
+        double lyapunovFromMegno() const { return elapsed() > 0.0 ? 2.0 * megno() / elapsed() : 0.0; }
+
+        double getTimeScale() const { return timeScale; }
+
+    private:
+        double elapsed() const { return augmented.time - startTime; }
+        double tangentNorm() const;
+        void rescaleTangent(double factor);
+
+        std::vector<double> masses;
+        Integrator integrator;
+        SystemState augmented;       // [0, n) 为系统，[n, 2n) 为切向量
+
+        double timeScale = 1.0;      // τ (s)
+        double startTime = 0.0;
+        double currentNorm = 1.0;    // 上次重新归一化以来切向量的范数
+        double logGrowth = 0.0;      // ln|δ(t)|，初值为 0（单位范数）
+        double weightedGrowth = 0.0; // ∫ (t - t0) d ln|δ|
+        double instant = 0.0;        // Y(t)
+        double megnoIntegral = 0.0;  // ∫ Y dt
+    };
+
+} // namespace Physics
+
+#endif
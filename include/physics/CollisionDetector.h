@@ -0,0 +1,73 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_CORE_VECTOR3D_H_
+#define _INCLUDE_CORE_VECTOR3D_H_
+#include "core/Vector3D.h"
+#endif
+
+#include <cstdint>
+#include <utility>
+
+#pragma once
+
+#ifndef _COLLISIONDETECTOR_H_
+#define _COLLISIONDETECTOR_H_
+
+namespace Physics {
+
+    // 一对相撞的天体（i < j）
+    struct CollisionPair {
+        size_t i;
+        size_t j;
+        double fraction;   // 在本步内首次接触的时刻，占步长的比例 [0, 1]
+    };
+
+    // 基于均匀网格空间哈希的碰撞检测（扫掠球）
+    //
+    // 每个天体在一步内从 previous 线性运动到 current，其扫掠体用包围盒近似后写入网格；
+    // 同一格子内的天体对再做精确的线性相对运动最近距离检验。
+    // 格子边长取扫掠半径中位数的 2 倍，覆盖格子过多的大天体单独与所有天体检验，
+    // 因此半径悬殊（恒星与小天体）时也保持接近线性的开销。
+    // 内部缓冲区在多次调用间复用
+    class CollisionDetector {
+    public:
+        // previous 可以为空，此时只检验当前位置的重叠
+        const std::vector<CollisionPair>& detect(const std::vector<Vector3D>& previous,
+            const std::vector<Vector3D>& current,
+            const std::vector<double>& radii);
+
+        // O(N^2) 参考实现，用于测试
+        static std::vector<CollisionPair> detectBruteForce(const std::vector<Vector3D>& previous,
+            const std::vector<Vector3D>& current,
+            const std::vector<double>& radii);
+
+        // 两个线性运动的球在 [0, 1] 内首次接触的比例，不接触返回负数
+        static double contactFraction(const Vector3D& a0, const Vector3D& a1,
+            const Vector3D& b0, const Vector3D& b1, double radiusSum);
+
+    private:
+        struct CellEntry {
+            int64_t x, y, z;
+            size_t body;
+        };
+        struct Bounds {
+            int64_t lo[3];
+            int64_t hi[3];
+        };
+
+        void testPair(size_t i, size_t j, const std::vector<Vector3D>& previous,
+            const std::vector<Vector3D>& current, const std::vector<double>& radii);
+
+        std::vector<CellEntry> entries;
+        std::vector<Bounds> bounds;
+        std::vector<size_t> large;
+        std::vector<double> scratch;
+        std::vector<CollisionPair> pairs;
+    };
+
+} // namespace Physics
+
+#endif
@@ -0,0 +1,85 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_OSTREAM_
+#define _INCLUDE_OSTREAM_
+#include <ostream>
+#endif
+
+#ifndef _INCLUDE_GRAVITYENGINE_H_
+#define _INCLUDE_GRAVITYENGINE_H_
+#include "physics/GravityEngine.h"
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#pragma once
+
+#ifndef _CONSERVATIONMONITOR_H_
+#define _CONSERVATIONMONITOR_H_
+
+namespace Physics {
+
+    // 一条守恒量采样
+    struct ConservationSample {
+        double time = 0.0;
+        ForceDiagnostics diagnostics;
+        double energyError = 0.0;     // |E - E0| / |E0|
+        double momentumDrift = 0.0;   // |P - P0| / sum(m|v|)_0
+    };
+
+    // 守恒量监视器：derivative() 返回的导数函数使用融合受力内核，
+    // stepCallback() 每 interval 步记下一个已接受状态；若紧接着的第一次求导正是在该状态上
+    // （固定步长的 Euler / RK4 / Verlet），顺带记录能量误差与动量漂移，不再需要额外的 O(N^2) 能量计算；
+    // 否则（integrateAdaptive 的 FSAL 直接复用上一步末级导数，下一次求导已是中间级）
+    // 对记下的已接受状态补做一次受力计算。采样总是取自已接受状态
+    //
+    // 用法：Integrator::integrate(state, monitor.derivative(), T, dt, method, monitor.stepCallback());
+    //      Integrator::integrateAdaptive(state, monitor.derivative(), T, options, monitor.stepCallback());
+    class ConservationMonitor {
+    public:
+        // out 为 nullptr 时只保留最近一次采样；否则每次采样输出一行 CSV
+        ConservationMonitor(const std::vector<double>& masses, std::ostream* out = nullptr, size_t interval = 1);
+
+        DerivativeFunction derivative();
+        StepCallback stepCallback();
+
+        // 直接在给定状态上采样（额外一次受力计算），用于积分结束时
+        const ConservationSample& sample(const SystemState& state);
+
+        bool hasReference() const { return referenceSet; }
+        const ConservationSample& getLast() const { return last; }
+        double getMaxEnergyError() const { return maxEnergyError; }
+        size_t getSampleCount() const { return sampleCount; }
+
+    private:
+        void record(double time, const ForceDiagnostics& diagnostics, const SystemState& state);
+
+        std::vector<double> masses;
+        std::ostream* out;
+        size_t interval;
+
+        bool armed = true;
+        size_t stepsSinceSample = 0;
+        bool hasPending = false;     // 起始时还没有已接受状态，第一次求导即初始状态
+        SystemState pending;         // 待采样的已接受状态
+
+        bool referenceSet = false;
+        double referenceEnergy = 0.0;
+        Vector3D referenceMomentum;
+        double momentumScale = 0.0;
+
+        ConservationSample last;
+        double maxEnergyError = 0.0;
+        size_t sampleCount = 0;
+        SystemState scratch;
+    };
+
+} // namespace Physics
+
+#endif
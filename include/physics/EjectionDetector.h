@@ -0,0 +1,118 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#pragma once
+
+#ifndef _EJECTIONDETECTOR_H_
+#define _EJECTIONDETECTOR_H_
+
+namespace Physics {
+
+    // 二体问题的解析外推（普适变量 + Stumpff 函数），椭圆、抛物与双曲轨道通用。
+    // position / velocity 为相对引力中心的量，mu = G (m1 + m2)，dt 可为负
+    void propagateKepler(Vector3D& position, Vector3D& velocity, double mu, double dt);
+
+    // 逃逸判据。distanceFactor 越大判定越晚，但此后忽略的潮汐项按其三次方减小：
+    // 只需终止积分时取 10 已足够，解析外推时 30 使剩余双星的相位误差降到 1e-2 以下
+    struct EjectionCriteria {
+        double distanceFactor = 30.0;  // 到其余天体质心的距离至少为其余天体尺度（到其质心最大距离）的倍数
+        double minDistance = 0.0;      // 距离的绝对下限 (m)
+        size_t checkInterval = 8;      // 逐步驱动时每隔多少步检查一次：一次检查约为三体 RK4 一步的 1/4，逃逸又不可逆，晚几步发现无妨
+    };
+
+    // 一次逃逸：body 相对其余天体质心的双曲（或抛物）运动
+    struct EjectionEvent {
+        size_t body = 0;
+        double time = 0.0;
+        double distance = 0.0;         // 到其余天体质心的距离 (m)
+        double specificEnergy = 0.0;   // 相对运动的比能量 (J/kg)，> 0
+        double remainderEnergy = 0.0;  // 其余天体在其质心系中的内能 (J)
+        bool remainderBound = false;   // 其余天体是否仍为束缚系统（只剩一个天体时为 true）
+    };
+
+    // 逐步检查是否有单个天体已不可逆地逃离其余天体
+    //
+    // 候选天体须同时满足：远离其余天体的质心（r·v > 0）、相对运动的比能量为正（把其余天体视为
+    // 质心处的单个质点），且距离超过其余天体尺度的 distanceFactor 倍，使潮汐项相对单极项可以忽略；
+    // 最后用成对能量确认它没有与其余任何一个天体束缚在一起。前三项每个天体 O(1)，
+    // 只有通过的候选才计算尺度和成对能量，因此每步整体为 O(n)。一起被抛出的束缚子系统（如带着行星的恒星）不在判定范围内
+    class EjectionDetector {
+    public:
+        explicit EjectionDetector(const std::vector<double>& masses,
+            const EjectionCriteria& criteria = EjectionCriteria());
+
+        // positions / velocities 各 n 个；发现逃逸时填写 event 并返回 true（只报告第一个）
+        bool check(const Vector3D* positions, const Vector3D* velocities, double time, EjectionEvent& event) const;
+        bool check(const SystemState& state, EjectionEvent& event) const;
+
+        const std::vector<double>& getMasses() const { return masses; }
+
+    private:
+        std::vector<double> masses;
+        EjectionCriteria criteria;
+    };
+
+    // 会解体的系统的积分：逃逸天体从受力计算中移除，改为相对其余天体质心的二体解析外推；
+    // 只剩两个天体时整个系统转为解析求解，不再逐步积分。
+    // 其余天体的质心按二体问题反冲，getState() 给出所有天体在原始编号下的状态
+    class EscapePropagator {
+    public:
+        EscapePropagator(const SystemState& initial,
+            const std::vector<double>& masses,
+            Integrator::Method method = Integrator::RUNGE_KUTTA_4,
+            const EjectionCriteria& criteria = EjectionCriteria());
+
+        // 推进一步（推进时间）；有天体在这一步后被判定逃逸时返回 true（每 checkInterval 步检查一次）
+        bool step(double dt);
+
+        SystemState getState() const;
+        double getTime() const { return time; }
+
+        // 仍在逐步积分的天体数（全部解析后为 0）
+        size_t activeCount() const { return analytic ? 0 : active.size(); }
+        bool isEscaped(size_t body) const;
+        const std::vector<EjectionEvent>& getEvents() const { return events; }
+
+    private:
+        // 一次分离：group 为分离前的天体（原始编号），escaper 相对其余天体质心做二体运动。
+        // 最后剩下的两个天体也记为一次分离，较轻者作为 escaper
+        struct Separation {
+            std::vector<size_t> group;
+            size_t escaper = 0;
+            double epoch = 0.0;
+            double mu = 0.0;
+            double escaperFraction = 0.0;  // m_escaper / M_group
+            Vector3D centre;               // 分离时 group 的质心位置与速度
+            Vector3D centreVelocity;
+            Vector3D relative;             // 分离时 escaper 相对其余天体质心的位置与速度
+            Vector3D relativeVelocity;
+        };
+
+        void separate(size_t local);
+        void finishAnalytic();
+
+        std::vector<double> masses;          // 原始编号
+        std::vector<size_t> active;          // 仍在积分的天体（原始编号）
+        std::vector<double> activeMasses;
+        SystemState activeState;
+        Integrator integrator;
+        EjectionCriteria criteria;
+        EjectionDetector detector;
+        std::vector<Separation> separations;
+        std::vector<EjectionEvent> events;
+        size_t steps = 0;
+        bool analytic = false;               // 剩余的两个天体也已转为解析
+        double frozenTime = 0.0;             // 转为解析的时刻
+        double time = 0.0;
+    };
+
+} // namespace Physics
+
+#endif
@@ -0,0 +1,271 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#ifndef _INCLUDE_PHYSICSCONSTANTS_H_
+#define _INCLUDE_PHYSICSCONSTANTS_H_
+#include "physics/PhysicsConstants.h"
+#endif
+
+#include <array>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#pragma once
+
+#ifndef _FIXEDSYSTEM_H_
+#define _FIXEDSYSTEM_H_
+
+namespace Physics {
+
+    // 天体数在编译期固定的系统状态（std::array 存储，无堆分配），用于 N=3、4 等小系统的热路径。
+    // 与 SystemState 可以互相转换
+    template <size_t N>
+    struct FixedSystemState {
+        std::array<Vector3D, N> positions;
+        std::array<Vector3D, N> velocities;
+        double time = 0.0;
+
+        FixedSystemState() = default;
+
+        explicit FixedSystemState(const SystemState& dynamic) : time(dynamic.time) {
+            if (dynamic.positions.size() != N || dynamic.velocities.size() != N) {
+                throw std::invalid_argument("FixedSystemState size does not match the dynamic state");
+            }
+            for (size_t i = 0; i < N; ++i) {
+                positions[i] = dynamic.positions[i];
+                velocities[i] = dynamic.velocities[i];
+            }
+        }
+
+        SystemState toDynamic() const {
+            SystemState dynamic(N);
+            for (size_t i = 0; i < N; ++i) {
+                dynamic.positions[i] = positions[i];
+                dynamic.velocities[i] = velocities[i];
+            }
+            dynamic.time = time;
+            return dynamic;
+        }
+    };
+
+    namespace FixedDetail {
+
+        template <typename F, size_t... I>
+        inline void unrollImpl(F&& f, std::index_sequence<I...>) {
+            (f(std::integral_constant<size_t, I>()), ...);
+        }
+
+        // 编译期展开 f(0), f(1), ..., f(N-1)，下标为 std::integral_constant
+        template <size_t N, typename F>
+        inline void unroll(F&& f) {
+            unrollImpl(std::forward<F>(f), std::make_index_sequence<N>());
+        }
+
+        // out = y + k * h（逐分量，与 Integrator::addStates 的运算顺序一致）
+        template <size_t N>
+        inline void axpy(const FixedSystemState<N>& y, const FixedSystemState<N>& k, double h, FixedSystemState<N>& out) {
+            unroll<N>([&](auto i) {
+                out.positions[i] = Vector3D::axpy(y.positions[i], k.positions[i], h);
+                out.velocities[i] = Vector3D::axpy(y.velocities[i], k.velocities[i], h);
+            });
+        }
+
+    } // namespace FixedDetail
+
+    // 定长引力计算：成对循环在编译期完全展开，每对只算一次距离（牛顿第三定律）
+    template <size_t N>
+    class FixedGravity {
+    public:
+        explicit FixedGravity(const std::array<double, N>& masses) {
+            for (size_t i = 0; i < N; ++i) gm[i] = PhysicsConstants::G * masses[i];
+        }
+
+        explicit FixedGravity(const std::vector<double>& masses) {
+            if (masses.size() != N) {
+                throw std::invalid_argument("FixedGravity mass count does not match N");
+            }
+            for (size_t i = 0; i < N; ++i) gm[i] = PhysicsConstants::G * masses[i];
+        }
+
+        void accelerations(const std::array<Vector3D, N>& positions, std::array<Vector3D, N>& acc) const {
+            double ax[N] = {}, ay[N] = {}, az[N] = {};
+            FixedDetail::unroll<N>([&](auto i) {
+                FixedDetail::unroll<N>([&](auto j) {
+                    constexpr size_t I = decltype(i)::value;
+                    constexpr size_t J = decltype(j)::value;
+                    if constexpr (I < J) {
+                        double dx = positions[J].x - positions[I].x;
+                        double dy = positions[J].y - positions[I].y;
+                        double dz = positions[J].z - positions[I].z;
+                        double d2 = dx * dx + dy * dy + dz * dz;
+                        double d = std::sqrt(d2);
+                        if (d < 1e-10) return;  // 与 GravityEngine 相同的重合截断
+                        double inv3 = 1.0 / (d2 * d);
+                        double si = gm[J] * inv3;
+                        double sj = gm[I] * inv3;
+                        ax[I] += dx * si; ay[I] += dy * si; az[I] += dz * si;
+                        ax[J] -= dx * sj; ay[J] -= dy * sj; az[J] -= dz * sj;
+                    }
+                });
+            });
+            FixedDetail::unroll<N>([&](auto i) {
+                acc[i].x = ax[i];
+                acc[i].y = ay[i];
+                acc[i].z = az[i];
+            });
+        }
+
+        // 与 GravityEngine::calculateGravitationalDerivatives 相同的约定：d.positions = v，d.velocities = a
+        void derivatives(const FixedSystemState<N>& state, FixedSystemState<N>& d) const {
+            d.velocities = state.velocities;
+            accelerations(state.positions, d.velocities);
+            d.positions = state.velocities;
+            d.time = 1.0;
+        }
+
+    private:
+        double gm[N];
+    };
+
+    // 定长积分器：与 Integrator 的各方法算法相同，Verlet 的上一步位置保存在实例中
+    template <size_t N>
+    class FixedIntegrator {
+    public:
+        FixedIntegrator(const FixedGravity<N>& gravity, Integrator::Method method = Integrator::RUNGE_KUTTA_4)
+            : gravity(gravity), method(method) {}
+
+        // 单步积分（不推进 state.time，与 Integrator::step 一致）
+        void step(FixedSystemState<N>& state, double dt) {
+            switch (method) {
+            case Integrator::EULER: eulerStep(state, dt); break;
+            case Integrator::VERLET: verletStep(state, dt); break;
+            case Integrator::DORMAND_PRINCE_45: dormandPrinceStep(state, dt); break;
+            default: rk4Step(state, dt); break;
+            }
+        }
+
+        // 多步积分，步数与 Integrator::advance 相同
+        void integrate(FixedSystemState<N>& state, double totalTime, double dt) {
+            int steps = static_cast<int>(totalTime / dt);
+            for (int i = 0; i < steps; ++i) {
+                step(state, dt);
+                state.time += dt;
+            }
+        }
+
+        IntegratorState captureState() const {
+            IntegratorState saved;
+            if (hasPrevious) saved.previousPositions.assign(previousPositions.begin(), previousPositions.end());
+            return saved;
+        }
+
+        void restoreState(const IntegratorState& saved) {
+            hasPrevious = saved.previousPositions.size() == N;
+            if (hasPrevious) {
+                for (size_t i = 0; i < N; ++i) previousPositions[i] = saved.previousPositions[i];
+            }
+        }
+
+    private:
+        void eulerStep(FixedSystemState<N>& state, double dt) {
+            FixedSystemState<N> d;
+            gravity.derivatives(state, d);
+            FixedDetail::axpy(state, d, dt, state);
+        }
+
+        void rk4Step(FixedSystemState<N>& state, double dt) {
+            FixedSystemState<N> k1, k2, k3, k4, temp;
+            gravity.derivatives(state, k1);
+            FixedDetail::axpy(state, k1, dt / 2.0, temp);
+            gravity.derivatives(temp, k2);
+            FixedDetail::axpy(state, k2, dt / 2.0, temp);
+            gravity.derivatives(temp, k3);
+            FixedDetail::axpy(state, k3, dt, temp);
+            gravity.derivatives(temp, k4);
+
+            // weightedSum = k1 + 2*k2 + 2*k3 + k4，按 Integrator::rk4Step 的顺序累加
+            FixedSystemState<N> sum;
+            FixedDetail::axpy(k1, k2, 2.0, sum);
+            FixedDetail::axpy(sum, k3, 2.0, sum);
+            FixedDetail::axpy(sum, k4, 1.0, sum);
+            FixedDetail::axpy(state, sum, dt / 6.0, state);
+        }
+
+        void verletStep(FixedSystemState<N>& state, double dt) {
+            std::array<Vector3D, N> acc;
+            gravity.accelerations(state.positions, acc);
+            if (!hasPrevious) {
+                // 没有历史时先反推上一步位置，本步照常推进（与 Integrator::verletStep 相同）
+                FixedDetail::unroll<N>([&](auto i) {
+                    previousPositions[i] = Vector3D::axpy(state.positions[i] - state.velocities[i] * dt, acc[i], dt * dt * 0.5);
+                });
+                hasPrevious = true;
+            }
+            const double inverseDt = 1.0 / dt;
+            FixedDetail::unroll<N>([&](auto i) {
+                Vector3D next = Vector3D::axpy(state.positions[i] * 2.0 - previousPositions[i], acc[i], dt * dt);
+                state.velocities[i] = Vector3D::axpy((next - state.positions[i]) * inverseDt, acc[i], dt * 0.5);
+                previousPositions[i] = state.positions[i];
+                state.positions[i] = next;
+            });
+        }
+
+        void dormandPrinceStep(FixedSystemState<N>& state, double dt) {
+            static constexpr double A[6][6] = {
+                { 1.0 / 5.0, 0, 0, 0, 0, 0 },
+                { 3.0 / 40.0, 9.0 / 40.0, 0, 0, 0, 0 },
+                { 44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0, 0, 0, 0 },
+                { 19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0, 0, 0 },
+                { 9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0, 0 },
+                { 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0 }
+            };
+            FixedSystemState<N> k[6], temp;
+            gravity.derivatives(state, k[0]);
+            for (int s = 0; s < 6; ++s) {
+                temp = state;
+                for (int j = 0; j <= s; ++j) {
+                    if (A[s][j] != 0.0) FixedDetail::axpy(temp, k[j], A[s][j] * dt, temp);
+                }
+                if (s < 5) gravity.derivatives(temp, k[s + 1]);
+            }
+            state.positions = temp.positions;
+            state.velocities = temp.velocities;
+        }
+
+        FixedGravity<N> gravity;
+        Integrator::Method method;
+        std::array<Vector3D, N> previousPositions;
+        bool hasPrevious = false;
+    };
+
+    // 动态状态的入口：天体数为 2~4 时转到定长路径积分并写回，返回 false 表示不支持该 N，调用方应退回 Integrator
+    inline bool integrateFixedSize(SystemState& state, const std::vector<double>& masses,
+        double totalTime, double dt, Integrator::Method method) {
+        auto run = [&](auto tag) {
+            constexpr size_t n = decltype(tag)::value;
+            FixedSystemState<n> fixed(state);
+            FixedIntegrator<n> integrator(FixedGravity<n>(masses), method);
+            integrator.integrate(fixed, totalTime, dt);
+            state = fixed.toDynamic();
+            return true;
+        };
+        switch (state.positions.size()) {
+        case 2: return run(std::integral_constant<size_t, 2>());
+        case 3: return run(std::integral_constant<size_t, 3>());
+        case 4: return run(std::integral_constant<size_t, 4>());
+        default: return false;
+        }
+    }
+
+} // namespace Physics
+
+#endif
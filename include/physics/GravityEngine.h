@@ -18,18 +18,78 @@
 #include "physics/PhysicsConstants.h"
 #endif
 
+#ifndef _INCLUDE_SUMMATION_H_
+#define _INCLUDE_SUMMATION_H_
+#include "utils/Summation.h"
+#endif
+
 #pragma once
 
 #ifndef _GRAVITYENGINE_H_
 #define _GRAVITYENGINE_H_
 
+namespace Utils {
+    class ThreadPool;
+}
+
 namespace Physics {
 
+    // ִԼ
+    // reproducible Ϊ true ʱ̶ blockSize ֿ飬˳ۼӡù̶״ĹԼϲ
+    // ߳޹أλһ£Ϊ false ʱֿ߳飬쵫߳仯
+    //
+    // precision Ϊ MIXED ʱɶԵλơr^-2 뷽 float ¼㣨SIMD ȼӱ
+    // ۼӺλΪ doubleС closePairDistance ĽԡԼ float
+    // ȫΧԼ 1e15 m ϣԶ˻ double 㡣
+    // MIXED ģʽֱۼӼٶȣʹ summation 
+    enum class ForcePrecision {
+        DOUBLE,
+        MIXED
+    };
+
+    struct ExecutionPolicy {
+        Utils::ThreadPool* pool = nullptr;   // Ϊʱִ
+        bool reproducible = true;
+        Utils::SummationMode summation = Utils::SummationMode::NAIVE;
+        size_t blockSize = 256;
+        ForcePrecision precision = ForcePrecision::DOUBLE;
+        double closePairDistance = 0.0;      // Ͼ° double ľֵ (m)
+    };
+
+    // ʱͬһɶѭ˳ۼƵغ
+    struct ForceDiagnostics {
+        double kineticEnergy = 0.0;
+        double potentialEnergy = 0.0;
+        double virial = 0.0;                  // ά W = sum(r_ij . F_ij)µ
+        Vector3D momentum;
+
+        double totalEnergy() const { return kineticEnergy + potentialEnergy; }
+        double virialRatio() const { return potentialEnergy != 0.0 ? 2.0 * kineticEnergy / -potentialEnergy : 0.0; }
+    };
+
     class GravityEngine {
     public:
         // Nϵͳĵڻ
         static void calculateGravitationalDerivatives(const SystemState& state, SystemState& derivatives);
 
+        // ͬϣʹø
+        static void calculateGravitationalDerivatives(const SystemState& state, SystemState& derivatives,
+            const std::vector<double>& masses);
+
+        // ͬϣִвԲУÿĺ԰̶˳ۼӣ߳޹أ
+        static void calculateGravitationalDerivatives(const SystemState& state, SystemState& derivatives,
+            const std::vector<double>& masses, const ExecutionPolicy& policy);
+
+        // ͬϣţٵֻ i<j ԣͬһѭۼܡά붯
+        static void calculateGravitationalDerivatives(const SystemState& state, SystemState& derivatives,
+            const std::vector<double>& masses, ForceDiagnostics& diagnostics);
+
+        // ͬϣͬһɶѭм֣пռ䣩̵ĵÿԵ r_ij  1/r^3
+        // state ǰ n = masses.size() Ϊϵͳ n Ϊ (r, v)derivatives ͬʽУ
+        // 򲿷Ϊ (v, a)a_i = _j G m_j [r_ij / r^3 - 3 r_ij (r_ijr_ij) / r^5]
+        static void calculateVariationalDerivatives(const SystemState& state, SystemState& derivatives,
+            const std::vector<double>& masses);
+
         // 
         static Vector3D calculateGravitationalForce(const Vector3D& pos1, double mass1,
             const Vector3D& pos2, double mass2);
@@ -44,9 +104,18 @@ namespace Physics {
             const std::vector<Vector3D>& velocities,
             const std::vector<double>& masses);
 
+        static double calculateTotalEnergy(const std::vector<Vector3D>& positions,
+            const std::vector<Vector3D>& velocities,
+            const std::vector<double>& masses,
+            const ExecutionPolicy& policy);
+
         // ֤غ㣨ڵԣ
         static Vector3D calculateTotalMomentum(const std::vector<Vector3D>& velocities,
             const std::vector<double>& masses);
+
+        static Vector3D calculateTotalMomentum(const std::vector<Vector3D>& velocities,
+            const std::vector<double>& masses,
+            const ExecutionPolicy& policy);
     };
 
 } // namespace Physics
@@ -32,35 +32,97 @@ namespace Physics {
     // ΢ַ̺
     using DerivativeFunction = std::function<void(const SystemState&, SystemState&)>;
 
+    // ڲ״̬ಽʷڱָϵ
+    struct IntegratorState {
+        std::vector<Vector3D> previousPositions; // Verlet һλ
+    };
+
+    // ÿɺĻصڼ¼켣
+    using StepCallback = std::function<void(const SystemState&)>;
+
+    // Ӧֵݲ벽
+    struct AdaptiveOptions {
+        double relativeTolerance = 1e-9;
+        double absoluteTolerance = 0.0;   // λ (m) ٶ (m/s) ã0 ʾݲ
+        double initialStep = 0.0;         // 0 ʾԶ
+        double minStep = 0.0;             // ڴֵʱ׳쳣
+        double maxStep = 0.0;             // 0 ʾ
+        double safety = 0.9;
+        size_t maxSteps = 100000000;
+    };
+
+    // Ӧֵͳ
+    struct AdaptiveStats {
+        size_t acceptedSteps = 0;
+        size_t rejectedSteps = 0;
+        size_t evaluations = 0;           // ô
+        double lastStep = 0.0;            // һνĲΪ initialStep
+    };
+
+    // ʵÿʵжಽʷVerlet һλã
+    // ͬ߳ϵĶģһʵɲ
     class Integrator {
     public:
         enum Method {
             EULER,              // ŷ򵥵ȵͣ
             RUNGE_KUTTA_4,      // Ľ-Ƽ
-            VERLET              // Verlet֣غã
+            VERLET,             // Verlet֣غã
+            DORMAND_PRINCE_45   // Dormand-Prince 5(4)̶ʱȡ׽⣬ integrateAdaptive ʹǶ
         };
 
-        // 
-        static void integrateStep(SystemState& state,
+        explicit Integrator(Method method = RUNGE_KUTTA_4) : method(method) {}
+
+        // ֣ƽ state.time
+        void step(SystemState& state, const DerivativeFunction& derivFunc, double dt);
+
+        // ಽ֣ÿ onStepΪգ
+        void advance(SystemState& state,
+            const DerivativeFunction& derivFunc,
+            double totalTime,
+            double timeStep,
+            const StepCallback& onStep = nullptr);
+
+        //  / ָʵڲ״̬reset ʷ
+        IntegratorState captureState() const;
+        void restoreState(const IntegratorState& saved);
+        void reset() { prevPositions.clear(); }
+
+        Method getMethod() const { return method; }
+
+        // ಽ֣ʹʱʵʷһεã
+        static void integrate(SystemState& state,
             DerivativeFunction derivFunc,
-            double dt,
+            double totalTime,
+            double timeStep,
             Method method = RUNGE_KUTTA_4);
 
-        // ಽ
+        // ಽ֣ÿ onStep
         static void integrate(SystemState& state,
             DerivativeFunction derivFunc,
             double totalTime,
             double timeStep,
-            Method method = RUNGE_KUTTA_4);
+            Method method,
+            const StepCallback& onStep);
+
+        // Ӧ֣Dormand-Prince 5(4)FSALÿܵĲ֮ onStep
+        static AdaptiveStats integrateAdaptive(SystemState& state,
+            DerivativeFunction derivFunc,
+            double totalTime,
+            const AdaptiveOptions& options,
+            const StepCallback& onStep = nullptr);
 
     private:
         // ַͬʵ
-        static void eulerStep(SystemState& state, DerivativeFunction derivFunc, double dt);
-        static void rk4Step(SystemState& state, DerivativeFunction derivFunc, double dt);
-        static void verletStep(SystemState& state, DerivativeFunction derivFunc, double dt);
+        static void eulerStep(SystemState& state, const DerivativeFunction& derivFunc, double dt);
+        static void rk4Step(SystemState& state, const DerivativeFunction& derivFunc, double dt);
+        void verletStep(SystemState& state, const DerivativeFunction& derivFunc, double dt);
+        static void dormandPrinceStep(SystemState& state, const DerivativeFunction& derivFunc, double dt);
 
         // 
         static SystemState addStates(const SystemState& a, const SystemState& b, double scale = 1.0);
+
+        Method method;
+        std::vector<Vector3D> prevPositions; // Verlet һλãΪձʾһҪԾ
     };
 
 } // namespace Physics
@@ -9,6 +9,7 @@ namespace PhysicsConstants {
     constexpr double EARTH_MASS = 5.972e24;  // 地球质量 (kg)
     constexpr double AU = 1.496e11;          // 天文单位 (m)
     constexpr double DAY_SECONDS = 86400.0;  // 一天的秒数
+    constexpr double SOLAR_LUMINOSITY = 3.828e26; // 太阳光度 (W)
 
     // 单位转换
     inline double yearsToSeconds(double years) {
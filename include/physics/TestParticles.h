@@ -0,0 +1,54 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#pragma once
+
+#ifndef _TESTPARTICLES_H_
+#define _TESTPARTICLES_H_
+
+namespace Utils {
+    class ThreadPool;
+}
+
+namespace Physics {
+
+    // 无质量试验粒子群：受大质量天体的引力，但不对任何天体施力，粒子之间也没有相互作用。
+    // 坐标与速度按分量分别存放（SoA），受力循环对粒子连续访问，便于向量化；
+    // 每步开销为 O(N_massive * N_test)
+    class TestParticleSwarm {
+    public:
+        size_t add(const Vector3D& position, const Vector3D& velocity);
+        void reserve(size_t count);
+        size_t size() const { return x.size(); }
+
+        Vector3D getPosition(size_t i) const { return Vector3D(x[i], y[i], z[i]); }
+        Vector3D getVelocity(size_t i) const { return Vector3D(vx[i], vy[i], vz[i]); }
+
+        // 粒子 [begin, end) 在给定大质量天体位置下的加速度，写入 ax/ay/az 的 [0, end - begin)
+        void accelerations(const std::vector<Vector3D>& massivePositions, const std::vector<double>& masses,
+            size_t begin, size_t end, double* ax, double* ay, double* az) const;
+
+        // 漂移-踢-漂移 (DKD) 推进一步：大质量天体在步中点的位置由步前后的状态做三次 Hermite 插值得到，
+        // 因此只需要大质量天体积分器已有的两端状态。pool 非空时按粒子分块并行
+        void step(const SystemState& massiveBefore, const SystemState& massiveAfter,
+            const std::vector<double>& masses, double dt, Utils::ThreadPool* pool = nullptr);
+
+        // 与大质量天体同步推进：massive 由 integrator 积分（推进 massive.time），粒子每步跟随一次 DKD
+        void advance(SystemState& massive, const std::vector<double>& masses, Integrator& integrator,
+            double totalTime, double timeStep, Utils::ThreadPool* pool = nullptr);
+
+    private:
+        std::vector<double> x, y, z;
+        std::vector<double> vx, vy, vz;
+    };
+
+} // namespace Physics
+
+#endif
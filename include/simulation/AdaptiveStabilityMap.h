@@ -0,0 +1,101 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#ifndef _INCLUDE_OSTREAM_
+#define _INCLUDE_OSTREAM_
+#include <ostream>
+#endif
+
+#ifndef _INCLUDE_STABILITYMAP_H_
+#define _INCLUDE_STABILITYMAP_H_
+#include "simulation/StabilityMap.h"
+#endif
+
+#pragma once
+
+#ifndef _ADAPTIVESTABILITYMAP_H_
+#define _ADAPTIVESTABILITYMAP_H_
+
+namespace Simulation {
+
+    struct AdaptiveMapOptions {
+        uint32_t levels = 3;             // 细化层数，最粗网格每格为 2^levels x 2^levels 个细格
+        double chaosThreshold = 1.0;     // computeMegno 时 <Y> > 2 + chaosThreshold 视为混沌
+        size_t maxSimulations = 0;       // 积分次数上限（最粗网格总会算完），0 为不限
+        Utils::ThreadPool* pool = nullptr;
+    };
+
+    // 四叉树的一个叶子：覆盖细网格 [x, x + size) x [y, y + size)，结果取自块中心的一次积分
+    struct AdaptiveLeaf {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t size = 1;
+        CellResult result;
+    };
+
+    // 由粗到细的稳定性图。细网格即 config 的 x.cells x y.cells，两者须为 2^levels 的倍数
+    //
+    // 先按最粗网格积分，之后每一轮找出与某个相邻叶子结论不同的叶子（结局不同，或都存活但
+    // 一个规则一个混沌），把它们分成四块。待细化的叶子按“不一致的邻居数 x 块边长”进入优先队列，
+    // 工作线程从队列中领取，优先细化边界最长、分歧最多的块；积分次数达到上限时剩下的保持原样。
+    // 结论一致的大片区域只算一次，边界处仍细化到细网格的分辨率
+    class AdaptiveStabilityMap {
+    public:
+        explicit AdaptiveStabilityMap(const StabilityMapConfig& config,
+            const AdaptiveMapOptions& options = AdaptiveMapOptions());
+
+        // 计算整张图，可重复调用（每次从头开始）
+        void run();
+
+        uint32_t getWidth() const { return width; }
+        uint32_t getHeight() const { return height; }
+        size_t getSimulations() const { return simulations; }
+        size_t getRounds() const { return rounds; }
+
+        // 细格 (x, y) 所在叶子的结果与块边长
+        const CellResult& at(uint32_t x, uint32_t y) const { return nodes[owner[static_cast<size_t>(y) * width + x]].result; }
+        uint32_t blockSizeAt(uint32_t x, uint32_t y) const { return nodes[owner[static_cast<size_t>(y) * width + x]].size; }
+
+        std::vector<AdaptiveLeaf> leaves() const;
+
+        // 与 StabilityRaster::writeImage 相同的灰度图，每个叶子铺满它覆盖的细格
+        void writeImage(const std::string& path) const;
+
+        // 每个叶子一行：x,y,size,x_value,y_value,outcome,end_time,megno
+        void writeLeaves(std::ostream& out) const;
+
+    private:
+        struct Node {
+            uint32_t x = 0;
+            uint32_t y = 0;
+            uint32_t size = 1;
+            bool leaf = false;
+            CellResult result;
+        };
+
+        void simulate(Node& node) const;
+        void paint(size_t index);
+        double disagreement(size_t index) const;
+        bool differs(const CellResult& a, const CellResult& b) const;
+        void compute(std::vector<size_t>& batch);
+
+        StabilityMapConfig config;
+        AdaptiveMapOptions options;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<Node> nodes;
+        std::vector<uint32_t> owner;     // 每个细格当前所属叶子在 nodes 中的序号
+        size_t simulations = 0;
+        size_t rounds = 0;
+    };
+
+} // namespace Simulation
+
+#endif
@@ -0,0 +1,105 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_FUNCTIONAL_
+#define _INCLUDE_FUNCTIONAL_
+#include <functional>
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#ifndef _INCLUDE_PHYSICSCONSTANTS_H_
+#define _INCLUDE_PHYSICSCONSTANTS_H_
+#include "physics/PhysicsConstants.h"
+#endif
+
+#pragma once
+
+#ifndef _CALENDAR_H_
+#define _CALENDAR_H_
+
+namespace Simulation {
+
+    // 纪元类型：恒纪元 / 乱纪元
+    enum class EraType {
+        STABLE,
+        CHAOTIC
+    };
+
+    enum class CalendarEventType {
+        SUNRISE,
+        SUNSET,
+        ERA_CHANGE
+    };
+
+    // 日历事件；日出日落时 body 为对应恒星的天体编号，纪元变化时 era 为新纪元
+    struct CalendarEvent {
+        double time = 0.0;
+        CalendarEventType type = CalendarEventType::SUNRISE;
+        size_t body = 0;
+        EraType era = EraType::STABLE;
+    };
+
+    // 行星日历参数。观测者位于行星赤道，自转轴沿 z 轴
+    struct CalendarConfig {
+        size_t planetIndex = 0;
+        std::vector<size_t> sunIndices;          // 为空时除行星外的天体都视为恒星
+        std::vector<double> luminosities;        // 恒星光度 (W)，为空时按质光关系估算
+        double rotationPeriod = PhysicsConstants::DAY_SECONDS; // 自转周期 (s)
+        double rotationPhase = 0.0;              // t=0 时的自转相位 (rad)
+        int scanStepsPerRotation = 48;           // 日出日落搜索步长 = 自转周期 / 该值
+        double eraScanStep = PhysicsConstants::DAY_SECONDS; // 纪元变化搜索步长 (s)
+        double timeTolerance = 1.0;              // 事件时刻精度 (s)
+        double stableFluxFraction = 0.9;         // 主恒星光照占比不低于该值才可能是恒纪元
+    };
+
+    // 根据任意时刻的系统状态计算日出、日落与纪元变化。
+    // 构造时检查 config：rotationPeriod、scanStepsPerRotation、timeTolerance、eraScanStep 须为正，否则抛出 invalid_argument
+    class CalendarCalculator {
+    public:
+        using StateProvider = std::function<void(double, Physics::SystemState&)>;
+
+        CalendarCalculator(const CalendarConfig& config,
+            const std::vector<double>& masses,
+            StateProvider provider);
+
+        // 状态判定
+        EraType classify(const Physics::SystemState& state) const;
+        EraType eraAt(double t) const;
+
+        // 恒星 sunSlot（sunIndices 中的序号）在观测者处的高度角正弦
+        double sunElevation(const Physics::SystemState& state, size_t sunSlot) const;
+
+        // 在 (t, limit] 内查找下一次日出 / 纪元变化，找不到返回 false
+        bool findNextSunrise(double t, double limit, CalendarEvent& event) const;
+        bool findNextEraChange(double t, double limit, CalendarEvent& event) const;
+
+        // 生成 [t0, t1] 内按时间排序的全部事件
+        std::vector<CalendarEvent> generate(double t0, double t1) const;
+
+        const CalendarConfig& getConfig() const { return config; }
+        const std::vector<size_t>& getSunIndices() const { return config.sunIndices; }
+
+    private:
+        void scanHorizon(double t0, double t1, bool firstSunriseOnly, std::vector<CalendarEvent>& events) const;
+        void scanEras(double t0, double t1, bool firstOnly, std::vector<CalendarEvent>& events) const;
+
+        CalendarConfig config;
+        std::vector<double> masses;
+        StateProvider provider;
+    };
+
+    // 补全 sunIndices 与 luminosities 的缺省值并检查下标，出错时抛出 invalid_argument
+    void resolveSuns(CalendarConfig& config, const std::vector<double>& masses);
+
+    const char* toString(EraType era);
+    const char* toString(CalendarEventType type);
+
+} // namespace Simulation
+
+#endif
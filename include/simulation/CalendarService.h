@@ -0,0 +1,76 @@
+﻿#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_IOSFWD_
+#define _INCLUDE_IOSFWD_
+#include <iosfwd>
+#endif
+
+#ifndef _INCLUDE_CALENDAR_H_
+#define _INCLUDE_CALENDAR_H_
+#include "simulation/Calendar.h"
+#endif
+
+#ifndef _INCLUDE_EPHEMERISCACHE_H_
+#define _INCLUDE_EPHEMERISCACHE_H_
+#include "simulation/EphemerisCache.h"
+#endif
+
+#pragma once
+
+#ifndef _CALENDARSERVICE_H_
+#define _CALENDARSERVICE_H_
+
+namespace Simulation {
+
+    // 万年历查询服务（stdin/stdout 行协议）
+    //
+    // 请求：   <id> STATE <t>
+    //          <id> CALENDAR <t0> <t1>
+    //          <id> NEXT_SUNRISE <t>
+    //          <id> NEXT_ERA <t>
+    //          QUIT
+    // 应答：   <id> OK ...   或   <id> ERROR <原因>
+    // 请求并发处理，应答可能乱序，以 id 对应。
+    // 单个 CALENDAR 请求的跨度不超过 setMaxCalendarSpan 的上限；NEXT_SUNRISE 最多向后搜索
+    // setSunriseHorizon 个自转周期，超出仍无日出时应答 OK NONE。纪元边界在构造时对整个星历扫描一次
+    // （开始接受请求之前），NEXT_ERA 只做二分查找
+    class CalendarService {
+    public:
+        CalendarService(const std::string& ephemerisPath,
+            const CalendarConfig& config,
+            size_t cacheSegments = 4096);
+
+        // 处理一行请求，返回一行应答（不含换行）
+        std::string handle(const std::string& request);
+
+        // 从 in 逐行读取请求，用 numThreads 个线程并发应答到 out，直到 QUIT 或输入结束
+        void serve(std::istream& in, std::ostream& out, size_t numThreads = 0);
+
+        const CachedEphemeris& getEphemeris() const { return ephemeris; }
+
+        // CALENDAR 请求允许的最大跨度 t1 - t0 (s)，默认 10 年
+        void setMaxCalendarSpan(double span) { maxCalendarSpan = span; }
+
+        // NEXT_SUNRISE 的搜索范围（自转周期数），默认 100
+        void setSunriseHorizon(double rotations) { sunriseHorizon = rotations; }
+
+    private:
+        CachedEphemeris ephemeris;
+        CalendarCalculator calculator;
+        double maxCalendarSpan = 10.0 * 365.25 * PhysicsConstants::DAY_SECONDS;
+        double sunriseHorizon = 100.0;
+
+        std::vector<CalendarEvent> eras;   // 整个星历上的纪元变化，按时间排序，构造后只读
+    };
+
+} // namespace Simulation
+
+#endif
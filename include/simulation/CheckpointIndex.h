@@ -0,0 +1,91 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#pragma once
+
+#ifndef _CHECKPOINTINDEX_H_
+#define _CHECKPOINTINDEX_H_
+
+namespace Simulation {
+
+    // 可直接续算的检查点：系统状态 + 积分器状态
+    struct Checkpoint {
+        Physics::SystemState state;
+        Physics::IntegratorState integrator;
+    };
+
+    // 检查点间距策略：起点附近等间距加密，之后间距按 growthFactor 几何增长，
+    // 并以 maxInterval 为上限（上限即最坏情况下 seek 需补积分的时长，因此总是有限的）
+    struct CheckpointPolicy {
+        double denseInterval = 0.0;   // 加密区间距 (s)
+        double denseSpan = 0.0;       // 加密区长度 (s)
+        double growthFactor = 2.0;    // 加密区之外下一间距 = 当前时刻 * (growthFactor - 1)
+        double maxInterval = 0.0;     // 间距上限 (s)，0 表示取 max(denseSpan, DEFAULT_MAX_DENSE_INTERVALS * denseInterval)
+
+        static constexpr double DEFAULT_MAX_DENSE_INTERVALS = 64.0;
+    };
+
+    // 积分过程中按策略维护的检查点索引，按时间递增
+    class CheckpointIndex {
+    public:
+        explicit CheckpointIndex(const CheckpointPolicy& policy);
+
+        // 积分每步后检查：t 时刻是否应记录检查点
+        bool isDue(double t) const;
+        void record(const Physics::SystemState& state, const Physics::IntegratorState& integrator);
+
+        // 不晚于 t 的最近检查点，没有则返回 nullptr
+        const Checkpoint* findBefore(double t) const;
+
+        // 某时刻之后下一个检查点的间距
+        double intervalAfter(double t) const;
+
+        size_t size() const { return checkpoints.size(); }
+        const Checkpoint& operator[](size_t i) const { return checkpoints[i]; }
+
+    private:
+        CheckpointPolicy policy;
+        std::vector<Checkpoint> checkpoints;
+        double nextTime = 0.0;
+    };
+
+    // 带检查点索引的可跳转模拟：seek(t) 从最近的检查点续算，只积分剩余的间隔
+    class SeekableSimulation {
+    public:
+        SeekableSimulation(const Physics::SystemState& initial,
+            const std::vector<double>& masses,
+            double timeStep,
+            Physics::Integrator::Method method,
+            const CheckpointPolicy& policy);
+
+        // 把积分前沿推进到至少 t，沿途记录检查点
+        void advanceTo(double t);
+
+        // t 时刻的系统状态；超出前沿时先推进前沿
+        Physics::SystemState seek(double t);
+
+        const CheckpointIndex& getIndex() const { return index; }
+        const Physics::SystemState& getFrontier() const { return frontier; }
+        size_t getLastSeekSteps() const { return lastSeekSteps; }
+
+    private:
+        Physics::DerivativeFunction derivFunc;
+        double timeStep;
+        Physics::Integrator::Method method;
+
+        CheckpointIndex index;
+        Physics::SystemState frontier;
+        Physics::IntegratorState frontierIntegrator;
+        size_t lastSeekSteps = 0;
+    };
+
+} // namespace Simulation
+
+#endif
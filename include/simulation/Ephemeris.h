@@ -0,0 +1,116 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#ifndef _INCLUDE_IOSFWD_
+#define _INCLUDE_IOSFWD_
+#include <iosfwd>
+#endif
+
+#ifndef _INCLUDE_CSTDINT_
+#define _INCLUDE_CSTDINT_
+#include <cstdint>
+#endif
+
+#ifndef _INCLUDE_CORE_VECTOR3D_H_
+#define _INCLUDE_CORE_VECTOR3D_H_
+#include "core/Vector3D.h"
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#ifndef _INCLUDE_PHYSICSCONSTANTS_H_
+#define _INCLUDE_PHYSICSCONSTANTS_H_
+#include "physics/PhysicsConstants.h"
+#endif
+
+#pragma once
+
+#ifndef _EPHEMERIS_H_
+#define _EPHEMERIS_H_
+
+namespace Simulation {
+
+    // 切比雪夫星历拟合参数
+    struct EphemerisFitOptions {
+        int degree = 12;                                            // 每段多项式阶数
+        double maxSegmentLength = 32.0 * PhysicsConstants::DAY_SECONDS; // 最长分段（粒度）(s)
+        int maxDepth = 10;                                          // 最多二分次数
+        double positionTolerance = 1.0e3;                           // 位置误差上限 (m)
+        double velocityTolerance = 0.0;                             // 速度误差上限 (m/s)，0 表示不检查
+    };
+
+    // 单个天体的分段切比雪夫系数
+    struct BodyEphemeris {
+        std::string name;
+        double mass = 0.0;
+        std::vector<double> boundaries;      // 分段边界，共 segmentCount()+1 个
+        std::vector<double> coefficients;    // 每段 3*(degree+1) 个系数：x, y, z 依次排列
+        std::vector<uint32_t> granuleIndex;  // 每个粒度区间的第一段编号，共 granules+1 个
+
+        size_t segmentCount() const { return boundaries.empty() ? 0 : boundaries.size() - 1; }
+    };
+
+    // 分段切比雪夫星历（JPL DE 风格）
+    // 分段长度为 maxSegmentLength / 2^k，查找时先按粒度定位再在粒度内二分，代价与时间跨度无关
+    class Ephemeris {
+    public:
+        Ephemeris() = default;
+
+        // 由积分得到的轨迹拟合星历，轨迹须按时间递增
+        static Ephemeris fit(const std::vector<Physics::SystemState>& trajectory,
+            const std::vector<std::string>& names,
+            const std::vector<double>& masses,
+            const EphemerisFitOptions& options = EphemerisFitOptions());
+
+        // 计算某天体在 t 时刻的位置和速度
+        void evaluate(size_t body, double t, Vector3D& position, Vector3D& velocity) const;
+
+        // 计算所有天体在 t 时刻的状态
+        void evaluateAll(double t, Physics::SystemState& state) const;
+
+        // 二进制文件读写
+        void save(const std::string& path) const;
+        static Ephemeris load(const std::string& path);
+
+        // 只读取头部与分段索引（不含系数），coefficientOffset 返回系数区在文件中的偏移
+        static Ephemeris loadIndex(const std::string& path, uint64_t& coefficientOffset);
+
+        // 对一段系数求值，x 为归一化时间 [-1, 1]，scale = 2 / 段长
+        static void evaluateSegment(const double* coefficients, int degree,
+            double x, double scale, Vector3D& position, Vector3D& velocity);
+
+        // Getter
+        int getDegree() const { return degree; }
+        double getStartTime() const { return startTime; }
+        double getEndTime() const { return endTime; }
+        double getGranule() const { return granule; }
+        size_t getBodyCount() const { return bodies.size(); }
+        const BodyEphemeris& getBody(size_t index) const { return bodies[index]; }
+        size_t findBody(const std::string& name) const;
+
+        // 定位 t 所在的分段
+        size_t findSegment(size_t body, double t) const;
+
+    private:
+        static Ephemeris readIndex(std::istream& in, const std::string& path);
+
+        int degree = 0;
+        double startTime = 0.0;
+        double endTime = 0.0;
+        double granule = 0.0;
+        std::vector<BodyEphemeris> bodies;
+    };
+
+} // namespace Simulation
+
+#endif
@@ -0,0 +1,72 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#ifndef _INCLUDE_EPHEMERIS_H_
+#define _INCLUDE_EPHEMERIS_H_
+#include "simulation/Ephemeris.h"
+#endif
+
+#ifndef _INCLUDE_LRUCACHE_H_
+#define _INCLUDE_LRUCACHE_H_
+#include "utils/LruCache.h"
+#endif
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#pragma once
+
+#ifndef _EPHEMERISCACHE_H_
+#define _EPHEMERISCACHE_H_
+
+namespace Simulation {
+
+    // 星历文件的按需读取：启动时只读索引，系数段在用到时才从磁盘读出
+    class EphemerisFile {
+    public:
+        explicit EphemerisFile(const std::string& path);
+
+        // 读取某天体第 segment 段的系数（线程安全）
+        std::vector<double> readSegment(size_t body, size_t segment);
+
+        const Ephemeris& getIndex() const { return index; }
+        const std::string& getPath() const { return path; }
+
+    private:
+        std::string path;
+        Ephemeris index;
+        uint64_t coefficientOffset = 0;
+        std::vector<uint64_t> firstSegment; // 每个天体在系数区中的起始段号
+        std::ifstream stream;
+        std::mutex mutex;
+    };
+
+    // 带定长 LRU 段缓存的星历求值
+    class CachedEphemeris {
+    public:
+        using Segment = std::shared_ptr<const std::vector<double>>;
+
+        CachedEphemeris(const std::string& path, size_t capacity);
+
+        void evaluate(size_t body, double t, Vector3D& position, Vector3D& velocity);
+        void evaluateAll(double t, Physics::SystemState& state);
+
+        const Ephemeris& getIndex() const { return file.getIndex(); }
+        const Utils::LruCache<uint64_t, Segment>& getCache() const { return cache; }
+
+    private:
+        EphemerisFile file;
+        Utils::LruCache<uint64_t, Segment> cache;
+    };
+
+} // namespace Simulation
+
+#endif
@@ -0,0 +1,98 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_FUNCTIONAL_
+#define _INCLUDE_FUNCTIONAL_
+#include <functional>
+#endif
+
+#ifndef _INCLUDE_CALENDAR_H_
+#define _INCLUDE_CALENDAR_H_
+#include "simulation/Calendar.h"
+#endif
+
+#ifndef _INCLUDE_SLIDINGSTATS_H_
+#define _INCLUDE_SLIDINGSTATS_H_
+#include "utils/SlidingStats.h"
+#endif
+
+#pragma once
+
+#ifndef _ERACLASSIFIER_H_
+#define _ERACLASSIFIER_H_
+
+namespace Simulation {
+
+    // 流式纪元判定参数。进入恒纪元需满足全部判据，离开时各阈值按 hysteresis 放宽，避免在边界附近来回跳变
+    struct EraClassifierConfig {
+        size_t window = 256;                 // 滑动窗口样本数
+        double maxEccentricity = 0.5;        // 窗口内绕主恒星的偏心率上限
+        double maxSemiMajorSpread = 0.05;    // 窗口内半长轴的相对标准差上限
+        double hysteresis = 1.5;             // 离开恒纪元时阈值的放宽倍数
+    };
+
+    // 流式纪元分类器：逐步消费积分输出（可直接作为 Integrator::advance 的 onStep），
+    // 维护行星绕主恒星的半长轴、偏心率、主恒星光照占比以及到各恒星距离的滑动窗口统计，
+    // 在判定结果改变的那一步通过回调给出纪元边界。内存只与窗口大小和恒星数有关，每步代价摊还 O(恒星数)
+    //
+    // 主恒星按通量取最大者；主恒星更换时轨道根数的窗口清空，窗口重新填满之前不会进入恒纪元。
+    // 首个窗口填满时给出初始纪元，时刻取窗口内第一个样本
+    class EraClassifier {
+    public:
+        using EraCallback = std::function<void(const CalendarEvent&)>;
+
+        EraClassifier(const CalendarConfig& calendar,
+            const std::vector<double>& masses,
+            const EraClassifierConfig& config = EraClassifierConfig(),
+            EraCallback onChange = nullptr);
+
+        // 消费一步状态，产生纪元边界时返回 true
+        bool push(const Physics::SystemState& state);
+
+        // 是否已经给出过纪元（首个窗口已填满）
+        bool isReady() const { return ready; }
+        EraType currentEra() const { return era; }
+        double getLastChangeTime() const { return lastChange; }
+        size_t getStepsConsumed() const { return steps; }
+
+        // 当前主恒星（天体编号）
+        size_t getDominantSun() const { return dominant; }
+
+        // 窗口统计：sunSlot 为 CalendarConfig::sunIndices 中的序号
+        const Utils::SlidingStats& distanceStats(size_t sunSlot) const { return distances[sunSlot]; }
+        const Utils::SlidingStats& semiMajorAxisStats() const { return semiMajorAxis; }
+        const Utils::SlidingStats& eccentricityStats() const { return eccentricity; }
+        const Utils::SlidingStats& fluxFractionStats() const { return fluxFraction; }
+
+        const CalendarConfig& getCalendarConfig() const { return calendar; }
+        const EraClassifierConfig& getConfig() const { return config; }
+
+    private:
+        // relax 为 1 时是进入恒纪元的判据，为 hysteresis 时是保持恒纪元的判据
+        bool windowIsStable(double relax) const;
+        void emit(double time, EraType newEra);
+
+        CalendarConfig calendar;
+        EraClassifierConfig config;
+        std::vector<double> masses;
+        EraCallback onChange;
+
+        std::vector<Utils::SlidingStats> distances;
+        Utils::SlidingStats semiMajorAxis;
+        Utils::SlidingStats eccentricity;
+        Utils::SlidingStats fluxFraction;
+        double firstTime = 0.0;
+
+        size_t dominant = 0;
+        bool hasDominant = false;
+        bool ready = false;
+        EraType era = EraType::CHAOTIC;
+        double lastChange = 0.0;
+        size_t steps = 0;
+    };
+
+} // namespace Simulation
+
+#endif
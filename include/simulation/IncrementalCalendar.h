@@ -0,0 +1,94 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#ifndef _INCLUDE_CALENDAR_H_
+#define _INCLUDE_CALENDAR_H_
+#include "simulation/Calendar.h"
+#endif
+
+#pragma once
+
+#ifndef _INCREMENTALCALENDAR_H_
+#define _INCREMENTALCALENDAR_H_
+
+namespace Simulation {
+
+    // 按需延伸的日历生成器
+    //
+    // 只积分到请求的结束时刻；已积分的区间只保存日历事件和末状态（含积分器状态），
+    // 之后的请求从末状态继续积分，已覆盖的时间不会重复积分。
+    // 指定 cachePath 时每次延伸后写盘，下次构造时若全部输入（质量、初始状态、日历配置、
+    // 积分方法与步长）的指纹一致则从文件恢复，否则重新积分。
+    // 缓存分两个文件：cachePath 只存末状态与事件数，整份替换；事件追加写到 cachePath + ".events"，
+    // 每次延伸只写新事件，写盘开销与已积累的历史长度无关。
+    class IncrementalCalendar {
+    public:
+        IncrementalCalendar(const Physics::SystemState& initial,
+            const std::vector<double>& masses,
+            const CalendarConfig& config,
+            double timeStep,
+            Physics::Integrator::Method method = Physics::Integrator::RUNGE_KUTTA_4,
+            const std::string& cachePath = "");
+
+        // 返回 [t0, t1] 内的事件，必要时先把积分延伸到 t1
+        std::vector<CalendarEvent> generate(double t0, double t1);
+
+        // t 时刻所处的纪元（t 须已被覆盖）
+        EraType eraAt(double t) const;
+
+        // 把积分延伸到至少 t
+        void extendTo(double t);
+
+        double getCoveredUntil() const { return lastState.time; }
+        const Physics::SystemState& getLastState() const { return lastState; }
+        size_t getStepsIntegrated() const { return stepsIntegrated; }
+
+        // 持久化（path 与 path + ".events" 两个文件）；对上次保存或加载的同一路径只追加新事件。
+        // load 在文件缺失、损坏或指纹不符时返回 false，不改变当前状态
+        void save(const std::string& path) const;
+        bool load(const std::string& path);
+
+        // 每次延伸的最大区间，限制临时轨迹的内存
+        void setChunkLength(double length) { chunkLength = length; }
+
+    private:
+        void extendChunk(double t);
+        void indexEras(size_t first);
+
+        std::vector<double> masses;
+        CalendarConfig config;
+        double timeStep;
+        Physics::Integrator::Method method;
+        std::string cachePath;
+        double chunkLength;
+        uint64_t fingerprint = 0;        // 输入参数的指纹，写入缓存头部
+
+        Physics::SystemState lastState;
+        Physics::IntegratorState integratorState;
+        EraType initialEra;
+        std::vector<CalendarEvent> events;
+        std::vector<CalendarEvent> eraChanges;   // events 中的纪元变化（按时间有序），eraAt 在其上二分
+        size_t stepsIntegrated = 0;
+
+        mutable std::string syncedPath;          // 上次保存或加载的缓存路径
+        mutable size_t syncedEvents = 0;         // 该路径的事件文件中已有的事件数
+
+        std::vector<Physics::SystemState> chunk; // 当前延伸段的采样
+        CalendarCalculator calculator;
+    };
+
+} // namespace Simulation
+
+#endif
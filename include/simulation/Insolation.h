@@ -0,0 +1,122 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#ifndef _INCLUDE_IOSFWD_
+#define _INCLUDE_IOSFWD_
+#include <iosfwd>
+#endif
+
+#ifndef _INCLUDE_FUNCTIONAL_
+#define _INCLUDE_FUNCTIONAL_
+#include <functional>
+#endif
+
+#ifndef _INCLUDE_CALENDAR_H_
+#define _INCLUDE_CALENDAR_H_
+#include "simulation/Calendar.h"
+#endif
+
+#pragma once
+
+#ifndef _INSOLATION_H_
+#define _INSOLATION_H_
+
+namespace Utils {
+    class ThreadPool;
+}
+
+namespace Simulation {
+
+    // 光照时间线的输出网格与分块参数
+    struct InsolationOptions {
+        double startTime = 0.0;
+        double endTime = 0.0;
+        double outputStep = PhysicsConstants::DAY_SECONDS;  // 输出网格间距 (s)
+        size_t chunkSamples = 4096;                         // 每块样本数
+        size_t chunksInFlight = 0;                          // 同时计算的块数，0 表示线程数的两倍
+    };
+
+    // 一块连续的输出样本。各量按恒星分段存放：第 k 颗恒星的第 i 个样本位于 [k * sampleCount + i]
+    struct InsolationChunk {
+        size_t firstSample = 0;
+        size_t sampleCount = 0;
+        size_t sunCount = 0;
+        std::vector<double> time;
+        std::vector<double> totalFlux;   // 各恒星通量之和 (W/m^2)
+        std::vector<double> distance;    // 行星到恒星的距离 (m)
+        std::vector<double> flux;        // 恒星在行星处的通量 (W/m^2)
+        std::vector<double> phaseAngle;  // 恒星相对行星的方位角 (rad, [-pi, pi])，减去自转相位即为当地时角
+
+        double distanceOf(size_t sun, size_t i) const { return distance[sun * sampleCount + i]; }
+        double fluxOf(size_t sun, size_t i) const { return flux[sun * sampleCount + i]; }
+        double phaseOf(size_t sun, size_t i) const { return phaseAngle[sun * sampleCount + i]; }
+    };
+
+    // 行星光照时间线：在固定时间网格上计算各恒星的距离、通量与方位角
+    // 状态由 provider 按时刻给出（须可被多个线程同时调用，如 Ephemeris::evaluateAll）；
+    // 各块独立计算，按时间顺序交给 sink，内存只与同时计算的块数有关
+    class InsolationTimeline {
+    public:
+        using StateProvider = CalendarCalculator::StateProvider;
+        using ChunkSink = std::function<void(const InsolationChunk&)>;
+
+        InsolationTimeline(const CalendarConfig& config,
+            const std::vector<double>& masses,
+            const InsolationOptions& options,
+            StateProvider provider);
+
+        // 网格样本总数，第 i 个样本的时刻为 startTime + i * outputStep
+        size_t sampleCount() const { return samples; }
+        size_t chunkCount() const;
+        double sampleTime(size_t i) const { return options.startTime + static_cast<double>(i) * options.outputStep; }
+
+        // 计算从 firstSample 起的 count 个样本（count 超出网格时截断），chunk 的缓冲区可复用
+        void computeChunk(size_t firstSample, size_t count, InsolationChunk& chunk) const;
+
+        // 逐块生成整条时间线；pool 非空时后续块在写出当前块的同时并行计算
+        void generate(const ChunkSink& sink, Utils::ThreadPool* pool = nullptr) const;
+
+        const CalendarConfig& getConfig() const { return config; }
+        const InsolationOptions& getOptions() const { return options; }
+
+    private:
+        CalendarConfig config;
+        InsolationOptions options;
+        StateProvider provider;
+        size_t samples = 0;
+    };
+
+    enum class InsolationFormat {
+        CSV,     // time,total_flux,<sun>_distance,<sun>_flux,<sun>_phase,...
+        BINARY   // 文件头后每个样本一行 double：time, total_flux, 再按恒星依次 distance, flux, phase
+    };
+
+    // 把时间线块按行写到流中，可直接作为 InsolationTimeline::generate 的 sink
+    class InsolationWriter {
+    public:
+        // 构造时写出文件头
+        InsolationWriter(std::ostream& out, InsolationFormat format, const std::vector<std::string>& sunNames);
+
+        void operator()(const InsolationChunk& chunk);
+
+        size_t getRowsWritten() const { return rows; }
+
+    private:
+        std::ostream& out;
+        InsolationFormat format;
+        size_t sunCount;
+        size_t rows = 0;
+        std::vector<double> buffer;
+        std::string text;
+    };
+
+} // namespace Simulation
+
+#endif
@@ -0,0 +1,113 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#ifndef _INCLUDE_EJECTIONDETECTOR_H_
+#define _INCLUDE_EJECTIONDETECTOR_H_
+#include "physics/EjectionDetector.h"
+#endif
+
+#pragma once
+
+#ifndef _SCENARIO_H_
+#define _SCENARIO_H_
+
+namespace Utils {
+    class JsonValue;
+}
+
+namespace Simulation {
+
+    // 场景中的一个天体（SI 单位）
+    struct ScenarioBody {
+        std::string name;
+        double mass = 0.0;
+        double radius = 0.0;
+        Vector3D position;
+        Vector3D velocity;
+    };
+
+    // 输出目标
+    struct ScenarioSink {
+        enum Type {
+            TRAJECTORY_CSV,   // time,body,x,y,z,vx,vy,vz，每 every 步一行/天体
+            FINAL_STATE_JSON  // 结束时的状态与统计
+        };
+        Type type = FINAL_STATE_JSON;
+        std::string path;
+        size_t every = 1;
+    };
+
+    // 逃逸天体的处理（仅固定步长）
+    enum class EjectionMode {
+        NONE,       // 照常积分
+        STOP,       // 判定有天体逃逸即结束
+        ANALYTIC    // 逃逸天体移出受力计算，改为二体解析外推（Physics::EscapePropagator）
+    };
+
+    // 一次模拟的完整描述：初值、积分方法、步长 / 容差与输出
+    struct Scenario {
+        std::string name;
+        std::vector<ScenarioBody> bodies;
+        Physics::Integrator::Method method = Physics::Integrator::RUNGE_KUTTA_4;
+        bool adaptive = false;                 // true 时使用 integrateAdaptive，忽略 method 与 timeStep
+        double timeStep = 3600.0;              // s
+        double duration = 0.0;                 // s
+        Physics::AdaptiveOptions tolerances;
+        EjectionMode ejection = EjectionMode::NONE;
+        Physics::EjectionCriteria ejectionCriteria;
+        std::vector<ScenarioSink> sinks;
+
+        Physics::SystemState initialState() const;
+        std::vector<double> masses() const;
+    };
+
+    // 单个场景的运行结果
+    struct ScenarioResult {
+        std::string name;
+        Physics::SystemState finalState;
+        size_t steps = 0;
+        double relativeEnergyError = 0.0;
+        std::vector<Physics::EjectionEvent> ejections;
+    };
+
+    // 场景文件读取
+    //
+    // JSON：顶层为单个场景对象，或 {"defaults": {...}, "scenarios": [...]}，defaults 中的字段作为各场景的缺省值。
+    // CSV：每行一个天体，首行为列名；必需列 scenario,name,mass,x,y,z,vx,vy,vz，
+    // 可选列 radius,method,step,duration,rtol,atol（场景级的列取该场景第一行的值）。
+    // 同一场景的行必须相邻。CSV 逐行直接解析，不构造中间文档，适合大批量扫描输入。
+    // 输出路径中的 {name} 替换为场景名；同一文件中的输出路径不得重复（场景并行运行），
+    // 因此 defaults 中给出的输出须在路径中带 {name}。
+    // 逃逸处理只能在 JSON 中设置："ejection": "none" / "stop" / "analytic"，"ejection_factor": 30。
+    // 格式错误时抛出 std::runtime_error，信息中带行号或场景名
+    class ScenarioLoader {
+    public:
+        static std::vector<Scenario> loadFile(const std::string& path);
+        static std::vector<Scenario> parseJson(const std::string& text);
+        static std::vector<Scenario> parseCsv(const std::string& text);
+
+        // 由已解析的单个场景对象构造，字段与场景文件相同
+        static Scenario fromJson(const Utils::JsonValue& object);
+
+        // "euler" / "rk4" / "verlet" / "dopri45" / "adaptive"
+        static void parseMethod(const std::string& name, Scenario& scenario);
+    };
+
+    // 运行一个场景并写出其全部输出
+    ScenarioResult runScenario(const Scenario& scenario);
+
+} // namespace Simulation
+
+#endif
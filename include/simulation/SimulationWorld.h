@@ -0,0 +1,146 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#ifndef _INCLUDE_CELESTIALBODY_H_
+#define _INCLUDE_CELESTIALBODY_H_
+#include "physics/CelestialBody.h"
+#endif
+
+#ifndef _INCLUDE_COLLISIONDETECTOR_H_
+#define _INCLUDE_COLLISIONDETECTOR_H_
+#include "physics/CollisionDetector.h"
+#endif
+
+#pragma once
+
+#ifndef _SIMULATIONWORLD_H_
+#define _SIMULATIONWORLD_H_
+
+namespace Simulation {
+
+    class SimulationWorld;
+
+    // 天体在 SimulationWorld 中的编号（添加顺序，即 SystemState 中的下标）。
+    // 碰撞合并会压缩数组，之后的编号随之前移
+    using BodyId = size_t;
+
+    // 碰撞处理方式
+    enum class CollisionResponse {
+        NONE,   // 不检测（天体可以互相穿过）
+        MERGE,  // 合并为一个天体：质量、动量守恒，体积相加，被合并的天体从数组中移除
+        STOP    // 记录碰撞并停止积分，由调用方决定如何处理
+    };
+
+    // 一次碰撞的记录
+    struct CollisionEvent {
+        double time;           // 检测到碰撞的步结束时刻 (s)
+        std::string first;     // 较重（合并后保留）的天体
+        std::string second;
+        Vector3D position;     // 合并后的质心；STOP 时为两者质心
+        double relativeSpeed;  // 相对速度 (m/s)
+    };
+
+    // 指向某个天体的只读视图，只保存 world 指针与编号，取值直接引用连续存储，不复制。
+    // 添加天体后，之前取得的引用可能失效，但视图本身仍然有效
+    class BodyView {
+    public:
+        BodyView(const SimulationWorld& world, BodyId id) : world(&world), id(id) {}
+
+        BodyId getId() const { return id; }
+        const std::string& getName() const;
+        double getMass() const;
+        double getRadius() const;
+        const Vector3D& getPosition() const;
+        const Vector3D& getVelocity() const;
+        const Vector3D& getAcceleration() const;
+
+    private:
+        const SimulationWorld* world;
+        BodyId id;
+    };
+
+    // 天体注册表 + 积分状态：名称、质量、半径、位置、速度各自存放在连续数组中，
+    // 位置与速度就是积分器使用的 SystemState，积分时不需要与 CelestialBody 来回同步
+    class SimulationWorld {
+    public:
+        explicit SimulationWorld(Physics::Integrator::Method method = Physics::Integrator::RUNGE_KUTTA_4);
+
+        BodyId addBody(const std::string& name, double mass, double radius,
+            const Vector3D& position = Vector3D::zero(), const Vector3D& velocity = Vector3D::zero());
+        BodyId addBody(const CelestialBody& body);
+
+        size_t size() const { return masses.size(); }
+        BodyView body(BodyId id) const { return BodyView(*this, id); }
+
+        // 按名称查找，不存在时抛出 std::out_of_range
+        BodyId find(const std::string& name) const;
+
+        const std::string& getName(BodyId id) const { return names[id]; }
+        double getMass(BodyId id) const { return masses[id]; }
+        double getRadius(BodyId id) const { return radii[id]; }
+        const Vector3D& getPosition(BodyId id) const { return state.positions[id]; }
+        const Vector3D& getVelocity(BodyId id) const { return state.velocities[id]; }
+        // 当前状态下的引力加速度，状态改变后首次访问时重新计算
+        const Vector3D& getAcceleration(BodyId id) const;
+
+        void setPosition(BodyId id, const Vector3D& position);
+        void setVelocity(BodyId id, const Vector3D& velocity);
+
+        // 整体访问：积分器与引力计算直接使用这些数组
+        const Physics::SystemState& getState() const { return state; }
+        const std::vector<double>& getMasses() const { return masses; }
+        const std::vector<double>& getRadii() const { return radii; }
+        double getTime() const { return state.time; }
+
+        // 原地积分，每步结束后调用 onStep。启用碰撞检测时每步之后检测并处理碰撞，
+        // STOP 模式下发生碰撞的那一步结束后提前返回
+        void step(double dt);
+        void advance(double totalTime, double timeStep, const Physics::StepCallback& onStep = nullptr);
+
+        // 碰撞检测
+        void setCollisionResponse(CollisionResponse response) { collisionResponse = response; }
+        CollisionResponse getCollisionResponse() const { return collisionResponse; }
+        const std::vector<CollisionEvent>& getCollisions() const { return collisions; }
+        // STOP 模式下已停止；clearCollisions 清除记录并允许继续积分
+        bool isHalted() const { return halted; }
+        void clearCollisions() { collisions.clear(); halted = false; }
+
+        // 写回到 CelestialBody（兼容旧接口）
+        void copyTo(BodyId id, CelestialBody& body) const;
+
+        Physics::Integrator& getIntegrator() { return integrator; }
+
+    private:
+        void invalidate() { accelerationsValid = false; }
+        // 检测本步的碰撞并按 collisionResponse 处理，返回是否发生了碰撞
+        bool resolveCollisions(const std::vector<Vector3D>& previous);
+
+        std::vector<std::string> names;
+        std::vector<double> masses;
+        std::vector<double> radii;
+        Physics::SystemState state;
+
+        Physics::Integrator integrator;
+        CollisionResponse collisionResponse = CollisionResponse::NONE;
+        Physics::CollisionDetector detector;
+        std::vector<CollisionEvent> collisions;
+        bool halted = false;
+        mutable Physics::SystemState derivatives;
+        mutable bool accelerationsValid = false;
+    };
+
+} // namespace Simulation
+
+#endif
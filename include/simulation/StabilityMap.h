@@ -0,0 +1,196 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#ifndef _INCLUDE_FUNCTIONAL_
+#define _INCLUDE_FUNCTIONAL_
+#include <functional>
+#endif
+
+#ifndef _INCLUDE_CSTDINT_
+#define _INCLUDE_CSTDINT_
+#include <cstdint>
+#endif
+
+#ifndef _INCLUDE_ATOMIC_
+#define _INCLUDE_ATOMIC_
+#include <atomic>
+#endif
+
+#ifndef _INCLUDE_FSTREAM_
+#define _INCLUDE_FSTREAM_
+#include <fstream>
+#endif
+
+#ifndef _INCLUDE_MUTEX_
+#define _INCLUDE_MUTEX_
+#include <mutex>
+#endif
+
+#ifndef _INCLUDE_SCENARIO_H_
+#define _INCLUDE_SCENARIO_H_
+#include "simulation/Scenario.h"
+#endif
+
+#pragma once
+
+#ifndef _STABILITYMAP_H_
+#define _STABILITYMAP_H_
+
+namespace Utils {
+    class ThreadPool;
+    class JsonValue;
+}
+
+namespace Simulation {
+
+    // 稳定性图的扫描参数：行星绕宿主恒星的密切轨道根数
+    enum class StabilityParameter {
+        SEMI_MAJOR_AXIS,   // m
+        ECCENTRICITY,
+        INCLINATION,       // rad，绕 x 轴
+        TRUE_ANOMALY       // rad，0 为近心点
+    };
+
+    // 行星的初始轨道；未作为扫描轴的根数取这里的值
+    struct PlanetOrbit {
+        std::string name = "Planet";
+        size_t host = 0;                 // 宿主恒星在 system.bodies 中的序号
+        double mass = 0.0;
+        double radius = 0.0;
+        double semiMajorAxis = 0.0;
+        double eccentricity = 0.0;
+        double inclination = 0.0;
+        double trueAnomaly = 0.0;
+
+        void set(StabilityParameter parameter, double value);
+    };
+
+    // 一条扫描轴，取各格中心的值
+    struct StabilityAxis {
+        StabilityParameter parameter = StabilityParameter::SEMI_MAJOR_AXIS;
+        double min = 0.0;
+        double max = 0.0;
+        uint32_t cells = 1;
+
+        double valueAt(double index) const { return min + (max - min) * (index + 0.5) / cells; }
+    };
+
+    enum class CellOutcome : uint32_t {
+        PENDING = 0,    // 尚未计算
+        SURVIVED,       // 到达时间上限
+        EJECTED,        // 有天体离质心超过 escapeDistance，或已被判定为逃逸
+        COLLIDED        // 两天体距离小于半径之和
+    };
+
+    // 单格结果，endTime 为相对起始时刻的结束时间 (s)，megno 仅在 computeMegno 时有效
+    struct CellResult {
+        double endTime = 0.0;
+        double megno = 0.0;
+        CellOutcome outcome = CellOutcome::PENDING;
+    };
+
+    // 稳定性图：固定的恒星初值 + 按两条轴扫描的行星轨道。积分方法、步长与时间上限取自 system
+    //
+    // JSON 格式：
+    // { "system": {场景对象，见 ScenarioLoader}, "planet": {"name", "host", "mass", "radius",
+    //   "semi_major_axis", "eccentricity", "inclination", "true_anomaly"},
+    //   "x": {"parameter": "semi_major_axis", "min", "max", "cells"}, "y": {...},
+    //   "tile": 8, "escape_distance": 0, "ejection_factor": 10, "megno": false }
+    // escape_distance 为 0 时取初始构型到质心最大距离的 100 倍。ejection_factor 大于 0 时每步还用
+    // Physics::EjectionDetector 检查（距离阈值为其余天体尺度的该倍数），一旦判定逃逸即结束，为 0 时关闭
+    struct StabilityMapConfig {
+        Scenario system;
+        PlanetOrbit planet;
+        StabilityAxis x;
+        StabilityAxis y;
+        uint32_t tileSize = 8;
+        double escapeDistance = 0.0;
+        double ejectionFactor = 10.0;
+        bool computeMegno = false;
+
+        // 参数值为 (xValue, yValue) 时的初始状态与质量（行星为最后一个天体）
+        Physics::SystemState initialState(double xValue, double yValue) const;
+        std::vector<double> masses() const;
+        std::vector<double> radii() const;
+
+        // 配置的指纹，续算时用于确认栅格文件属于同一张图
+        uint64_t fingerprint() const;
+
+        static StabilityMapConfig fromJson(const Utils::JsonValue& document);
+        static StabilityMapConfig loadFile(const std::string& path);
+        static StabilityParameter parseParameter(const std::string& name);
+    };
+
+    // 计算参数值为 (xValue, yValue) 的一格。2 到 4 个天体且不计算 MEGNO 时走编译期定长路径
+    CellResult runStabilityCell(const StabilityMapConfig& config, double xValue, double yValue);
+
+    // 稳定性图的二进制栅格文件，可在中断后续算
+    //
+    // 布局：文件头（魔数、指纹、宽高、瓦片边长），每个瓦片一个完成标志字节，再按行存放各格记录。
+    // 一个瓦片的记录先写入并刷新，之后才置完成标志，进程在任何时刻被终止都不会留下标记完成却不完整的瓦片
+    class StabilityRaster {
+    public:
+        // 打开已有文件续算（指纹或尺寸不符时抛出 runtime_error），或新建一个全部未完成的文件
+        StabilityRaster(const std::string& path, const StabilityMapConfig& config);
+
+        uint32_t getWidth() const { return width; }
+        uint32_t getHeight() const { return height; }
+        uint32_t getTileSize() const { return tileSize; }
+        size_t tileCount() const { return done.size(); }
+        size_t tilesDone() const;
+        bool isTileDone(size_t tile) const { return done[tile] != 0; }
+
+        // 瓦片 tile 覆盖的格子范围 [x0, x1) x [y0, y1)
+        void tileBounds(size_t tile, uint32_t& x0, uint32_t& y0, uint32_t& x1, uint32_t& y1) const;
+
+        // 写入一个瓦片的结果（按瓦片内行优先排列）并标记完成，可被多个线程同时调用
+        void writeTile(size_t tile, const std::vector<CellResult>& cells);
+
+        // 读取一行结果
+        std::vector<CellResult> readRow(uint32_t row);
+
+        // 8 位灰度 PGM：存活为白，失稳按存活时间的对数由暗到亮，未计算为黑
+        void writeImage(const std::string& path, double duration, double timeStep);
+
+    private:
+        uint64_t recordOffset(uint32_t x, uint32_t y) const;
+
+        std::string path;
+        std::fstream file;
+        mutable std::mutex mutex;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t tileSize = 0;
+        uint32_t tilesX = 0;
+        std::vector<uint8_t> done;
+        uint64_t flagsOffset = 0;
+        uint64_t recordsOffset = 0;
+    };
+
+    // 运行参数
+    struct StabilityRunOptions {
+        Utils::ThreadPool* pool = nullptr;            // 为空时串行
+        const std::atomic<bool>* stop = nullptr;      // 置位后不再领取新瓦片，已开始的瓦片照常完成
+        std::function<void(size_t tile, size_t done, size_t total)> onTile;  // 每完成一个瓦片调用（持锁串行）
+    };
+
+    // 计算栅格中尚未完成的瓦片。线程从队列中动态领取瓦片，完成后立即写入文件。返回本次完成的瓦片数
+    size_t runStabilityMap(const StabilityMapConfig& config, StabilityRaster& raster,
+        const StabilityRunOptions& options = StabilityRunOptions());
+
+    // 8 位灰度 PGM，row(y) 返回第 y 行的结果；图像第一行对应 y 轴最大值
+    void writeStabilityImage(const std::string& path, uint32_t width, uint32_t height,
+        const std::function<std::vector<CellResult>(uint32_t)>& row, double duration, double timeStep);
+
+    const char* toString(CellOutcome outcome);
+
+} // namespace Simulation
+
+#endif
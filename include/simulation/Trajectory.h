@@ -0,0 +1,37 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_CORE_VECTOR3D_H_
+#define _INCLUDE_CORE_VECTOR3D_H_
+#include "core/Vector3D.h"
+#endif
+
+#ifndef _INCLUDE_INTEGRATOR_H_
+#define _INCLUDE_INTEGRATOR_H_
+#include "physics/Integrator.h"
+#endif
+
+#pragma once
+
+#ifndef _TRAJECTORY_H_
+#define _TRAJECTORY_H_
+
+namespace Simulation {
+
+    // 在两个采样状态 a、b 之间做三次 Hermite 插值（同时利用位置和速度）
+    Vector3D hermitePosition(const Physics::SystemState& a, const Physics::SystemState& b,
+        size_t body, double t);
+
+    // 同上，同时给出所有天体的位置与速度
+    void hermiteInterpolate(const Physics::SystemState& a, const Physics::SystemState& b,
+        double t, Physics::SystemState& out);
+
+    // 在按时间递增的采样序列中插值，超出范围时取端点区间外推
+    void interpolateTrajectory(const std::vector<Physics::SystemState>& samples,
+        double t, Physics::SystemState& out);
+
+} // namespace Simulation
+
+#endif
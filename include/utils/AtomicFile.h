@@ -0,0 +1,34 @@
+﻿#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+#pragma once
+
+#ifndef _ATOMICFILE_H_
+#define _ATOMICFILE_H_
+
+namespace Utils {
+
+    // 用写好的临时文件原子地替换目标文件：任何时刻目标要么是旧内容、要么是新内容。
+    // POSIX 的 rename 会覆盖已有文件；Windows 上 rename 遇到已有文件会失败，改用 MoveFileEx。
+    // 失败时返回 false，临时文件保留
+    inline bool replaceFile(const std::string& temp, const std::string& path) {
+#ifdef _WIN32
+        return MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        return std::rename(temp.c_str(), path.c_str()) == 0;
+#endif
+    }
+
+} // namespace Utils
+
+#endif
@@ -0,0 +1,61 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+
+#pragma once
+
+#ifndef _BINARYIO_H_
+#define _BINARYIO_H_
+
+namespace Utils {
+
+    // 以本机字节序读写平凡类型，用于星历与缓存文件
+    template <typename T>
+    void writePod(std::ostream& out, const T& value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    void writeArray(std::ostream& out, const std::vector<T>& values) {
+        if (!values.empty()) {
+            out.write(reinterpret_cast<const char*>(values.data()), sizeof(T) * values.size());
+        }
+    }
+
+    template <typename T>
+    T readPod(std::istream& in) {
+        T value{};
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(T))) {
+            throw std::runtime_error("Binary file truncated");
+        }
+        return value;
+    }
+
+    template <typename T>
+    void readArray(std::istream& in, std::vector<T>& values, size_t count) {
+        values.resize(count);
+        if (count > 0 && !in.read(reinterpret_cast<char*>(values.data()), sizeof(T) * count)) {
+            throw std::runtime_error("Binary file truncated");
+        }
+    }
+
+    // FNV-1a，用于缓存文件记录输入参数的指纹
+    inline uint64_t hashBytes(const std::string& bytes) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : bytes) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+} // namespace Utils
+
+#endif
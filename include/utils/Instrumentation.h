@@ -0,0 +1,158 @@
+﻿#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#pragma once
+
+#ifndef _INSTRUMENTATION_H_
+#define _INSTRUMENTATION_H_
+
+// 热路径埋点：定义 THREEBODY_ENABLE_INSTRUMENTATION（CMake 选项同名）时生效，否则宏展开为空
+#ifdef THREEBODY_ENABLE_INSTRUMENTATION
+#define THREEBODY_INSTRUMENTATION_CONCAT_(a, b) a##b
+#define THREEBODY_INSTRUMENTATION_CONCAT(a, b) THREEBODY_INSTRUMENTATION_CONCAT_(a, b)
+#define THREEBODY_COUNT(counter, n) \
+    ::Utils::Instrumentation::add(::Utils::Instrumentation::Counter::counter, static_cast<uint64_t>(n))
+#define THREEBODY_PHASE(phase) \
+    ::Utils::Instrumentation::ScopedPhase THREEBODY_INSTRUMENTATION_CONCAT(threebodyPhase_, __LINE__)( \
+        ::Utils::Instrumentation::Phase::phase)
+#else
+#define THREEBODY_COUNT(counter, n) ((void)0)
+#define THREEBODY_PHASE(phase) ((void)0)
+#endif
+
+namespace Utils {
+namespace Instrumentation {
+
+    enum class Counter {
+        FORCE_EVALUATIONS,   // 导数（受力）计算次数
+        PAIR_INTERACTIONS,   // 计算过的天体对
+        STEPS,               // 积分步数（自适应积分只计接受的步）
+        REJECTED_STEPS,      // 自适应积分拒绝的步
+        BYTES_WRITTEN,       // 星历、缓存文件与服务响应写出的字节
+        COUNT
+    };
+
+    enum class Phase {
+        FORCE,               // 受力计算
+        STAGE_UPDATE,        // 积分器各级状态更新
+        IO,                  // 文件读写
+        EVENTS,              // 日出、纪元等事件搜索
+        COUNT
+    };
+
+    constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::COUNT);
+    constexpr size_t PHASE_COUNT = static_cast<size_t>(Phase::COUNT);
+
+    const char* counterName(Counter counter);
+    const char* phaseName(Phase phase);
+
+    // 每线程一块计数区，只由所属线程写入（relaxed 读改写，无锁前缀指令），汇总时由其他线程读取
+    struct ThreadBlock {
+        std::atomic<uint64_t> counters[COUNTER_COUNT] = {};
+        std::atomic<uint64_t> phaseTicks[PHASE_COUNT] = {};      // 只含被采样的调用
+        std::atomic<uint64_t> phaseCalls[PHASE_COUNT] = {};
+        std::atomic<uint64_t> phaseSampledCalls[PHASE_COUNT] = {};
+    };
+
+    // 阶段计时每 PHASE_SAMPLE_PERIOD 次调用计时一次（每线程第一次必计时），汇总时按调用次数比例放大。
+    // 读时钟本身约 10-40 ns，逐次计时在小规模受力计算上开销会超过 1%
+    constexpr uint64_t PHASE_SAMPLE_PERIOD = 16;
+
+    // 首次使用时把本线程的计数区登记到全局表，线程退出时并入累计值
+    class ThreadBlockHandle {
+    public:
+        ThreadBlockHandle();
+        ~ThreadBlockHandle();
+        ThreadBlock* block;
+    };
+
+    inline ThreadBlock& localBlock() {
+        thread_local ThreadBlockHandle handle;
+        return *handle.block;
+    }
+
+    inline void bump(std::atomic<uint64_t>& value, uint64_t n) {
+        value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    inline void add(Counter counter, uint64_t n = 1) {
+        bump(localBlock().counters[static_cast<size_t>(counter)], n);
+    }
+
+    // 计时用的廉价时钟：x86 上为 TSC，其余平台为 steady_clock 纳秒；换算在汇总时完成
+    inline uint64_t ticks() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+        return __rdtsc();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        return __builtin_ia32_rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // 作用域计时，析构时把耗时计入对应阶段（嵌套的阶段各自计时，不做扣除）
+    class ScopedPhase {
+    public:
+        explicit ScopedPhase(Phase phase) : block(localBlock()), index(static_cast<size_t>(phase)) {
+            uint64_t calls = block.phaseCalls[index].load(std::memory_order_relaxed);
+            block.phaseCalls[index].store(calls + 1, std::memory_order_relaxed);
+            sampled = calls % PHASE_SAMPLE_PERIOD == 0;
+            if (sampled) start = ticks();
+        }
+        ~ScopedPhase() {
+            if (sampled) {
+                bump(block.phaseTicks[index], ticks() - start);
+                bump(block.phaseSampledCalls[index], 1);
+            }
+        }
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    private:
+        ThreadBlock& block;
+        size_t index;
+        bool sampled;
+        uint64_t start = 0;
+    };
+
+    // 所有线程计数的汇总
+    struct Snapshot {
+        uint64_t counters[COUNTER_COUNT] = {};
+        uint64_t phaseCalls[PHASE_COUNT] = {};
+        double phaseSeconds[PHASE_COUNT] = {};   // 由采样调用按比例估计
+        double wallSeconds = 0.0;      // 自上次 reset（或程序启动）以来的时长
+        size_t threads = 0;            // 参与过计数的线程数
+
+        uint64_t counter(Counter c) const { return counters[static_cast<size_t>(c)]; }
+        double seconds(Phase p) const { return phaseSeconds[static_cast<size_t>(p)]; }
+        uint64_t calls(Phase p) const { return phaseCalls[static_cast<size_t>(p)]; }
+    };
+
+    Snapshot snapshot();
+
+    // 清零所有计数；应在没有其他线程正在计数时调用
+    void reset();
+
+    void writeJson(std::ostream& out, const Snapshot& snap);
+    void writePrometheus(std::ostream& out, const Snapshot& snap);
+
+    // 写出快照文件：扩展名为 .prom 时用 Prometheus 文本格式，否则为 JSON。
+    // 先写临时文件再改名，供 node_exporter textfile collector 等轮询方读取
+    void saveSnapshot(const std::string& path, const Snapshot& snap);
+
+} // namespace Instrumentation
+} // namespace Utils
+
+#endif
@@ -0,0 +1,82 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#include <ostream>
+#include <utility>
+
+#pragma once
+
+#ifndef _JSON_H_
+#define _JSON_H_
+
+namespace Utils {
+
+    // 最小 JSON 文档模型：用于基准线、场景等配置文件，不追求通用性。
+    // 对象保持键的原始顺序，查找为线性扫描（配置文件的键数很少）
+    class JsonValue {
+    public:
+        enum Type { NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT };
+
+        JsonValue() = default;
+        JsonValue(bool value) : type(BOOLEAN), boolean(value) {}
+        JsonValue(double value) : type(NUMBER), number(value) {}
+        JsonValue(const char* value) : type(STRING), text(value) {}
+        JsonValue(std::string value) : type(STRING), text(std::move(value)) {}
+
+        static JsonValue array() { JsonValue v; v.type = ARRAY; return v; }
+        static JsonValue object() { JsonValue v; v.type = OBJECT; return v; }
+
+        // 解析失败时抛出 std::runtime_error，信息中带行号
+        static JsonValue parse(const std::string& text);
+        static JsonValue parseFile(const std::string& path);
+
+        Type getType() const { return type; }
+        bool isNull() const { return type == NUL; }
+        bool isNumber() const { return type == NUMBER; }
+        bool isString() const { return type == STRING; }
+        bool isArray() const { return type == ARRAY; }
+        bool isObject() const { return type == OBJECT; }
+
+        // 类型不符时抛出 std::runtime_error
+        bool asBool() const;
+        double asNumber() const;
+        const std::string& asString() const;
+
+        // 数组与对象
+        size_t size() const;
+        const JsonValue& operator[](size_t i) const;
+        const std::vector<std::pair<std::string, JsonValue>>& members() const;
+
+        // 对象成员：find 找不到返回 nullptr，at 找不到抛出异常
+        const JsonValue* find(const std::string& key) const;
+        const JsonValue& at(const std::string& key) const;
+        double numberOr(const std::string& key, double fallback) const;
+        std::string stringOr(const std::string& key, const std::string& fallback) const;
+
+        // 修改（按值传入，临时对象直接移动进来）
+        void push(JsonValue value);
+        void set(const std::string& key, JsonValue value);
+
+        void write(std::ostream& out, int indent = 2) const;
+
+    private:
+        void writeIndented(std::ostream& out, int indent, int depth) const;
+
+        Type type = NUL;
+        bool boolean = false;
+        double number = 0.0;
+        std::string text;
+        std::vector<JsonValue> items;
+        std::vector<std::pair<std::string, JsonValue>> fields;
+    };
+
+} // namespace Utils
+
+#endif
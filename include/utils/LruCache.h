@@ -0,0 +1,81 @@
+﻿#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#pragma once
+
+#ifndef _LRUCACHE_H_
+#define _LRUCACHE_H_
+
+namespace Utils {
+
+    // 线程安全的定长 LRU 缓存
+    template <typename Key, typename Value>
+    class LruCache {
+    public:
+        explicit LruCache(size_t capacity) : capacity(capacity == 0 ? 1 : capacity) {}
+
+        // 命中时返回 true 并把条目移到最前
+        bool get(const Key& key, Value& value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(key);
+            if (it == index.end()) {
+                ++misses;
+                return false;
+            }
+            entries.splice(entries.begin(), entries, it->second);
+            value = it->second->second;
+            ++hits;
+            return true;
+        }
+
+        void put(const Key& key, const Value& value) {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(key);
+            if (it != index.end()) {
+                it->second->second = value;
+                entries.splice(entries.begin(), entries, it->second);
+                return;
+            }
+            entries.emplace_front(key, value);
+            index[key] = entries.begin();
+            if (entries.size() > capacity) {
+                index.erase(entries.back().first);
+                entries.pop_back();
+            }
+        }
+
+        // 未命中时在锁外调用 loader，允许并发加载不同条目
+        template <typename Loader>
+        Value getOrLoad(const Key& key, Loader&& loader) {
+            Value value;
+            if (get(key, value)) return value;
+            value = loader();
+            put(key, value);
+            return value;
+        }
+
+        size_t size() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return entries.size();
+        }
+
+        size_t getCapacity() const { return capacity; }
+        size_t getHits() const { std::lock_guard<std::mutex> lock(mutex); return hits; }
+        size_t getMisses() const { std::lock_guard<std::mutex> lock(mutex); return misses; }
+
+    private:
+        using Entry = std::pair<Key, Value>;
+
+        size_t capacity;
+        std::list<Entry> entries;
+        std::unordered_map<Key, typename std::list<Entry>::iterator> index;
+        mutable std::mutex mutex;
+        size_t hits = 0;
+        size_t misses = 0;
+    };
+
+} // namespace Utils
+
+#endif
@@ -0,0 +1,70 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_CSTDDEF_
+#define _INCLUDE_CSTDDEF_
+#include <cstddef>
+#endif
+
+#ifndef _INCLUDE_CSTDINT_
+#define _INCLUDE_CSTDINT_
+#include <cstdint>
+#endif
+
+#pragma once
+
+#ifndef _SLIDINGSTATS_H_
+#define _SLIDINGSTATS_H_
+
+namespace Utils {
+
+    // 最近 window 个样本的均值、方差与极值
+    // 均值和方差按 Welford 方式增删样本，极值用单调队列，每次 push 摊还 O(1)；
+    // 每推入 window 个样本按环形缓冲重算一次均值和方差，防止长时间运行的舍入漂移
+    class SlidingStats {
+    public:
+        explicit SlidingStats(size_t window = 1);
+
+        void push(double x);
+        void clear();
+
+        size_t count() const { return filled; }
+        size_t capacity() const { return values.size(); }
+        bool full() const { return filled == values.size(); }
+
+        double mean() const { return average; }
+        double variance() const;         // 总体方差
+        double stddev() const;
+        double min() const;              // 窗口为空时返回 0
+        double max() const;
+
+    private:
+        // 单调队列：按样本顺序保存仍可能成为极值的样本及其序号
+        struct Candidate {
+            double value;
+            uint64_t index;
+        };
+        struct MonotonicQueue {
+            std::vector<Candidate> slots;  // 容量为 window 的环形数组
+            size_t head = 0;
+            size_t size = 0;
+        };
+
+        void pushExtremum(MonotonicQueue& queue, double x, bool keepLarger);
+        void resync();
+
+        std::vector<double> values;      // 环形缓冲，第 k 个样本位于 [k % window]
+        uint64_t pushed = 0;
+        size_t cursor = 0;               // pushed % window
+        size_t filled = 0;
+        double average = 0.0;
+        double m2 = 0.0;                 // 与均值之差的平方和
+        MonotonicQueue maxQueue;
+        MonotonicQueue minQueue;
+    };
+
+} // namespace Utils
+
+#endif
@@ -0,0 +1,98 @@
+﻿#ifndef _INCLUDE_CSTDINT_
+#define _INCLUDE_CSTDINT_
+#include <cstdint>
+#endif
+
+#ifndef _INCLUDE_CORE_VECTOR3D_H_
+#define _INCLUDE_CORE_VECTOR3D_H_
+#include "core/Vector3D.h"
+#endif
+
+#include <cmath>
+
+#pragma once
+
+#ifndef _SUMMATION_H_
+#define _SUMMATION_H_
+
+namespace Utils {
+
+    // 求和方式
+    enum class SummationMode {
+        NAIVE,      // 顺序累加
+        KAHAN,      // Neumaier 补偿求和
+        PAIRWISE    // 成对（二叉树）求和，O(log n) 额外空间
+    };
+
+    class NaiveSum {
+    public:
+        void add(double x) { sum += x; }
+        double value() const { return sum; }
+
+    private:
+        double sum = 0.0;
+    };
+
+    class KahanSum {
+    public:
+        void add(double x) {
+            double t = sum + x;
+            if (std::fabs(sum) >= std::fabs(x)) {
+                compensation += (sum - t) + x;
+            } else {
+                compensation += (x - t) + sum;
+            }
+            sum = t;
+        }
+        double value() const { return sum + compensation; }
+
+    private:
+        double sum = 0.0;
+        double compensation = 0.0;
+    };
+
+    // 流式成对求和：第 k 层保存 2^k 个元素的部分和，归约树形状只取决于元素个数
+    class PairwiseSum {
+    public:
+        void add(double x) {
+            double carry = x;
+            int level = 0;
+            while (count & (uint64_t(1) << level)) {
+                carry = partial[level] + carry;
+                ++level;
+            }
+            partial[level] = carry;
+            ++count;
+        }
+
+        double value() const {
+            double sum = 0.0;
+            for (int level = 0; level < 64; ++level) {
+                if (count & (uint64_t(1) << level)) sum = partial[level] + sum;
+            }
+            return sum;
+        }
+
+    private:
+        double partial[64] = {};
+        uint64_t count = 0;
+    };
+
+    // 三个分量分别累加的向量求和
+    template <typename Accumulator>
+    class VectorSum {
+    public:
+        void add(const Vector3D& v) { x.add(v.x); y.add(v.y); z.add(v.z); }
+        Vector3D value() const { return Vector3D(x.value(), y.value(), z.value()); }
+
+    private:
+        Accumulator x, y, z;
+    };
+
+    // 按下标二分的固定形状归约树
+    double pairwiseReduce(const double* values, size_t count);
+    Vector3D pairwiseReduce(const Vector3D* values, size_t count);
+
+} // namespace Utils
+
+#endif
@@ -0,0 +1,65 @@
+﻿#ifndef _INCLUDE_VECTOR_
+#define _INCLUDE_VECTOR_
+#include <vector>
+#endif
+
+#ifndef _INCLUDE_FUNCTIONAL_
+#define _INCLUDE_FUNCTIONAL_
+#include <functional>
+#endif
+
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#pragma once
+
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+namespace Utils {
+
+    // 固定线程数的任务池
+    class ThreadPool {
+    public:
+        // numThreads 为 0 时使用硬件并发数
+        explicit ThreadPool(size_t numThreads = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // 提交任务，返回结果的 future
+        template <typename F>
+        auto submit(F&& task) -> std::future<decltype(task())> {
+            using Result = decltype(task());
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+            std::future<Result> result = packaged->get_future();
+            enqueue([packaged]() { (*packaged)(); });
+            return result;
+        }
+
+        // 将 [begin, end) 按 chunkSize 切块并行执行 body(chunkBegin, chunkEnd)，返回前全部完成；
+        // 某块抛出异常时仍等待所有块结束，再重新抛出第一个异常
+        void parallelFor(size_t begin, size_t end, size_t chunkSize,
+            const std::function<void(size_t, size_t)>& body);
+
+        size_t size() const { return workers.size(); }
+
+    private:
+        void enqueue(std::function<void()> job);
+        void workerLoop(size_t index);
+
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> jobs;
+        std::mutex mutex;
+        std::condition_variable available;
+        bool stopping = false;
+    };
+
+} // namespace Utils
+
+#endif
@@ -0,0 +1,78 @@
+﻿#ifndef _INCLUDE_STRING_
+#define _INCLUDE_STRING_
+#include <string>
+#endif
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+#pragma once
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+// 时间线追踪：定义 THREEBODY_ENABLE_TRACING（CMake 选项同名）时宏生效，否则展开为空。
+// 编译进来后仍需 Trace::start() 才开始记录
+#ifdef THREEBODY_ENABLE_TRACING
+#define THREEBODY_TRACE_CONCAT_(a, b) a##b
+#define THREEBODY_TRACE_CONCAT(a, b) THREEBODY_TRACE_CONCAT_(a, b)
+#define THREEBODY_TRACE_SCOPE(name, category) \
+    ::Utils::Trace::Scope THREEBODY_TRACE_CONCAT(threebodyTrace_, __LINE__)(name, category)
+#define THREEBODY_TRACE_THREAD_NAME(name) ::Utils::Trace::setThreadName(name)
+#else
+#define THREEBODY_TRACE_SCOPE(name, category) ((void)0)
+#define THREEBODY_TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+namespace Utils {
+namespace Trace {
+
+    // 开始记录（清空之前的记录）。每个线程一个环形缓冲区，容量为 eventsPerThread，
+    // 写满后覆盖最旧的事件，长时间运行时保留的是最近一段时间线。
+    // 可在其他线程仍在记录时调用：旧缓冲区不会被改动，各线程下一次记录时换用新的缓冲区
+    void start(size_t eventsPerThread = 1 << 16);
+    void stop();
+
+    namespace detail {
+        extern std::atomic<bool> enabled;
+        uint64_t now();
+        void record(const char* name, const char* category, uint64_t begin, uint64_t end);
+    }
+
+    inline bool isEnabled() { return detail::enabled.load(std::memory_order_relaxed); }
+
+    // 设置当前线程在时间线中显示的名字
+    void setThreadName(const std::string& name);
+
+    // 作用域事件，析构时记录一条完整事件（开始时刻 + 时长）。
+    // name 与 category 须为静态存储期的字符串（通常是字面量）
+    class Scope {
+    public:
+        Scope(const char* name, const char* category)
+            : name(name), category(category), active(isEnabled()), begin(active ? detail::now() : 0) {}
+        ~Scope() {
+            if (active) detail::record(name, category, begin, detail::now());
+        }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        const char* name;
+        const char* category;
+        bool active;
+        uint64_t begin;
+    };
+
+    // 各线程因环形缓冲区写满而被覆盖的事件总数
+    uint64_t droppedEvents();
+
+    // 以 Chrome Trace Event JSON 格式输出（可在 Perfetto / chrome://tracing 中打开）。
+    // 须在 stop() 之后、记录线程都已结束当前事件时调用（未 stop() 时抛出 std::logic_error）
+    void writeChromeTrace(std::ostream& out);
+    void saveChromeTrace(const std::string& path);
+
+} // namespace Trace
+} // namespace Utils
+
+#endif
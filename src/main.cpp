@@ -1,7 +1,27 @@
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <atomic>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <vector>
 #include "core/Vector3D.h"
 #include "physics/CelestialBody.h"
 #include "physics/PhysicsConstants.h"
+#include "physics/GravityEngine.h"
+#include "simulation/CalendarService.h"
+#include "simulation/Ephemeris.h"
+#include "simulation/Insolation.h"
+#include "simulation/Scenario.h"
+#include "simulation/StabilityMap.h"
+#include "simulation/AdaptiveStabilityMap.h"
+#include "utils/Instrumentation.h"
+#include "utils/ThreadPool.h"
+#include "utils/Trace.h"
 
 void testVector3D() {
     std::cout << "=== Vector3D Test ===" << std::endl;
@@ -33,7 +53,415 @@ void testPhysicsConstants() {
     std::cout << "1 AU = " << PhysicsConstants::AU << " m" << std::endl;
 }
 
-int main() {
+namespace {
+    using OptionHandlers = std::map<std::string, std::function<void(const std::string&)>>;
+
+    //  argv[first..] гɶԳֵ "--name value"δ֪ѡȱֵһѡûֵ
+    // ֵϷ׳ std::invalid_argumentʱӡԭ򲢷 false
+    bool parseOptions(int argc, char* argv[], int first, const OptionHandlers& handlers) {
+        for (int i = first; i < argc; i += 2) {
+            std::string option = argv[i];
+            auto handler = handlers.find(option);
+            if (handler == handlers.end()) {
+                std::cerr << "Unknown option: " << option << std::endl;
+                return false;
+            }
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << option << std::endl;
+                return false;
+            }
+            try {
+                handler->second(argv[i + 1]);
+            }
+            catch (const std::invalid_argument& e) {
+                std::cerr << e.what() << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // С minimum ʮatol  "abc"  "-1" ı 0 ޴
+    size_t parseCount(const std::string& option, const std::string& value, size_t minimum = 1) {
+        bool digits = !value.empty() && value.size() <= 18 &&
+            value.find_first_not_of("0123456789") == std::string::npos;
+        size_t count = digits ? static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10)) : 0;
+        if (!digits || count < minimum) {
+            throw std::invalid_argument(option + " needs an integer >= " + std::to_string(minimum) + ", got '" + value + "'");
+        }
+        return count;
+    }
+
+    // ޵ĸַ
+    double parseNumber(const std::string& option, const std::string& value) {
+        char* end = nullptr;
+        double number = std::strtod(value.c_str(), &end);
+        if (value.empty() || *end != '\0' || !std::isfinite(number)) {
+            throw std::invalid_argument(option + " needs a number, got '" + value + "'");
+        }
+        return number;
+    }
+}
+
+// ѯģʽ
+// ThreeBodyCalendar --serve <ephemeris> [--planet <name>] [--rotation-period <s>] [--threads <n>] [--cache <segments>]
+//                   [--sunrise-horizon <rotations>] [--metrics <file.json|file.prom>] [--trace <file.json>]
+int runServer(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --serve <ephemeris> [--planet <name>] [--rotation-period <s>]"
+            << " [--threads <n>] [--cache <segments>] [--sunrise-horizon <rotations>] [--metrics <file>] [--trace <file>]" << std::endl;
+        return 1;
+    }
+
+    std::string ephemerisPath = argv[2];
+    std::string planet;
+    Simulation::CalendarConfig config;
+    size_t threads = 0;
+    size_t cacheSegments = 4096;
+    double sunriseHorizon = 100.0;
+    std::string metricsPath;
+    std::string tracePath;
+
+    bool parsed = parseOptions(argc, argv, 3, {
+        { "--planet", [&](const std::string& v) { planet = v; } },
+        { "--rotation-period", [&](const std::string& v) { config.rotationPeriod = parseNumber("--rotation-period", v); } },
+        { "--threads", [&](const std::string& v) { threads = parseCount("--threads", v); } },
+        { "--cache", [&](const std::string& v) { cacheSegments = parseCount("--cache", v); } },
+        { "--sunrise-horizon", [&](const std::string& v) { sunriseHorizon = parseNumber("--sunrise-horizon", v); } },
+        { "--metrics", [&](const std::string& v) { metricsPath = v; } },
+        { "--trace", [&](const std::string& v) { tracePath = v; } },
+    });
+    if (!parsed) return 1;
+
+    try {
+        if (!planet.empty()) {
+            uint64_t offset = 0;
+            config.planetIndex = Simulation::Ephemeris::loadIndex(ephemerisPath, offset).findBody(planet);
+        }
+        if (!tracePath.empty()) {
+            Utils::Trace::setThreadName("main");
+            Utils::Trace::start();
+        }
+        Simulation::CalendarService service(ephemerisPath, config, cacheSegments);
+        service.setSunriseHorizon(sunriseHorizon);
+        service.serve(std::cin, std::cout, threads);
+        if (!tracePath.empty()) {
+            Utils::Trace::stop();
+            Utils::Trace::saveChromeTrace(tracePath);
+        }
+        if (!metricsPath.empty()) {
+            Utils::Instrumentation::saveSnapshot(metricsPath, Utils::Instrumentation::snapshot());
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Server failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// ģʽ
+// ThreeBodyCalendar --scenario <file.json|file.csv> [--threads <n>] [--summary <file.csv>]
+// ÿ̳߳϶Уܣʱ̡д stdout  --summary
+int runScenarios(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --scenario <file.json|file.csv> [--threads <n>] [--summary <file.csv>]" << std::endl;
+        return 1;
+    }
+
+    std::string scenarioPath = argv[2];
+    size_t threads = 0;
+    std::string summaryPath;
+    bool parsed = parseOptions(argc, argv, 3, {
+        { "--threads", [&](const std::string& v) { threads = parseCount("--threads", v); } },
+        { "--summary", [&](const std::string& v) { summaryPath = v; } },
+    });
+    if (!parsed) return 1;
+
+    std::vector<Simulation::Scenario> scenarios;
+    try {
+        scenarios = Simulation::ScenarioLoader::loadFile(scenarioPath);
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Cannot load scenarios: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::vector<Simulation::ScenarioResult> results(scenarios.size());
+    std::vector<std::string> errors(scenarios.size());
+    {
+        Utils::ThreadPool pool(threads);
+        pool.parallelFor(0, scenarios.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                try {
+                    results[i] = Simulation::runScenario(scenarios[i]);
+                }
+                catch (const std::exception& e) {
+                    errors[i] = e.what();
+                }
+            }
+        });
+    }
+
+    std::ofstream summaryFile;
+    if (!summaryPath.empty()) {
+        summaryFile.open(summaryPath);
+        if (!summaryFile) {
+            std::cerr << "Cannot open summary file: " << summaryPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& summary = summaryPath.empty() ? std::cout : summaryFile;
+    summary.precision(10);
+    summary << "scenario,bodies,steps,time,relative_energy_error\n";
+    int failed = 0;
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        if (!errors[i].empty()) {
+            std::cerr << "Scenario '" << scenarios[i].name << "' failed: " << errors[i] << std::endl;
+            ++failed;
+            continue;
+        }
+        summary << scenarios[i].name << ',' << scenarios[i].bodies.size() << ',' << results[i].steps << ','
+            << results[i].finalState.time << ',' << results[i].relativeEnergyError << '\n';
+    }
+    return failed == 0 ? 0 : 1;
+}
+
+// ģʽ
+// ThreeBodyCalendar --fit-ephemeris <scenario.json|scenario.csv> --output <ephemeris> [--name <scenario>] [--tolerance <m>]
+// Ļַʱ֣¼ÿܵģбѩ --serve / --insolation ʹá
+// ļжʱ --name ָݴ볡ڴģʽ²Ч
+int runFitEphemeris(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --fit-ephemeris <scenario.json|scenario.csv> --output <ephemeris>"
+            << " [--name <scenario>] [--tolerance <m>]" << std::endl;
+        return 1;
+    }
+
+    std::string scenarioPath = argv[2];
+    std::string outputPath;
+    std::string name;
+    Simulation::EphemerisFitOptions options;
+    bool parsed = parseOptions(argc, argv, 3, {
+        { "--output", [&](const std::string& v) { outputPath = v; } },
+        { "--name", [&](const std::string& v) { name = v; } },
+        { "--tolerance", [&](const std::string& v) { options.positionTolerance = parseNumber("--tolerance", v); } },
+    });
+    if (!parsed) return 1;
+    if (outputPath.empty()) {
+        std::cerr << "--output is required" << std::endl;
+        return 1;
+    }
+
+    try {
+        std::vector<Simulation::Scenario> scenarios = Simulation::ScenarioLoader::loadFile(scenarioPath);
+        const Simulation::Scenario* scenario = nullptr;
+        for (const Simulation::Scenario& candidate : scenarios) {
+            if (name.empty() ? scenarios.size() == 1 : candidate.name == name) scenario = &candidate;
+        }
+        if (scenario == nullptr) {
+            throw std::runtime_error(name.empty() ? "file holds several scenarios; choose one with --name"
+                : "no scenario named '" + name + "'");
+        }
+
+        Physics::SystemState state = scenario->initialState();
+        const std::vector<double> masses = scenario->masses();
+        Physics::DerivativeFunction derivFunc = [&masses](const Physics::SystemState& s, Physics::SystemState& d) {
+            Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        };
+        std::vector<Physics::SystemState> trajectory{ state };
+        Physics::StepCallback record = [&trajectory](const Physics::SystemState& s) { trajectory.push_back(s); };
+        if (scenario->adaptive) {
+            Physics::Integrator::integrateAdaptive(state, derivFunc, scenario->duration, scenario->tolerances, record);
+        } else {
+            Physics::Integrator integrator(scenario->method);
+            integrator.advance(state, derivFunc, scenario->duration, scenario->timeStep, record);
+        }
+
+        std::vector<std::string> names;
+        for (const Simulation::ScenarioBody& body : scenario->bodies) names.push_back(body.name);
+        Simulation::Ephemeris ephemeris = Simulation::Ephemeris::fit(trajectory, names, masses, options);
+        ephemeris.save(outputPath);
+        size_t segments = 0;
+        for (size_t i = 0; i < ephemeris.getBodyCount(); ++i) segments += ephemeris.getBody(i).segmentCount();
+        std::cout << "Fitted " << trajectory.size() << " states of '" << scenario->name << "' into "
+            << segments << " segments, written to " << outputPath << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Ephemeris fit failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// ʱģʽ
+// ThreeBodyCalendar --insolation <ephemeris> --output <file> [--planet <name>] [--start <s>] [--end <s>]
+//                   [--step <s>] [--format csv|binary] [--threads <n>]
+// ȡ״̶̬ǵľ롢ͨλͨδ --end ʱȡյ
+int runInsolation(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --insolation <ephemeris> --output <file> [--planet <name>] [--start <s>]"
+            << " [--end <s>] [--step <s>] [--format csv|binary] [--threads <n>]" << std::endl;
+        return 1;
+    }
+
+    std::string ephemerisPath = argv[2];
+    std::string outputPath;
+    std::string planet;
+    std::string format = "csv";
+    Simulation::InsolationOptions options;
+    bool hasStart = false, hasEnd = false;
+    size_t threads = 0;
+    bool parsed = parseOptions(argc, argv, 3, {
+        { "--output", [&](const std::string& v) { outputPath = v; } },
+        { "--planet", [&](const std::string& v) { planet = v; } },
+        { "--start", [&](const std::string& v) { options.startTime = parseNumber("--start", v); hasStart = true; } },
+        { "--end", [&](const std::string& v) { options.endTime = parseNumber("--end", v); hasEnd = true; } },
+        { "--step", [&](const std::string& v) { options.outputStep = parseNumber("--step", v); } },
+        { "--format", [&](const std::string& v) { format = v; } },
+        { "--threads", [&](const std::string& v) { threads = parseCount("--threads", v); } },
+    });
+    if (!parsed) return 1;
+    if (outputPath.empty() || (format != "csv" && format != "binary")) {
+        std::cerr << "--output is required and --format must be csv or binary" << std::endl;
+        return 1;
+    }
+
+    try {
+        Simulation::Ephemeris ephemeris = Simulation::Ephemeris::load(ephemerisPath);
+        std::vector<double> masses;
+        for (size_t i = 0; i < ephemeris.getBodyCount(); ++i) masses.push_back(ephemeris.getBody(i).mass);
+        if (!hasStart) options.startTime = ephemeris.getStartTime();
+        if (!hasEnd) options.endTime = ephemeris.getEndTime();
+
+        Simulation::CalendarConfig config;
+        if (!planet.empty()) config.planetIndex = ephemeris.findBody(planet);
+        Simulation::InsolationTimeline timeline(config, masses, options,
+            [&ephemeris](double t, Physics::SystemState& state) { ephemeris.evaluateAll(t, state); });
+
+        std::vector<std::string> sunNames;
+        for (size_t sun : timeline.getConfig().sunIndices) sunNames.push_back(ephemeris.getBody(sun).name);
+        Simulation::InsolationFormat kind = format == "csv" ? Simulation::InsolationFormat::CSV : Simulation::InsolationFormat::BINARY;
+        std::ofstream out(outputPath, kind == Simulation::InsolationFormat::CSV ? std::ios::out : std::ios::out | std::ios::binary);
+        if (!out) throw std::runtime_error("Cannot open output file: " + outputPath);
+
+        Simulation::InsolationWriter writer(out, kind, sunNames);
+        Utils::ThreadPool pool(threads);
+        timeline.generate([&writer](const Simulation::InsolationChunk& chunk) { writer(chunk); }, &pool);
+        std::cout << "Wrote " << writer.getRowsWritten() << " samples to " << outputPath << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Insolation failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+namespace {
+    std::atomic<bool> stabilityStop(false);
+    void requestStabilityStop(int) { stabilityStop = true; }
+}
+
+// ȶͼģʽ
+// ThreeBodyCalendar --stability-map <config.json> --output <raster> [--image <file.pgm>] [--threads <n>]
+//                   [--adaptive <levels>] [--budget <simulations>]
+// դļѴʱжϴ㣻Ctrl+C ڼƬд˳ٴͬһɼ
+//  --adaptive ʱΪɴֵϸĲϸ--output ΪҶб (CSV)֧
+int runStabilityMap(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " --stability-map <config.json> --output <raster|leaves.csv>"
+            << " [--image <file.pgm>] [--threads <n>] [--adaptive <levels>] [--budget <simulations>]" << std::endl;
+        return 1;
+    }
+
+    std::string configPath = argv[2];
+    std::string outputPath;
+    std::string imagePath;
+    size_t threads = 0;
+    bool adaptive = false;
+    Simulation::AdaptiveMapOptions adaptiveOptions;
+    bool parsed = parseOptions(argc, argv, 3, {
+        { "--output", [&](const std::string& v) { outputPath = v; } },
+        { "--image", [&](const std::string& v) { imagePath = v; } },
+        { "--threads", [&](const std::string& v) { threads = parseCount("--threads", v); } },
+        { "--adaptive", [&](const std::string& v) {
+            adaptiveOptions.levels = static_cast<uint32_t>(parseCount("--adaptive", v, 0));
+            adaptive = true;
+        } },
+        { "--budget", [&](const std::string& v) { adaptiveOptions.maxSimulations = parseCount("--budget", v); } },
+    });
+    if (!parsed) return 1;
+    if (outputPath.empty()) {
+        std::cerr << "--output is required" << std::endl;
+        return 1;
+    }
+
+    try {
+        Simulation::StabilityMapConfig config = Simulation::StabilityMapConfig::loadFile(configPath);
+        if (adaptive) {
+            Utils::ThreadPool pool(threads);
+            adaptiveOptions.pool = &pool;
+            Simulation::AdaptiveStabilityMap map(config, adaptiveOptions);
+            map.run();
+            std::ofstream leaves(outputPath);
+            if (!leaves) throw std::runtime_error("Cannot open output file: " + outputPath);
+            map.writeLeaves(leaves);
+            if (!imagePath.empty()) map.writeImage(imagePath);
+            std::cout << "Adaptive stability map " << map.getWidth() << "x" << map.getHeight() << ": "
+                << map.getSimulations() << " simulations in " << map.getRounds() << " refinement rounds" << std::endl;
+            return 0;
+        }
+
+        Simulation::StabilityRaster raster(outputPath, config);
+        if (raster.tilesDone() > 0) {
+            std::cerr << "Resuming " << outputPath << ": " << raster.tilesDone() << "/" << raster.tileCount()
+                << " tiles already done" << std::endl;
+        }
+
+        std::signal(SIGINT, requestStabilityStop);
+        Utils::ThreadPool pool(threads);
+        Simulation::StabilityRunOptions options;
+        options.pool = &pool;
+        options.stop = &stabilityStop;
+        options.onTile = [](size_t, size_t done, size_t total) {
+            std::cerr << "\rTiles " << done << "/" << total << std::flush;
+        };
+        Simulation::runStabilityMap(config, raster, options);
+        std::cerr << std::endl;
+        std::signal(SIGINT, SIG_DFL);
+
+        if (!imagePath.empty()) raster.writeImage(imagePath, config.system.duration, config.system.timeStep);
+        if (raster.tilesDone() < raster.tileCount()) {
+            std::cout << "Interrupted with " << raster.tilesDone() << "/" << raster.tileCount()
+                << " tiles done; run again to resume" << std::endl;
+            return 2;
+        }
+        std::cout << "Stability map " << raster.getWidth() << "x" << raster.getHeight() << " written to " << outputPath << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "Stability map failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--serve") {
+        return runServer(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--scenario") {
+        return runScenarios(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--fit-ephemeris") {
+        return runFitEphemeris(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--insolation") {
+        return runInsolation(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--stability-map") {
+        return runStabilityMap(argc, argv);
+    }
+
     std::cout << "Basic tests" << std::endl;
     std::cout << "=========================" << std::endl;
 
@@ -0,0 +1,129 @@
+﻿#include "physics/ChaosIndicator.h"
+#include "physics/GravityEngine.h"
+#include "physics/PhysicsConstants.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace Physics {
+
+    namespace {
+        // 切向量范数超出此范围时重新归一化，避免上溢或下溢（变分方程是线性的，缩放不影响结果）
+        const double RENORMALIZE_ABOVE = 1e8;
+        const double RENORMALIZE_BELOW = 1e-8;
+    }
+
+    ChaosIndicator::ChaosIndicator(const SystemState& initial,
+        const std::vector<double>& masses,
+        Integrator::Method method,
+        uint64_t seed)
+        : masses(masses), integrator(method) {
+        const size_t n = masses.size();
+        if (initial.positions.size() != n || initial.velocities.size() != n) {
+            throw std::invalid_argument("ChaosIndicator state does not match mass count");
+        }
+        // 动力学时间 τ = sqrt(L^3 / (G M))，L 为到质心的均方根距离
+        double totalMass = 0.0;
+        Vector3D centre = Vector3D::zero();
+        for (size_t i = 0; i < n; ++i) {
+            totalMass += masses[i];
+            centre.addScaled(initial.positions[i], masses[i]);
+        }
+        if (totalMass > 0.0) centre = centre / totalMass;
+        double spread = 0.0;
+        for (size_t i = 0; i < n; ++i) spread += (initial.positions[i] - centre).magnitudeSquared();
+        double length = n > 0 ? std::sqrt(spread / static_cast<double>(n)) : 0.0;
+        if (length > 0.0 && totalMass > 0.0) {
+            timeScale = std::sqrt(length * length * length / (PhysicsConstants::G * totalMass));
+        }
+
+        augmented = SystemState(2 * n);
+        augmented.time = initial.time;
+        startTime = initial.time;
+        uint64_t state = seed;
+        auto next = [&state]() {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            return static_cast<double>(state >> 11) / 9007199254740992.0 - 0.5;
+        };
+        for (size_t i = 0; i < n; ++i) {
+            augmented.positions[i] = initial.positions[i];
+            augmented.velocities[i] = initial.velocities[i];
+            augmented.positions[n + i] = Vector3D(next(), next(), next());
+            augmented.velocities[n + i] = Vector3D(next(), next(), next()) / timeScale;
+        }
+        double norm = tangentNorm();
+        if (norm > 0.0) rescaleTangent(1.0 / norm);
+    }
+
+    double ChaosIndicator::tangentNorm() const {
+        const size_t n = masses.size();
+        const double tau2 = timeScale * timeScale;
+        double sum = 0.0;
+        for (size_t i = n; i < 2 * n; ++i) {
+            sum += augmented.positions[i].magnitudeSquared() + tau2 * augmented.velocities[i].magnitudeSquared();
+        }
+        return std::sqrt(sum);
+    }
+
+    void ChaosIndicator::rescaleTangent(double factor) {
+        const size_t n = masses.size();
+        for (size_t i = n; i < 2 * n; ++i) {
+            augmented.positions[i] *= factor;
+            augmented.velocities[i] *= factor;
+        }
+        // Verlet 的上一步位置同样要缩放，否则下一步会把缩放当成位移
+        IntegratorState saved = integrator.captureState();
+        if (saved.previousPositions.size() == 2 * n) {
+            for (size_t i = n; i < 2 * n; ++i) saved.previousPositions[i] *= factor;
+            integrator.restoreState(saved);
+        }
+    }
+
+    void ChaosIndicator::step(double dt) {
+        const double before = elapsed();
+        const std::vector<double>& m = masses;
+        integrator.step(augmented, [&m](const SystemState& s, SystemState& d) {
+            GravityEngine::calculateVariationalDerivatives(s, d, m);
+        }, dt);
+        augmented.time += dt;
+
+        // 本步内 ln|δ| 的增量，按步中点时刻加权即为 ∫ s d ln|δ| 的中点求积
+        double norm = tangentNorm();
+        double growth = std::log(norm / currentNorm);
+        logGrowth += growth;
+        weightedGrowth += (before + 0.5 * dt) * growth;
+
+        double previous = instant;
+        instant = 2.0 * weightedGrowth / elapsed();
+        megnoIntegral += 0.5 * (previous + instant) * dt;
+
+        currentNorm = norm;
+        if (norm > RENORMALIZE_ABOVE || norm < RENORMALIZE_BELOW) {
+            rescaleTangent(1.0 / norm);
+            currentNorm = 1.0;
+        }
+    }
+
+    void ChaosIndicator::advance(double totalTime, double timeStep, const StepCallback& onStep) {
+        int steps = static_cast<int>(totalTime / timeStep);
+        SystemState physical;
+        for (int i = 0; i < steps; ++i) {
+            step(timeStep);
+            if (onStep) {
+                physical = getState();
+                onStep(physical);
+            }
+        }
+    }
+
+    SystemState ChaosIndicator::getState() const {
+        const size_t n = masses.size();
+        SystemState state(n);
+        for (size_t i = 0; i < n; ++i) {
+            state.positions[i] = augmented.positions[i];
+            state.velocities[i] = augmented.velocities[i];
+        }
+        state.time = augmented.time;
+        return state;
+    }
+
+} // namespace Physics
@@ -0,0 +1,161 @@
+﻿#include "physics/CollisionDetector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Physics {
+
+    namespace {
+        // 覆盖格子数超过此值的天体按“大天体”单独处理
+        const int64_t MAX_CELLS_PER_BODY = 64;
+        // 网格坐标的上限，超出时同样按大天体处理，避免整数溢出
+        const double MAX_CELL_COORDINATE = 1e15;
+    }
+
+    double CollisionDetector::contactFraction(const Vector3D& a0, const Vector3D& a1,
+        const Vector3D& b0, const Vector3D& b1, double radiusSum) {
+        Vector3D d0 = b0 - a0;
+        double c = d0.magnitudeSquared() - radiusSum * radiusSum;
+        if (c <= 0.0) return 0.0;  // 起点已重叠
+
+        Vector3D dd = (b1 - b0) - (a1 - a0);
+        double a = dd.magnitudeSquared();
+        if (a == 0.0) return -1.0;
+        double b = 2.0 * d0.dot(dd);
+        double disc = b * b - 4.0 * a * c;
+        if (disc < 0.0 || b >= 0.0) return -1.0;  // 不相交，或正在远离
+        double t = (-b - std::sqrt(disc)) / (2.0 * a);
+        return t <= 1.0 ? t : -1.0;
+    }
+
+    void CollisionDetector::testPair(size_t i, size_t j, const std::vector<Vector3D>& previous,
+        const std::vector<Vector3D>& current, const std::vector<double>& radii) {
+        const std::vector<Vector3D>& start = previous.empty() ? current : previous;
+        double f = contactFraction(start[i], current[i], start[j], current[j], radii[i] + radii[j]);
+        if (f >= 0.0) pairs.push_back(CollisionPair{ std::min(i, j), std::max(i, j), f });
+    }
+
+    const std::vector<CollisionPair>& CollisionDetector::detect(const std::vector<Vector3D>& previous,
+        const std::vector<Vector3D>& current,
+        const std::vector<double>& radii) {
+        const size_t n = current.size();
+        const std::vector<Vector3D>& start = previous.empty() ? current : previous;
+        pairs.clear();
+        entries.clear();
+        large.clear();
+        if (n < 2) return pairs;
+
+        // 扫掠体包围盒的半边长，取中位数确定格子大小
+        scratch.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            Vector3D span = current[k] - start[k];
+            double extent = std::max(std::fabs(span.x), std::max(std::fabs(span.y), std::fabs(span.z))) * 0.5 + radii[k];
+            scratch[k] = extent;
+        }
+        std::nth_element(scratch.begin(), scratch.begin() + n / 2, scratch.end());
+        double cell = 2.0 * scratch[n / 2];
+        if (!(cell > 0.0)) {
+            cell = 2.0 * *std::max_element(scratch.begin(), scratch.end());
+            if (!(cell > 0.0)) return pairs;  // 全部是静止的质点
+        }
+        const double inverseCell = 1.0 / cell;
+
+        bounds.resize(n);
+        for (size_t k = 0; k < n; ++k) {
+            const double lo[3] = {
+                std::min(start[k].x, current[k].x) - radii[k],
+                std::min(start[k].y, current[k].y) - radii[k],
+                std::min(start[k].z, current[k].z) - radii[k] };
+            const double hi[3] = {
+                std::max(start[k].x, current[k].x) + radii[k],
+                std::max(start[k].y, current[k].y) + radii[k],
+                std::max(start[k].z, current[k].z) + radii[k] };
+
+            bool tooLarge = false;
+            int64_t cells = 1;
+            for (int a = 0; a < 3; ++a) {
+                double l = std::floor(lo[a] * inverseCell), h = std::floor(hi[a] * inverseCell);
+                if (!(std::fabs(l) < MAX_CELL_COORDINATE && std::fabs(h) < MAX_CELL_COORDINATE)) {
+                    tooLarge = true;
+                    break;
+                }
+                bounds[k].lo[a] = static_cast<int64_t>(l);
+                bounds[k].hi[a] = static_cast<int64_t>(h);
+                cells *= bounds[k].hi[a] - bounds[k].lo[a] + 1;
+                if (cells > MAX_CELLS_PER_BODY) {
+                    tooLarge = true;
+                    break;
+                }
+            }
+            if (tooLarge) {
+                large.push_back(k);
+                continue;
+            }
+
+            const Bounds& b = bounds[k];
+            for (int64_t x = b.lo[0]; x <= b.hi[0]; ++x)
+                for (int64_t y = b.lo[1]; y <= b.hi[1]; ++y)
+                    for (int64_t z = b.lo[2]; z <= b.hi[2]; ++z)
+                        entries.push_back(CellEntry{ x, y, z, k });
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const CellEntry& a, const CellEntry& b) {
+            if (a.x != b.x) return a.x < b.x;
+            if (a.y != b.y) return a.y < b.y;
+            if (a.z != b.z) return a.z < b.z;
+            return a.body < b.body;
+        });
+
+        for (size_t begin = 0; begin < entries.size();) {
+            size_t end = begin + 1;
+            while (end < entries.size() && entries[end].x == entries[begin].x &&
+                entries[end].y == entries[begin].y && entries[end].z == entries[begin].z) {
+                ++end;
+            }
+            const int64_t cellCoord[3] = { entries[begin].x, entries[begin].y, entries[begin].z };
+            for (size_t p = begin; p < end; ++p) {
+                for (size_t q = p + 1; q < end; ++q) {
+                    const Bounds& bi = bounds[entries[p].body];
+                    const Bounds& bj = bounds[entries[q].body];
+                    // 两个包围盒共享多个格子时，只在公共区域的最小格子里检验一次
+                    bool first = true;
+                    for (int a = 0; a < 3 && first; ++a) {
+                        first = std::max(bi.lo[a], bj.lo[a]) == cellCoord[a];
+                    }
+                    if (first) testPair(entries[p].body, entries[q].body, previous, current, radii);
+                }
+            }
+            begin = end;
+        }
+
+        // 大天体与其余所有天体逐一检验（大天体之间只检验一次）
+        for (size_t a = 0; a < large.size(); ++a) {
+            size_t L = large[a];
+            for (size_t k = 0; k < n; ++k) {
+                if (k == L) continue;
+                bool kLarge = std::binary_search(large.begin(), large.end(), k);
+                if (kLarge && k < L) continue;
+                testPair(L, k, previous, current, radii);
+            }
+        }
+
+        std::sort(pairs.begin(), pairs.end(), [](const CollisionPair& a, const CollisionPair& b) {
+            return a.i != b.i ? a.i < b.i : a.j < b.j;
+        });
+        return pairs;
+    }
+
+    std::vector<CollisionPair> CollisionDetector::detectBruteForce(const std::vector<Vector3D>& previous,
+        const std::vector<Vector3D>& current,
+        const std::vector<double>& radii) {
+        const std::vector<Vector3D>& start = previous.empty() ? current : previous;
+        std::vector<CollisionPair> result;
+        for (size_t i = 0; i < current.size(); ++i) {
+            for (size_t j = i + 1; j < current.size(); ++j) {
+                double f = contactFraction(start[i], current[i], start[j], current[j], radii[i] + radii[j]);
+                if (f >= 0.0) result.push_back(CollisionPair{ i, j, f });
+            }
+        }
+        return result;
+    }
+
+} // namespace Physics
@@ -0,0 +1,95 @@
+#include "physics/ConservationMonitor.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace Physics {
+
+    namespace {
+        bool sameState(const SystemState& a, const SystemState& b) {
+            if (a.time != b.time || a.positions.size() != b.positions.size()) return false;
+            for (size_t i = 0; i < a.positions.size(); ++i) {
+                const Vector3D& p = a.positions[i];
+                const Vector3D& q = b.positions[i];
+                const Vector3D& u = a.velocities[i];
+                const Vector3D& v = b.velocities[i];
+                if (p.x != q.x || p.y != q.y || p.z != q.z || u.x != v.x || u.y != v.y || u.z != v.z) return false;
+            }
+            return true;
+        }
+    }
+
+    ConservationMonitor::ConservationMonitor(const std::vector<double>& masses, std::ostream* out, size_t interval)
+        : masses(masses), out(out), interval(interval) {
+        if (interval == 0) {
+            throw std::invalid_argument("ConservationMonitor interval must be positive");
+        }
+        if (out) {
+            *out << "time,kinetic,potential,energy,energy_error,momentum_drift,virial_ratio\n";
+        }
+    }
+
+    DerivativeFunction ConservationMonitor::derivative() {
+        return [this](const SystemState& state, SystemState& derivatives) {
+            ForceDiagnostics diagnostics;
+            GravityEngine::calculateGravitationalDerivatives(state, derivatives, masses, diagnostics);
+            if (!armed) return;
+            armed = false;
+            if (!hasPending || sameState(state, pending)) record(state.time, diagnostics, state);
+            else sample(pending);
+        };
+    }
+
+    StepCallback ConservationMonitor::stepCallback() {
+        return [this](const SystemState& state) {
+            if (++stepsSinceSample >= interval) {
+                stepsSinceSample = 0;
+                if (armed && hasPending) sample(pending);
+                pending = state;
+                hasPending = true;
+                armed = true;
+            }
+        };
+    }
+
+    const ConservationSample& ConservationMonitor::sample(const SystemState& state) {
+        // 积分结束时对末状态采样：它就是最后记下的已接受状态，不再重复
+        if (armed && hasPending && sameState(state, pending)) armed = false;
+        if (scratch.positions.size() != state.positions.size()) {
+            scratch = SystemState(state.positions.size());
+        }
+        ForceDiagnostics diagnostics;
+        GravityEngine::calculateGravitationalDerivatives(state, scratch, masses, diagnostics);
+        record(state.time, diagnostics, state);
+        return last;
+    }
+
+    void ConservationMonitor::record(double time, const ForceDiagnostics& diagnostics, const SystemState& state) {
+        if (!referenceSet) {
+            referenceSet = true;
+            referenceEnergy = diagnostics.totalEnergy();
+            referenceMomentum = diagnostics.momentum;
+            momentumScale = 0.0;
+            for (size_t i = 0; i < state.velocities.size(); ++i) {
+                momentumScale += masses[i] * state.velocities[i].magnitude();
+            }
+        }
+
+        last.time = time;
+        last.diagnostics = diagnostics;
+        last.energyError = referenceEnergy != 0.0
+            ? std::fabs((diagnostics.totalEnergy() - referenceEnergy) / referenceEnergy)
+            : std::fabs(diagnostics.totalEnergy());
+        double drift = (diagnostics.momentum - referenceMomentum).magnitude();
+        last.momentumDrift = momentumScale > 0.0 ? drift / momentumScale : drift;
+
+        if (last.energyError > maxEnergyError) maxEnergyError = last.energyError;
+        ++sampleCount;
+
+        if (out) {
+            *out << time << ',' << diagnostics.kineticEnergy << ',' << diagnostics.potentialEnergy << ','
+                 << diagnostics.totalEnergy() << ',' << last.energyError << ',' << last.momentumDrift << ','
+                 << diagnostics.virialRatio() << '\n';
+        }
+    }
+
+} // namespace Physics
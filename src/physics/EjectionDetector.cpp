@@ -0,0 +1,289 @@
+﻿#include "physics/EjectionDetector.h"
+#include "physics/GravityEngine.h"
+#include "physics/PhysicsConstants.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Physics {
+
+    namespace {
+        const double PI = 3.14159265358979323846;
+
+        // Stumpff 函数 C(z) 与 S(z)；|z| 较小时用级数避免相消
+        void stumpff(double z, double& c, double& s) {
+            if (std::fabs(z) < 1e-2) {
+                c = 1.0 / 2.0 - z * (1.0 / 24.0 - z * (1.0 / 720.0 - z * (1.0 / 40320.0 - z / 3628800.0)));
+                s = 1.0 / 6.0 - z * (1.0 / 120.0 - z * (1.0 / 5040.0 - z * (1.0 / 362880.0 - z / 39916800.0)));
+            } else if (z > 0.0) {
+                double q = std::sqrt(z);
+                c = (1.0 - std::cos(q)) / z;
+                s = (q - std::sin(q)) / (z * q);
+            } else {
+                double q = std::sqrt(-z);
+                c = (std::cosh(q) - 1.0) / -z;
+                s = (std::sinh(q) - q) / (-z * q);
+            }
+        }
+    }
+
+    void propagateKepler(Vector3D& position, Vector3D& velocity, double mu, double dt) {
+        if (dt == 0.0) return;
+        if (!(mu > 0.0)) {
+            position.addScaled(velocity, dt);
+            return;
+        }
+        const double sqrtMu = std::sqrt(mu);
+        const double r0 = position.magnitude();
+        const double sigma0 = position.dot(velocity) / sqrtMu;
+        const double alpha = 2.0 / r0 - velocity.magnitudeSquared() / mu;   // 1/a
+
+        // 椭圆轨道先扣掉整周期，普适变量保持在一圈之内
+        if (alpha > 0.0) {
+            double period = 2.0 * PI / (sqrtMu * alpha * std::sqrt(alpha));
+            dt = std::fmod(dt, period);
+            if (dt == 0.0) return;
+        }
+
+        // 初值：椭圆按平均运动，双曲按 Vallado 的对数估计
+        double chi;
+        if (alpha > 1e-12 / r0) {
+            chi = sqrtMu * dt * alpha;
+        } else if (alpha < -1e-12 / r0) {
+            double a = 1.0 / alpha;
+            double sign = dt > 0.0 ? 1.0 : -1.0;
+            double arg = (-2.0 * mu * alpha * dt) /
+                (position.dot(velocity) + sign * std::sqrt(-mu * a) * (1.0 - r0 * alpha));
+            chi = sign * std::sqrt(-a) * std::log(std::max(arg, 1e-300));
+            if (!std::isfinite(chi)) chi = sqrtMu * dt / r0;
+        } else {
+            chi = sqrtMu * dt / r0;
+        }
+
+        // Laguerre-Conway 迭代（n = 5），对普适 Kepler 方程全局收敛
+        double c = 0.5, s = 1.0 / 6.0, z = 0.0;
+        for (int iteration = 0; iteration < 64; ++iteration) {
+            z = alpha * chi * chi;
+            stumpff(z, c, s);
+            double chi2 = chi * chi;
+            double f = sigma0 * chi2 * c + (1.0 - alpha * r0) * chi2 * chi * s + r0 * chi - sqrtMu * dt;
+            double df = sigma0 * chi * (1.0 - z * s) + (1.0 - alpha * r0) * chi2 * c + r0;
+            double ddf = sigma0 * (1.0 - z * c) + (1.0 - alpha * r0) * chi * (1.0 - z * s);
+            const double n = 5.0;
+            double root = std::sqrt(std::fabs((n - 1.0) * (n - 1.0) * df * df - n * (n - 1.0) * f * ddf));
+            double delta = n * f / (df + (df >= 0.0 ? root : -root));
+            chi -= delta;
+            if (std::fabs(delta) <= 1e-14 * std::max(1.0, std::fabs(chi))) break;
+        }
+        z = alpha * chi * chi;
+        stumpff(z, c, s);
+
+        // Lagrange 系数
+        const double chi2 = chi * chi;
+        const double f = 1.0 - chi2 / r0 * c;
+        const double g = dt - chi2 * chi / sqrtMu * s;
+        Vector3D r = position * f + velocity * g;
+        const double radius = r.magnitude();
+        const double fdot = sqrtMu / (radius * r0) * (z * s - 1.0) * chi;
+        const double gdot = 1.0 - chi2 / radius * c;
+        velocity = position * fdot + velocity * gdot;
+        position = r;
+    }
+
+    EjectionDetector::EjectionDetector(const std::vector<double>& masses, const EjectionCriteria& criteria)
+        : masses(masses), criteria(criteria) {
+        if (!(criteria.distanceFactor >= 1.0)) throw std::invalid_argument("Ejection distance factor must be at least 1");
+    }
+
+    bool EjectionDetector::check(const SystemState& state, EjectionEvent& event) const {
+        return check(state.positions.data(), state.velocities.data(), state.time, event);
+    }
+
+    bool EjectionDetector::check(const Vector3D* positions, const Vector3D* velocities, double time,
+        EjectionEvent& event) const {
+        using PhysicsConstants::G;
+        const size_t n = masses.size();
+        if (n < 2) return false;
+
+        double total = 0.0;
+        Vector3D moment = Vector3D::zero(), momentum = Vector3D::zero();
+        for (size_t i = 0; i < n; ++i) {
+            total += masses[i];
+            moment.addScaled(positions[i], masses[i]);
+            momentum.addScaled(velocities[i], masses[i]);
+        }
+
+        const double factor2 = criteria.distanceFactor * criteria.distanceFactor;
+        for (size_t k = 0; k < n; ++k) {
+            // 其余天体的质心由总量扣除 k 得到，每个候选 O(1)
+            const double rest = total - masses[k];
+            if (!(rest > 0.0)) continue;
+            const Vector3D centre = Vector3D::axpy(moment, positions[k], -masses[k]) / rest;
+            const Vector3D drift = Vector3D::axpy(momentum, velocities[k], -masses[k]) / rest;
+            const Vector3D d = positions[k] - centre;
+            const Vector3D u = velocities[k] - drift;
+            if (d.dot(u) <= 0.0) continue;
+            const double distance2 = d.magnitudeSquared();
+            const double distance = std::sqrt(distance2);
+            if (distance < criteria.minDistance) continue;
+            const double energy = 0.5 * u.magnitudeSquared() - G * total / distance;
+            if (energy <= 0.0) continue;
+
+            // 层级：其余天体须远小于 k 的距离，单极近似才成立
+            double size2 = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                if (i != k) size2 = std::max(size2, (positions[i] - centre).magnitudeSquared());
+            }
+            if (distance2 < factor2 * size2) continue;
+
+            // 成对能量：k 不能与其余任何一个天体束缚
+            bool paired = false;
+            for (size_t i = 0; i < n && !paired; ++i) {
+                if (i == k) continue;
+                Vector3D dr = positions[k] - positions[i];
+                Vector3D dv = velocities[k] - velocities[i];
+                paired = 0.5 * dv.magnitudeSquared() < G * (masses[k] + masses[i]) / dr.magnitude();
+            }
+            if (paired) continue;
+
+            // 其余天体在其质心系中的内能
+            double remainder = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                if (i == k) continue;
+                remainder += 0.5 * masses[i] * (velocities[i] - drift).magnitudeSquared();
+                for (size_t j = i + 1; j < n; ++j) {
+                    if (j != k) remainder -= G * masses[i] * masses[j] / (positions[i] - positions[j]).magnitude();
+                }
+            }
+
+            event.body = k;
+            event.time = time;
+            event.distance = distance;
+            event.specificEnergy = energy;
+            event.remainderEnergy = remainder;
+            event.remainderBound = n == 2 || remainder < 0.0;
+            return true;
+        }
+        return false;
+    }
+
+    EscapePropagator::EscapePropagator(const SystemState& initial,
+        const std::vector<double>& masses,
+        Integrator::Method method,
+        const EjectionCriteria& criteria)
+        : masses(masses), activeMasses(masses), activeState(initial), integrator(method),
+          criteria(criteria), detector(masses, criteria), time(initial.time) {
+        if (initial.positions.size() != masses.size() || initial.velocities.size() != masses.size()) {
+            throw std::invalid_argument("EscapePropagator state and mass counts differ");
+        }
+        for (size_t i = 0; i < masses.size(); ++i) active.push_back(i);
+        if (active.size() <= 2) finishAnalytic();
+    }
+
+    void EscapePropagator::finishAnalytic() {
+        frozenTime = time;
+        // 较轻者作为 escaper，其余部分的质量不为零
+        if (active.size() == 2) separate(activeMasses[0] >= activeMasses[1] ? 1 : 0);
+        analytic = true;
+    }
+
+    void EscapePropagator::separate(size_t local) {
+        Separation s;
+        s.group = active;
+        s.escaper = active[local];
+        s.epoch = time;
+
+        double total = 0.0;
+        Vector3D centre = Vector3D::zero(), drift = Vector3D::zero();
+        for (size_t i = 0; i < active.size(); ++i) {
+            total += activeMasses[i];
+            centre.addScaled(activeState.positions[i], activeMasses[i]);
+            drift.addScaled(activeState.velocities[i], activeMasses[i]);
+        }
+        const double m = activeMasses[local];
+        const double rest = total - m;
+        s.mu = PhysicsConstants::G * total;
+        s.escaperFraction = total > 0.0 ? m / total : 0.0;
+        s.centre = centre / total;
+        s.centreVelocity = drift / total;
+        s.relative = activeState.positions[local] - Vector3D::axpy(centre, activeState.positions[local], -m) / rest;
+        s.relativeVelocity = activeState.velocities[local] - Vector3D::axpy(drift, activeState.velocities[local], -m) / rest;
+        separations.push_back(s);
+
+        active.erase(active.begin() + static_cast<std::ptrdiff_t>(local));
+        activeMasses.erase(activeMasses.begin() + static_cast<std::ptrdiff_t>(local));
+        activeState.positions.erase(activeState.positions.begin() + static_cast<std::ptrdiff_t>(local));
+        activeState.velocities.erase(activeState.velocities.begin() + static_cast<std::ptrdiff_t>(local));
+        integrator.reset();
+        detector = EjectionDetector(activeMasses, criteria);
+    }
+
+    bool EscapePropagator::step(double dt) {
+        if (!analytic) {
+            const std::vector<double>& m = activeMasses;
+            DerivativeFunction f = [&m](const SystemState& s, SystemState& d) {
+                GravityEngine::calculateGravitationalDerivatives(s, d, m);
+            };
+            integrator.step(activeState, f, dt);
+        }
+        time += dt;
+        if (analytic) return false;
+        activeState.time = time;
+        if (++steps % std::max<size_t>(criteria.checkInterval, 1) != 0) return false;
+
+        EjectionEvent event;
+        if (!detector.check(activeState, event)) return false;
+        const size_t local = event.body;
+        event.body = active[local];
+        events.push_back(event);
+        separate(local);
+        // 剩下的两个天体是孤立二体问题，同样改为解析
+        if (active.size() <= 2) finishAnalytic();
+        return true;
+    }
+
+    bool EscapePropagator::isEscaped(size_t body) const {
+        return std::any_of(events.begin(), events.end(), [body](const EjectionEvent& e) { return e.body == body; });
+    }
+
+    SystemState EscapePropagator::getState() const {
+        SystemState state(masses.size());
+        state.time = time;
+        // 最内层：仍在积分的天体；已全部解析时只剩一个天体，它的位置由外层的质心约束决定
+        for (size_t i = 0; i < active.size(); ++i) {
+            state.positions[active[i]] = activeState.positions[i];
+            state.velocities[active[i]] = activeState.velocities[i];
+            if (analytic) state.positions[active[i]].addScaled(activeState.velocities[i], time - frozenTime);
+        }
+
+        // 由内向外：每次分离把其余天体整体平移到二体解给出的质心上，再放回逃逸天体
+        for (auto s = separations.rbegin(); s != separations.rend(); ++s) {
+            const double dt = time - s->epoch;
+            Vector3D r = s->relative, v = s->relativeVelocity;
+            propagateKepler(r, v, s->mu, dt);
+            const Vector3D centre = Vector3D::axpy(s->centre, s->centreVelocity, dt);
+            const Vector3D restCentre = Vector3D::axpy(centre, r, -s->escaperFraction);
+            const Vector3D restDrift = Vector3D::axpy(s->centreVelocity, v, -s->escaperFraction);
+
+            double rest = 0.0;
+            Vector3D current = Vector3D::zero(), currentDrift = Vector3D::zero();
+            for (size_t body : s->group) {
+                if (body == s->escaper) continue;
+                rest += masses[body];
+                current.addScaled(state.positions[body], masses[body]);
+                currentDrift.addScaled(state.velocities[body], masses[body]);
+            }
+            const Vector3D shift = restCentre - current / rest;
+            const Vector3D shiftVelocity = restDrift - currentDrift / rest;
+            for (size_t body : s->group) {
+                if (body == s->escaper) continue;
+                state.positions[body] += shift;
+                state.velocities[body] += shiftVelocity;
+            }
+            state.positions[s->escaper] = Vector3D::axpy(centre, r, 1.0 - s->escaperFraction);
+            state.velocities[s->escaper] = Vector3D::axpy(s->centreVelocity, v, 1.0 - s->escaperFraction);
+        }
+        return state;
+    }
+
+} // namespace Physics
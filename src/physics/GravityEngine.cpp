@@ -1,21 +1,148 @@
 #include "physics/GravityEngine.h"
+#include "utils/Instrumentation.h"
+#include "utils/Trace.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
 namespace Physics {
 
+    namespace {
+
+        //  mode ָۼ body(accumulator)
+        template <typename Body>
+        auto withAccumulator(Utils::SummationMode mode, Body&& body) {
+            switch (mode) {
+            case Utils::SummationMode::KAHAN:
+                return body(Utils::KahanSum());
+            case Utils::SummationMode::PAIRWISE:
+                return body(Utils::PairwiseSum());
+            default:
+                return body(Utils::NaiveSum());
+            }
+        }
+
+        // ֿԼ黮ֻȡ n ԣɸģʽ߳޹أù̶״ĹԼϲ
+        template <typename T, typename BlockFn>
+        T reduceBlocks(size_t n, const ExecutionPolicy& policy, BlockFn blockFn) {
+            if (n == 0) return T();
+
+            size_t blockSize = std::max<size_t>(policy.blockSize, 1);
+            size_t blocks = 1;
+            if (policy.reproducible) {
+                blocks = (n + blockSize - 1) / blockSize;
+            } else if (policy.pool != nullptr) {
+                blocks = std::min(n, policy.pool->size());
+            }
+
+            auto boundary = [&](size_t b) {
+                return policy.reproducible ? std::min(n, b * blockSize) : b * n / blocks;
+            };
+
+            std::vector<T> partials(blocks);
+            auto run = [&](size_t first, size_t last) {
+                for (size_t b = first; b < last; ++b) {
+                    partials[b] = blockFn(boundary(b), boundary(b + 1));
+                }
+            };
+
+            if (policy.pool != nullptr && blocks > 1) {
+                policy.pool->parallelFor(0, blocks, 1, run);
+            } else {
+                run(0, blocks);
+            }
+            return Utils::pairwiseReduce(partials.data(), blocks);
+        }
+
+        // Ͼȼٶȣÿδ TILE Դ壬Ա
+        //   1. double ת float õλ
+        //   2.  float  r^21/r  dx/r^3ԶĶԱǳϵ㣩
+        //   3.  G*m_j ۼӵ double
+        // 볬Լ 1e15 m ʱ 1/r^2  float ķǹԶ r^2 Ϊ infЩͬ double
+        void mixedPrecisionAccelerations(const std::vector<double>& px, const std::vector<double>& py,
+            const std::vector<double>& pz, const std::vector<double>& gm, double closeDistance,
+            size_t first, size_t last, std::vector<Vector3D>& accelerations) {
+            const size_t TILE = 256;
+            const size_t n = px.size();
+            const float threshold2 = static_cast<float>(std::max(closeDistance * closeDistance, 1e-20));
+            const float far2 = 1e30f;
+
+            float dx[TILE], dy[TILE], dz[TILE], fallbackPair[TILE];
+
+            for (size_t i = first; i < last; ++i) {
+                const double xi = px[i], yi = py[i], zi = pz[i];
+                double ax = 0.0, ay = 0.0, az = 0.0;
+
+                for (size_t base = 0; base < n; base += TILE) {
+                    const size_t count = std::min(TILE, n - base);
+
+                    for (size_t k = 0; k < count; ++k) {
+                        dx[k] = static_cast<float>(px[base + k] - xi);
+                        dy[k] = static_cast<float>(py[base + k] - yi);
+                        dz[k] = static_cast<float>(pz[base + k] - zi);
+                    }
+
+                    for (size_t k = 0; k < count; ++k) {
+                        float r2 = dx[k] * dx[k] + dy[k] * dy[k] + dz[k] * dz[k];
+                        // r2 Ϊ inf ʱȽΪ٣Ҳ double
+                        bool inRange = r2 >= threshold2 && r2 <= far2;
+                        float inv = 1.0f / std::sqrt(inRange ? r2 : 1.0f);
+                        // ٳ 1/r^2 1/r^3  float ¹
+                        float inv2 = inRange ? inv * inv : 0.0f;
+                        dx[k] = dx[k] * inv * inv2;
+                        dy[k] = dy[k] * inv * inv2;
+                        dz[k] = dz[k] * inv * inv2;
+                        fallbackPair[k] = inRange ? 0.0f : 1.0f;
+                    }
+
+                    for (size_t k = 0; k < count; ++k) {
+                        ax += gm[base + k] * dx[k];
+                        ay += gm[base + k] * dy[k];
+                        az += gm[base + k] * dz[k];
+                    }
+
+                    // ԡԶĶԣԼ double ¼
+                    for (size_t k = 0; k < count; ++k) {
+                        if (fallbackPair[k] == 0.0f || base + k == i) continue;
+                        double rx = px[base + k] - xi, ry = py[base + k] - yi, rz = pz[base + k] - zi;
+                        double d = std::sqrt(rx * rx + ry * ry + rz * rz);
+                        if (d < 1e-10) continue;
+                        double s = gm[base + k] / (d * d * d);
+                        ax += rx * s;
+                        ay += ry * s;
+                        az += rz * s;
+                    }
+                }
+
+                accelerations[i] = Vector3D(ax, ay, az);
+            }
+        }
+
+    } // namespace
+
     void GravityEngine::calculateGravitationalDerivatives(const SystemState& state, SystemState& derivatives) {
         size_t numBodies = state.positions.size();
 
+        // δʱÿͬ
+        std::vector<double> masses(numBodies, PhysicsConstants::SOLAR_MASS); // ʱʹ̫
+        calculateGravitationalDerivatives(state, derivatives, masses);
+    }
+
+    void GravityEngine::calculateGravitationalDerivatives(const SystemState& state, SystemState& derivatives,
+        const std::vector<double>& masses) {
+        size_t numBodies = state.positions.size();
+        THREEBODY_PHASE(FORCE);
+        THREEBODY_TRACE_SCOPE("force", "physics");
+        THREEBODY_COUNT(FORCE_EVALUATIONS, 1);
+        THREEBODY_COUNT(PAIR_INTERACTIONS, numBodies * (numBodies - 1));
+
         // λõٶȣdr/dt = v
         for (size_t i = 0; i < numBodies; ++i) {
             derivatives.positions[i] = state.velocities[i];
         }
 
         // ٶȵǼٶȣdv/dt = a = F/m
-        // ҪϢÿͬĽ
-        std::vector<double> masses(numBodies, PhysicsConstants::SOLAR_MASS); // ʱʹ̫
-
         for (size_t i = 0; i < numBodies; ++i) {
             Vector3D netForce = calculateNetForce(state.positions, masses, i);
             derivatives.velocities[i] = netForce / masses[i];
@@ -24,6 +151,159 @@ namespace Physics {
         derivatives.time = 1.0; // ʱ䵼1
     }
 
+    void GravityEngine::calculateGravitationalDerivatives(const SystemState& state, SystemState& derivatives,
+        const std::vector<double>& masses, const ExecutionPolicy& policy) {
+        size_t numBodies = state.positions.size();
+        THREEBODY_PHASE(FORCE);
+        THREEBODY_TRACE_SCOPE("force", "physics");
+        THREEBODY_COUNT(FORCE_EVALUATIONS, 1);
+        THREEBODY_COUNT(PAIR_INTERACTIONS, numBodies * (numBodies - 1));
+        size_t chunk = std::max<size_t>(policy.blockSize, 1);
+
+        if (policy.precision == ForcePrecision::MIXED) {
+            std::vector<double> px(numBodies), py(numBodies), pz(numBodies), gm(numBodies);
+            for (size_t i = 0; i < numBodies; ++i) {
+                px[i] = state.positions[i].x;
+                py[i] = state.positions[i].y;
+                pz[i] = state.positions[i].z;
+                gm[i] = PhysicsConstants::G * masses[i];
+                derivatives.positions[i] = state.velocities[i];
+            }
+
+            auto computeRange = [&](size_t first, size_t last) {
+                mixedPrecisionAccelerations(px, py, pz, gm, policy.closePairDistance, first, last, derivatives.velocities);
+            };
+            if (policy.pool != nullptr) {
+                policy.pool->parallelFor(0, numBodies, chunk, computeRange);
+            } else {
+                computeRange(0, numBodies);
+            }
+
+            derivatives.time = 1.0;
+            return;
+        }
+
+        // ÿһ̶߳㣬 j Ĺ̶˳ۼ
+        auto computeRange = [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                derivatives.positions[i] = state.velocities[i];
+
+                Vector3D netForce = withAccumulator(policy.summation, [&](auto accumulator) {
+                    Utils::VectorSum<decltype(accumulator)> sum;
+                    for (size_t j = 0; j < numBodies; ++j) {
+                        if (j == i) continue;
+                        sum.add(calculateGravitationalForce(state.positions[i], masses[i], state.positions[j], masses[j]));
+                    }
+                    return sum.value();
+                });
+                derivatives.velocities[i] = netForce / masses[i];
+            }
+        };
+
+        if (policy.pool != nullptr) {
+            policy.pool->parallelFor(0, numBodies, chunk, computeRange);
+        } else {
+            computeRange(0, numBodies);
+        }
+
+        derivatives.time = 1.0;
+    }
+
+    void GravityEngine::calculateGravitationalDerivatives(const SystemState& state, SystemState& derivatives,
+        const std::vector<double>& masses, ForceDiagnostics& diagnostics) {
+        size_t numBodies = state.positions.size();
+        THREEBODY_PHASE(FORCE);
+        THREEBODY_TRACE_SCOPE("force", "physics");
+        THREEBODY_COUNT(FORCE_EVALUATIONS, 1);
+        THREEBODY_COUNT(PAIR_INTERACTIONS, numBodies * (numBodies - 1) / 2);
+
+        double kinetic = 0.0;
+        Vector3D momentum(0, 0, 0);
+        for (size_t i = 0; i < numBodies; ++i) {
+            derivatives.positions[i] = state.velocities[i];
+            derivatives.velocities[i] = Vector3D(0, 0, 0);
+            kinetic += 0.5 * masses[i] * state.velocities[i].magnitudeSquared();
+            momentum = momentum + state.velocities[i] * masses[i];
+        }
+
+        double potential = 0.0;
+        double virial = 0.0;
+        for (size_t i = 0; i < numBodies; ++i) {
+            const Vector3D& pi = state.positions[i];
+            Vector3D ai(0, 0, 0);
+            for (size_t j = i + 1; j < numBodies; ++j) {
+                Vector3D r = state.positions[j] - pi;
+                double d2 = r.magnitudeSquared();
+                double d = std::sqrt(d2);
+                if (d < 1e-10) continue;
+
+                // һξͬʱõ˫ٶȡά
+                double inv3 = 1.0 / (d2 * d);
+                double gmi = PhysicsConstants::G * masses[i];
+                double gmj = PhysicsConstants::G * masses[j];
+                ai = ai + r * (gmj * inv3);
+                derivatives.velocities[j] = derivatives.velocities[j] - r * (gmi * inv3);
+
+                double pairPotential = -gmi * masses[j] / d;
+                potential += pairPotential;
+                virial += pairPotential; // r . F = -G m_i m_j / r
+            }
+            derivatives.velocities[i] = derivatives.velocities[i] + ai;
+        }
+
+        derivatives.time = 1.0;
+
+        diagnostics.kineticEnergy = kinetic;
+        diagnostics.potentialEnergy = potential;
+        diagnostics.virial = virial;
+        diagnostics.momentum = momentum;
+    }
+
+    void GravityEngine::calculateVariationalDerivatives(const SystemState& state, SystemState& derivatives,
+        const std::vector<double>& masses) {
+        const size_t n = masses.size();
+        THREEBODY_PHASE(FORCE);
+        THREEBODY_TRACE_SCOPE("force_variational", "physics");
+        THREEBODY_COUNT(FORCE_EVALUATIONS, 1);
+        THREEBODY_COUNT(PAIR_INTERACTIONS, n * (n - 1) / 2);
+
+        derivatives.positions.resize(2 * n);
+        derivatives.velocities.resize(2 * n);
+        for (size_t i = 0; i < 2 * n; ++i) {
+            derivatives.positions[i] = state.velocities[i];
+            derivatives.velocities[i] = Vector3D::zero();
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            const Vector3D& pi = state.positions[i];
+            const Vector3D& dpi = state.positions[n + i];
+            Vector3D ai = Vector3D::zero();
+            Vector3D dai = Vector3D::zero();
+            for (size_t j = i + 1; j < n; ++j) {
+                Vector3D r = state.positions[j] - pi;
+                double d2 = r.magnitudeSquared();
+                double d = std::sqrt(d2);
+                if (d < 1e-10) continue;
+
+                double inv3 = 1.0 / (d2 * d);
+                double gmi = PhysicsConstants::G * masses[i];
+                double gmj = PhysicsConstants::G * masses[j];
+                ai.addScaled(r, gmj * inv3);
+                derivatives.velocities[j].addScaled(r, -gmi * inv3);
+
+                // ϫƫ ij Գ
+                Vector3D dr = state.positions[n + j] - dpi;
+                Vector3D tidal = dr * inv3 - r * (3.0 * r.dot(dr) * inv3 / d2);
+                dai.addScaled(tidal, gmj);
+                derivatives.velocities[n + j].addScaled(tidal, -gmi);
+            }
+            derivatives.velocities[i] += ai;
+            derivatives.velocities[n + i] += dai;
+        }
+
+        derivatives.time = 1.0;
+    }
+
     Vector3D GravityEngine::calculateGravitationalForce(const Vector3D& pos1, double mass1,
         const Vector3D& pos2, double mass2) {
         Vector3D r = pos2 - pos1;
@@ -84,6 +364,53 @@ namespace Physics {
         return kineticEnergy + potentialEnergy;
     }
 
+    double GravityEngine::calculateTotalEnergy(const std::vector<Vector3D>& positions,
+        const std::vector<Vector3D>& velocities,
+        const std::vector<double>& masses,
+        const ExecutionPolicy& policy) {
+        size_t numBodies = positions.size();
+
+        double kineticEnergy = reduceBlocks<double>(numBodies, policy, [&](size_t first, size_t last) {
+            return withAccumulator(policy.summation, [&](auto sum) {
+                for (size_t i = first; i < last; ++i) {
+                    sum.add(0.5 * masses[i] * velocities[i].magnitudeSquared());
+                }
+                return sum.value();
+            });
+        });
+
+        // ܰ i ֿ飬ÿж j > i 
+        double potentialEnergy = reduceBlocks<double>(numBodies, policy, [&](size_t first, size_t last) {
+            return withAccumulator(policy.summation, [&](auto sum) {
+                for (size_t i = first; i < last; ++i) {
+                    for (size_t j = i + 1; j < numBodies; ++j) {
+                        double distance = (positions[i] - positions[j]).magnitude();
+                        if (distance > 1e-10) {
+                            sum.add(-PhysicsConstants::G * masses[i] * masses[j] / distance);
+                        }
+                    }
+                }
+                return sum.value();
+            });
+        });
+
+        return kineticEnergy + potentialEnergy;
+    }
+
+    Vector3D GravityEngine::calculateTotalMomentum(const std::vector<Vector3D>& velocities,
+        const std::vector<double>& masses,
+        const ExecutionPolicy& policy) {
+        return reduceBlocks<Vector3D>(velocities.size(), policy, [&](size_t first, size_t last) {
+            return withAccumulator(policy.summation, [&](auto accumulator) {
+                Utils::VectorSum<decltype(accumulator)> sum;
+                for (size_t i = first; i < last; ++i) {
+                    sum.add(velocities[i] * masses[i]);
+                }
+                return sum.value();
+            });
+        });
+    }
+
     Vector3D GravityEngine::calculateTotalMomentum(const std::vector<Vector3D>& velocities,
         const std::vector<double>& masses) {
         Vector3D totalMomentum(0, 0, 0);
@@ -1,12 +1,108 @@
 #include "physics/Integrator.h"
+#include "utils/Instrumentation.h"
+#include "utils/Trace.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <stdexcept>
 
 namespace Physics {
 
-    void Integrator::integrateStep(SystemState& state,
-        DerivativeFunction derivFunc,
-        double dt,
-        Method method) {
+    namespace {
+        // Dormand-Prince 5(4) ϵ
+        const double DP_C[7] = { 0.0, 1.0 / 5.0, 3.0 / 10.0, 4.0 / 5.0, 8.0 / 9.0, 1.0, 1.0 };
+        const double DP_A[7][6] = {
+            { 0, 0, 0, 0, 0, 0 },
+            { 1.0 / 5.0, 0, 0, 0, 0, 0 },
+            { 3.0 / 40.0, 9.0 / 40.0, 0, 0, 0, 0 },
+            { 44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0, 0, 0, 0 },
+            { 19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0, -212.0 / 729.0, 0, 0 },
+            { 9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0, 49.0 / 176.0, -5103.0 / 18656.0, 0 },
+            { 35.0 / 384.0, 0.0, 500.0 / 1113.0, 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0 } // ׽Ȩ
+        };
+        // ׽Ľ׽֮Ȩ
+        const double DP_E[7] = { 71.0 / 57600.0, 0.0, -71.0 / 16695.0, 71.0 / 1920.0,
+            -17253.0 / 339200.0, 22.0 / 525.0, -1.0 / 40.0 };
+
+        // out = y + h * sum(a[j] * k[j])
+        void combine(const SystemState& y, const SystemState* k, const double* a, int count, double h, SystemState& out) {
+            THREEBODY_PHASE(STAGE_UPDATE);
+            for (size_t i = 0; i < y.positions.size(); ++i) {
+                Vector3D dr(0, 0, 0), dv(0, 0, 0);
+                for (int j = 0; j < count; ++j) {
+                    if (a[j] == 0.0) continue;
+                    dr.addScaled(k[j].positions[i], a[j]);
+                    dv.addScaled(k[j].velocities[i], a[j]);
+                }
+                out.positions[i] = Vector3D::axpy(y.positions[i], dr, h);
+                out.velocities[i] = Vector3D::axpy(y.velocities[i], dv, h);
+            }
+        }
+
+        // ֪ k[0] = f(y)׽ outevaluateLast ʱ k[6] = f(out)FSAL
+        void dormandPrinceStages(const SystemState& y, const DerivativeFunction& derivFunc, double h,
+            SystemState* k, SystemState& out, bool evaluateLast) {
+            SystemState temp(y.positions.size());
+            for (int s = 1; s < 6; ++s) {
+                combine(y, k, DP_A[s], s, h, temp);
+                temp.time = y.time + DP_C[s] * h;
+                derivFunc(temp, k[s]);
+            }
+            combine(y, k, DP_A[6], 6, h, out);
+            out.time = y.time + h;
+            if (evaluateLast) derivFunc(out, k[6]);
+        }
+
+        double maxMagnitude(const std::vector<Vector3D>& a, const std::vector<Vector3D>& b) {
+            double m = 0.0;
+            for (size_t i = 0; i < a.size(); ++i) {
+                m = std::max(m, std::max(a[i].magnitude(), b[i].magnitude()));
+            }
+            return m;
+        }
+
+        // λáٶȷֱϵͳ߶ȣλ / ٶȵģΪ׼ȡֵ
+        //  SI λλٶʱݲʧЧ
+        double errorNorm(const SystemState& y, const SystemState& next, const SystemState* k, double h,
+            const AdaptiveOptions& options) {
+            double positionScale = options.absoluteTolerance +
+                options.relativeTolerance * maxMagnitude(y.positions, next.positions);
+            double velocityScale = options.absoluteTolerance +
+                options.relativeTolerance * maxMagnitude(y.velocities, next.velocities);
+
+            double err = 0.0;
+            for (size_t i = 0; i < y.positions.size(); ++i) {
+                Vector3D er(0, 0, 0), ev(0, 0, 0);
+                for (int j = 0; j < 7; ++j) {
+                    if (DP_E[j] == 0.0) continue;
+                    er.addScaled(k[j].positions[i], DP_E[j]);
+                    ev.addScaled(k[j].velocities[i], DP_E[j]);
+                }
+                if (positionScale > 0.0) err = std::max(err, std::fabs(h) * er.magnitude() / positionScale);
+                if (velocityScale > 0.0) err = std::max(err, std::fabs(h) * ev.magnitude() / velocityScale);
+            }
+            return err;
+        }
+
+        // ʼȡλáٶȱ仯ʱ߶нСߵ 1%
+        double estimateInitialStep(const SystemState& y, const SystemState& f, double totalTime) {
+            double r = 0.0, v = 0.0, a = 0.0;
+            for (size_t i = 0; i < y.positions.size(); ++i) {
+                r = std::max(r, y.positions[i].magnitude());
+                v = std::max(v, y.velocities[i].magnitude());
+                a = std::max(a, f.velocities[i].magnitude());
+            }
+            double scale = totalTime;
+            if (v > 0.0 && r > 0.0) scale = std::min(scale, r / v);
+            if (a > 0.0 && v > 0.0) scale = std::min(scale, v / a);
+            if (a > 0.0 && r > 0.0) scale = std::min(scale, std::sqrt(r / a));
+            return 0.01 * scale;
+        }
+    }
+
+    void Integrator::step(SystemState& state, const DerivativeFunction& derivFunc, double dt) {
+        THREEBODY_COUNT(STEPS, 1);
+        THREEBODY_TRACE_SCOPE("step", "integrator");
         switch (method) {
         case EULER:
             eulerStep(state, derivFunc, dt);
@@ -17,39 +113,143 @@ namespace Physics {
         case VERLET:
             verletStep(state, derivFunc, dt);
             break;
+        case DORMAND_PRINCE_45:
+            dormandPrinceStep(state, derivFunc, dt);
+            break;
         default:
             std::cerr << "Unknown integration method, using RK4" << std::endl;
             rk4Step(state, derivFunc, dt);
         }
     }
 
-    void Integrator::integrate(SystemState& state,
-        DerivativeFunction derivFunc,
+    void Integrator::advance(SystemState& state,
+        const DerivativeFunction& derivFunc,
         double totalTime,
         double timeStep,
-        Method method) {
+        const StepCallback& onStep) {
         int steps = static_cast<int>(totalTime / timeStep);
 
         for (int i = 0; i < steps; ++i) {
-            integrateStep(state, derivFunc, timeStep, method);
+            step(state, derivFunc, timeStep);
             state.time += timeStep;
+            if (onStep) onStep(state);
         }
     }
 
+    void Integrator::integrate(SystemState& state,
+        DerivativeFunction derivFunc,
+        double totalTime,
+        double timeStep,
+        Method method) {
+        Integrator(method).advance(state, derivFunc, totalTime, timeStep);
+    }
+
+    void Integrator::integrate(SystemState& state,
+        DerivativeFunction derivFunc,
+        double totalTime,
+        double timeStep,
+        Method method,
+        const StepCallback& onStep) {
+        Integrator(method).advance(state, derivFunc, totalTime, timeStep, onStep);
+    }
+
+    AdaptiveStats Integrator::integrateAdaptive(SystemState& state,
+        DerivativeFunction derivFunc,
+        double totalTime,
+        const AdaptiveOptions& options,
+        const StepCallback& onStep) {
+        if (options.relativeTolerance < 0.0 || options.absoluteTolerance < 0.0 ||
+            options.relativeTolerance + options.absoluteTolerance <= 0.0) {
+            throw std::invalid_argument("Adaptive integration needs a positive tolerance");
+        }
+
+        AdaptiveStats stats;
+        if (totalTime <= 0.0) return stats;
+
+        size_t n = state.positions.size();
+        SystemState k[7];
+        for (SystemState& stage : k) stage = SystemState(n);
+        SystemState next(n);
+
+        derivFunc(state, k[0]);
+        ++stats.evaluations;
+
+        const double endTime = state.time + totalTime;
+        double h = options.initialStep > 0.0 ? options.initialStep : estimateInitialStep(state, k[0], totalTime);
+        if (options.maxStep > 0.0) h = std::min(h, options.maxStep);
+
+        while (state.time < endTime) {
+            if (stats.acceptedSteps + stats.rejectedSteps >= options.maxSteps) {
+                throw std::runtime_error("Adaptive integration exceeded maxSteps");
+            }
+
+            THREEBODY_TRACE_SCOPE("adaptive_step", "integrator");
+            // һص endTimeضǰĲĽ鲽
+            const double proposed = h;
+            bool last = state.time + h >= endTime;
+            if (last) h = endTime - state.time;
+
+            dormandPrinceStages(state, derivFunc, h, k, next, true);
+            stats.evaluations += 6;
+
+            double err = errorNorm(state, next, k, h, options);
+            double factor = err > 0.0 ? options.safety * std::pow(err, -0.2) : 5.0;
+            factor = std::min(5.0, std::max(0.2, factor));
+
+            if (err <= 1.0) {
+                state.positions.swap(next.positions);
+                state.velocities.swap(next.velocities);
+                state.time = last ? endTime : state.time + h;
+                std::swap(k[0], k[6]);
+                ++stats.acceptedSteps;
+                THREEBODY_COUNT(STEPS, 1);
+                if (onStep) onStep(state);
+                if (last) {
+                    // µһСοֻм ULPپݴ˵ж
+                    stats.lastStep = proposed;
+                    break;
+                }
+            } else {
+                ++stats.rejectedSteps;
+                THREEBODY_COUNT(REJECTED_STEPS, 1);
+                factor = std::min(factor, 1.0);
+            }
+
+            h *= factor;
+            if (options.maxStep > 0.0) h = std::min(h, options.maxStep);
+            if (h < options.minStep || state.time + h == state.time) {
+                throw std::runtime_error("Adaptive integration step size underflow");
+            }
+        }
+
+        return stats;
+    }
+
+    IntegratorState Integrator::captureState() const {
+        IntegratorState saved;
+        saved.previousPositions = prevPositions;
+        return saved;
+    }
+
+    void Integrator::restoreState(const IntegratorState& saved) {
+        prevPositions = saved.previousPositions;
+    }
+
     // ŷʵ
-    void Integrator::eulerStep(SystemState& state, DerivativeFunction derivFunc, double dt) {
+    void Integrator::eulerStep(SystemState& state, const DerivativeFunction& derivFunc, double dt) {
         SystemState derivative(state.positions.size());
         derivFunc(state, derivative);
 
         // λúٶ: y_{n+1} = y_n + dt * f(t_n, y_n)
+        THREEBODY_PHASE(STAGE_UPDATE);
         for (size_t i = 0; i < state.positions.size(); ++i) {
-            state.positions[i] = state.positions[i] + derivative.positions[i] * dt;
-            state.velocities[i] = state.velocities[i] + derivative.velocities[i] * dt;
+            state.positions[i].addScaled(derivative.positions[i], dt);
+            state.velocities[i].addScaled(derivative.velocities[i], dt);
         }
     }
 
     // Ľ-ʵ
-    void Integrator::rk4Step(SystemState& state, DerivativeFunction derivFunc, double dt) {
+    void Integrator::rk4Step(SystemState& state, const DerivativeFunction& derivFunc, double dt) {
         size_t n = state.positions.size();
 
         SystemState k1(n), k2(n), k3(n), k4(n);
@@ -78,53 +278,67 @@ namespace Physics {
         weightedSum = addStates(weightedSum, k3, 2.0);
         weightedSum = addStates(weightedSum, k4, 1.0);
 
+        THREEBODY_PHASE(STAGE_UPDATE);
         for (size_t i = 0; i < n; ++i) {
-            state.positions[i] = state.positions[i] + weightedSum.positions[i] * (dt / 6.0);
-            state.velocities[i] = state.velocities[i] + weightedSum.velocities[i] * (dt / 6.0);
+            state.positions[i].addScaled(weightedSum.positions[i], dt / 6.0);
+            state.velocities[i].addScaled(weightedSum.velocities[i], dt / 6.0);
         }
     }
 
     // Verletʵ
-    void Integrator::verletStep(SystemState& state, DerivativeFunction derivFunc, double dt) {
-        static std::vector<Vector3D> prevPositions;
-
-        if (prevPositions.size() != state.positions.size()) {
-            // һεãʹŷʼ
-            prevPositions = state.positions;
-            SystemState derivative(state.positions.size());
-            derivFunc(state, derivative);
-
-            for (size_t i = 0; i < state.positions.size(); ++i) {
-                prevPositions[i] = state.positions[i] - state.velocities[i] * dt +
-                    derivative.velocities[i] * (dt * dt * 0.5);
+    void Integrator::verletStep(SystemState& state, const DerivativeFunction& derivFunc, double dt) {
+        size_t n = state.positions.size();
+        SystemState derivative(n);
+        derivFunc(state, derivative);
+
+        THREEBODY_PHASE(STAGE_UPDATE);
+        if (prevPositions.size() != n) {
+            // ûʷײ reset ֮󣩣̩չһλãճƽ
+            prevPositions.resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                prevPositions[i] = Vector3D::axpy(state.positions[i] - state.velocities[i] * dt,
+                    derivative.velocities[i], dt * dt * 0.5);
             }
-            return;
         }
 
-        SystemState derivative(state.positions.size());
-        derivFunc(state, derivative);
-
-        std::vector<Vector3D> newPositions(state.positions.size());
-        for (size_t i = 0; i < state.positions.size(); ++i) {
+        const double inverseDt = 1.0 / dt;
+        for (size_t i = 0; i < n; ++i) {
             // r_{n+1} = 2r_n - r_{n-1} + a_n * dt^2
-            newPositions[i] = state.positions[i] * 2.0 - prevPositions[i] +
-                derivative.velocities[i] * (dt * dt);
+            Vector3D next = Vector3D::axpy(state.positions[i] * 2.0 - prevPositions[i],
+                derivative.velocities[i], dt * dt);
+
+            // λͬһʱ̵ٶ: v_{n+1} = (r_{n+1} - r_n) / dt + a_n * dt / 2 O(dt^2)
+            // ֻλõĵƲ
+            state.velocities[i] = Vector3D::axpy((next - state.positions[i]) * inverseDt,
+                derivative.velocities[i], dt * 0.5);
 
-            // ٶ: v_n = (r_{n+1} - r_{n-1}) / (2*dt)
-            state.velocities[i] = (newPositions[i] - prevPositions[i]) / (2.0 * dt);
+            prevPositions[i] = state.positions[i];
+            state.positions[i] = next;
         }
+    }
+
+    // Dormand-Prince ׽⣨̶ƣ
+    void Integrator::dormandPrinceStep(SystemState& state, const DerivativeFunction& derivFunc, double dt) {
+        size_t n = state.positions.size();
+        SystemState k[7];
+        for (SystemState& stage : k) stage = SystemState(n);
+        SystemState next(n);
+
+        derivFunc(state, k[0]);
+        dormandPrinceStages(state, derivFunc, dt, k, next, false);
 
-        prevPositions = state.positions;
-        state.positions = newPositions;
+        state.positions.swap(next.positions);
+        state.velocities.swap(next.velocities);
     }
 
     // ״̬
     SystemState Integrator::addStates(const SystemState& a, const SystemState& b, double scale) {
+        THREEBODY_PHASE(STAGE_UPDATE);
         SystemState result(a.positions.size());
 
         for (size_t i = 0; i < a.positions.size(); ++i) {
-            result.positions[i] = a.positions[i] + b.positions[i] * scale;
-            result.velocities[i] = a.velocities[i] + b.velocities[i] * scale;
+            result.positions[i] = Vector3D::axpy(a.positions[i], b.positions[i], scale);
+            result.velocities[i] = Vector3D::axpy(a.velocities[i], b.velocities[i], scale);
         }
 
         result.time = a.time + b.time * scale;
@@ -0,0 +1,119 @@
+﻿#include "physics/TestParticles.h"
+#include "physics/GravityEngine.h"
+#include "physics/PhysicsConstants.h"
+#include "utils/Instrumentation.h"
+#include "utils/ThreadPool.h"
+#include "utils/Trace.h"
+#include <algorithm>
+#include <cmath>
+
+namespace Physics {
+
+    namespace {
+        // 每个并行任务处理的粒子数
+        const size_t PARTICLE_CHUNK = 1024;
+    }
+
+    size_t TestParticleSwarm::add(const Vector3D& position, const Vector3D& velocity) {
+        x.push_back(position.x);
+        y.push_back(position.y);
+        z.push_back(position.z);
+        vx.push_back(velocity.x);
+        vy.push_back(velocity.y);
+        vz.push_back(velocity.z);
+        return x.size() - 1;
+    }
+
+    void TestParticleSwarm::reserve(size_t count) {
+        for (std::vector<double>* v : { &x, &y, &z, &vx, &vy, &vz }) v->reserve(count);
+    }
+
+    void TestParticleSwarm::accelerations(const std::vector<Vector3D>& massivePositions, const std::vector<double>& masses,
+        size_t begin, size_t end, double* ax, double* ay, double* az) const {
+        const size_t count = end - begin;
+        const double* px = x.data() + begin;
+        const double* py = y.data() + begin;
+        const double* pz = z.data() + begin;
+        for (size_t i = 0; i < count; ++i) {
+            ax[i] = 0.0;
+            ay[i] = 0.0;
+            az[i] = 0.0;
+        }
+        // 外层遍历少数大质量天体，内层对粒子连续访问（无分支，可向量化）
+        for (size_t m = 0; m < massivePositions.size(); ++m) {
+            const double gm = PhysicsConstants::G * masses[m];
+            if (gm == 0.0) continue;
+            const double mx = massivePositions[m].x, my = massivePositions[m].y, mz = massivePositions[m].z;
+            for (size_t i = 0; i < count; ++i) {
+                double dx = mx - px[i];
+                double dy = my - py[i];
+                double dz = mz - pz[i];
+                double d2 = dx * dx + dy * dy + dz * dz;
+                // 与 GravityEngine 相同的重合截断（d < 1e-10 时不受力）
+                double s = d2 < 1e-20 ? 0.0 : gm / (d2 * std::sqrt(d2));
+                ax[i] += dx * s;
+                ay[i] += dy * s;
+                az[i] += dz * s;
+            }
+        }
+        THREEBODY_COUNT(PAIR_INTERACTIONS, massivePositions.size() * count);
+    }
+
+    void TestParticleSwarm::step(const SystemState& massiveBefore, const SystemState& massiveAfter,
+        const std::vector<double>& masses, double dt, Utils::ThreadPool* pool) {
+        THREEBODY_PHASE(FORCE);
+        THREEBODY_TRACE_SCOPE("test_particles", "physics");
+
+        // 三次 Hermite 插值的中点：(p0 + p1) / 2 + dt * (v0 - v1) / 8
+        std::vector<Vector3D> midpoint(massiveBefore.positions.size());
+        for (size_t m = 0; m < midpoint.size(); ++m) {
+            midpoint[m] = (massiveBefore.positions[m] + massiveAfter.positions[m]) * 0.5 +
+                (massiveBefore.velocities[m] - massiveAfter.velocities[m]) * (dt * 0.125);
+        }
+
+        const double half = 0.5 * dt;
+        auto run = [&](size_t begin, size_t end) {
+            double ax[PARTICLE_CHUNK], ay[PARTICLE_CHUNK], az[PARTICLE_CHUNK];
+            for (size_t chunk = begin; chunk < end; chunk += PARTICLE_CHUNK) {
+                size_t chunkEnd = std::min(end, chunk + PARTICLE_CHUNK);
+                for (size_t i = chunk; i < chunkEnd; ++i) {
+                    x[i] += vx[i] * half;
+                    y[i] += vy[i] * half;
+                    z[i] += vz[i] * half;
+                }
+                accelerations(midpoint, masses, chunk, chunkEnd, ax, ay, az);
+                for (size_t i = chunk; i < chunkEnd; ++i) {
+                    size_t k = i - chunk;
+                    vx[i] += ax[k] * dt;
+                    vy[i] += ay[k] * dt;
+                    vz[i] += az[k] * dt;
+                    x[i] += vx[i] * half;
+                    y[i] += vy[i] * half;
+                    z[i] += vz[i] * half;
+                }
+            }
+        };
+
+        if (pool != nullptr && size() > PARTICLE_CHUNK) {
+            pool->parallelFor(0, size(), PARTICLE_CHUNK, run);
+        } else {
+            run(0, size());
+        }
+    }
+
+    void TestParticleSwarm::advance(SystemState& massive, const std::vector<double>& masses, Integrator& integrator,
+        double totalTime, double timeStep, Utils::ThreadPool* pool) {
+        DerivativeFunction derivFunc = [&masses](const SystemState& s, SystemState& d) {
+            GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        };
+        int steps = static_cast<int>(totalTime / timeStep);
+        SystemState before;
+        for (int i = 0; i < steps; ++i) {
+            before = massive;
+            integrator.step(massive, derivFunc, timeStep);
+            massive.time += timeStep;
+            step(before, massive, masses, timeStep, pool);
+        }
+    }
+
+} // namespace Physics
@@ -0,0 +1,220 @@
+﻿#include "simulation/AdaptiveStabilityMap.h"
+#include "utils/ThreadPool.h"
+#include "utils/Trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+
+namespace Simulation {
+
+    namespace {
+        // 一次细化：parent 分成从 firstChild 起的四个子块
+        struct Refinement {
+            size_t parent;
+            size_t firstChild;
+            double priority;
+            bool accepted;
+        };
+
+        // 优先级高者先出；相同时按父块序号，保证领取顺序与线程数无关
+        struct LowerPriority {
+            const std::vector<Refinement>* refinements;
+            bool operator()(size_t a, size_t b) const {
+                const Refinement& ra = (*refinements)[a];
+                const Refinement& rb = (*refinements)[b];
+                if (ra.priority != rb.priority) return ra.priority < rb.priority;
+                return ra.parent > rb.parent;
+            }
+        };
+    }
+
+    AdaptiveStabilityMap::AdaptiveStabilityMap(const StabilityMapConfig& config, const AdaptiveMapOptions& options)
+        : config(config), options(options), width(config.x.cells), height(config.y.cells) {
+        if (options.levels > 16) throw std::invalid_argument("Adaptive stability map supports at most 16 levels");
+        const uint32_t coarse = 1u << options.levels;
+        if (width % coarse != 0 || height % coarse != 0) {
+            throw std::invalid_argument("Adaptive stability map needs x.cells and y.cells divisible by 2^levels");
+        }
+    }
+
+    void AdaptiveStabilityMap::simulate(Node& node) const {
+        // 块中心在细网格上的（可能为半整数的）格序号
+        double centre = 0.5 * node.size - 0.5;
+        node.result = runStabilityCell(config, config.x.valueAt(node.x + centre), config.y.valueAt(node.y + centre));
+    }
+
+    void AdaptiveStabilityMap::paint(size_t index) {
+        const Node& node = nodes[index];
+        for (uint32_t y = node.y; y < node.y + node.size; ++y) {
+            std::fill_n(owner.begin() + static_cast<size_t>(y) * width + node.x, node.size, static_cast<uint32_t>(index));
+        }
+    }
+
+    bool AdaptiveStabilityMap::differs(const CellResult& a, const CellResult& b) const {
+        if (a.outcome != b.outcome) return true;
+        if (!config.computeMegno || a.outcome != CellOutcome::SURVIVED) return false;
+        const double chaotic = 2.0 + options.chaosThreshold;
+        return (a.megno > chaotic) != (b.megno > chaotic);
+    }
+
+    double AdaptiveStabilityMap::disagreement(size_t index) const {
+        const Node& node = nodes[index];
+        // 沿四条边收集相邻的叶子（较粗的邻居会重复出现，去重后计数）
+        std::vector<uint32_t> neighbours;
+        auto visit = [&](int64_t x, int64_t y) {
+            if (x < 0 || y < 0 || x >= width || y >= height) return;
+            neighbours.push_back(owner[static_cast<size_t>(y) * width + static_cast<size_t>(x)]);
+        };
+        for (uint32_t k = 0; k < node.size; ++k) {
+            visit(static_cast<int64_t>(node.x) - 1, node.y + k);
+            visit(static_cast<int64_t>(node.x) + node.size, node.y + k);
+            visit(node.x + k, static_cast<int64_t>(node.y) - 1);
+            visit(node.x + k, static_cast<int64_t>(node.y) + node.size);
+        }
+        std::sort(neighbours.begin(), neighbours.end());
+        neighbours.erase(std::unique(neighbours.begin(), neighbours.end()), neighbours.end());
+
+        size_t differing = 0;
+        for (uint32_t n : neighbours) {
+            if (differs(node.result, nodes[n].result)) ++differing;
+        }
+        // 分歧相同时先细化大块，它覆盖的边界更长
+        return static_cast<double>(differing) * node.size;
+    }
+
+    void AdaptiveStabilityMap::compute(std::vector<size_t>& batch) {
+        auto body = [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) simulate(nodes[batch[k]]);
+        };
+        if (options.pool != nullptr) options.pool->parallelFor(0, batch.size(), 1, body);
+        else body(0, batch.size());
+        simulations += batch.size();
+    }
+
+    void AdaptiveStabilityMap::run() {
+        THREEBODY_TRACE_SCOPE("adaptive_stability_map", "analysis");
+        nodes.clear();
+        owner.assign(static_cast<size_t>(width) * height, 0);
+        simulations = 0;
+        rounds = 0;
+
+        // 最粗网格
+        const uint32_t coarse = 1u << options.levels;
+        std::vector<size_t> batch;
+        for (uint32_t y = 0; y < height; y += coarse) {
+            for (uint32_t x = 0; x < width; x += coarse) {
+                Node node;
+                node.x = x;
+                node.y = y;
+                node.size = coarse;
+                node.leaf = true;
+                batch.push_back(nodes.size());
+                nodes.push_back(node);
+            }
+        }
+        compute(batch);
+        for (size_t index : batch) paint(index);
+
+        bool exhausted = false;
+        while (!exhausted) {
+            // 以本轮开始时的叶子划分判定，结果与领取顺序无关
+            std::vector<Refinement> refinements;
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (!nodes[i].leaf || nodes[i].size == 1) continue;
+                double priority = disagreement(i);
+                if (priority > 0.0) refinements.push_back({ i, 0, priority, false });
+            }
+            if (refinements.empty()) break;
+            ++rounds;
+
+            for (Refinement& r : refinements) {
+                r.firstChild = nodes.size();
+                const Node parent = nodes[r.parent];
+                const uint32_t half = parent.size / 2;
+                for (uint32_t k = 0; k < 4; ++k) {
+                    Node child;
+                    child.x = parent.x + (k & 1u) * half;
+                    child.y = parent.y + (k >> 1) * half;
+                    child.size = half;
+                    nodes.push_back(child);
+                }
+            }
+
+            std::priority_queue<size_t, std::vector<size_t>, LowerPriority> queue(LowerPriority{ &refinements });
+            for (size_t i = 0; i < refinements.size(); ++i) queue.push(i);
+            std::mutex queueMutex;
+            size_t reserved = simulations;
+
+            // 每个工作线程反复领取优先级最高的细化，预留四次积分的额度后计算四个子块
+            auto worker = [&](size_t, size_t) {
+                for (;;) {
+                    size_t next;
+                    {
+                        std::lock_guard<std::mutex> lock(queueMutex);
+                        if (queue.empty()) return;
+                        next = queue.top();
+                        queue.pop();
+                        if (options.maxSimulations != 0 && reserved + 4 > options.maxSimulations) {
+                            exhausted = true;
+                            continue;
+                        }
+                        reserved += 4;
+                        refinements[next].accepted = true;
+                    }
+                    for (size_t k = 0; k < 4; ++k) simulate(nodes[refinements[next].firstChild + k]);
+                }
+            };
+            const size_t workers = options.pool != nullptr ? std::max<size_t>(options.pool->size(), 1) : 1;
+            if (options.pool != nullptr) options.pool->parallelFor(0, workers, 1, worker);
+            else worker(0, 1);
+
+            for (const Refinement& r : refinements) {
+                if (!r.accepted) continue;
+                nodes[r.parent].leaf = false;
+                for (size_t k = 0; k < 4; ++k) {
+                    nodes[r.firstChild + k].leaf = true;
+                    paint(r.firstChild + k);
+                }
+                simulations += 4;
+            }
+        }
+    }
+
+    std::vector<AdaptiveLeaf> AdaptiveStabilityMap::leaves() const {
+        std::vector<AdaptiveLeaf> result;
+        for (const Node& node : nodes) {
+            if (!node.leaf) continue;
+            AdaptiveLeaf leaf;
+            leaf.x = node.x;
+            leaf.y = node.y;
+            leaf.size = node.size;
+            leaf.result = node.result;
+            result.push_back(leaf);
+        }
+        return result;
+    }
+
+    void AdaptiveStabilityMap::writeImage(const std::string& path) const {
+        writeStabilityImage(path, width, height, [this](uint32_t row) {
+            std::vector<CellResult> cells(width);
+            for (uint32_t x = 0; x < width; ++x) cells[x] = at(x, row);
+            return cells;
+        }, config.system.duration, config.system.timeStep);
+    }
+
+    void AdaptiveStabilityMap::writeLeaves(std::ostream& out) const {
+        out << "x,y,size,x_value,y_value,outcome,end_time,megno\n";
+        char line[256];
+        for (const Node& node : nodes) {
+            if (!node.leaf) continue;
+            double centre = 0.5 * node.size - 0.5;
+            std::snprintf(line, sizeof(line), "%u,%u,%u,%.10g,%.10g,%s,%.10g,%.10g\n",
+                node.x, node.y, node.size, config.x.valueAt(node.x + centre), config.y.valueAt(node.y + centre),
+                toString(node.result.outcome), node.result.endTime, node.result.megno);
+            out << line;
+        }
+    }
+
+} // namespace Simulation
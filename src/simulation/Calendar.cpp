@@ -0,0 +1,208 @@
+﻿#include "simulation/Calendar.h"
+#include "utils/Instrumentation.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Simulation {
+
+    namespace {
+        const double PI = 3.14159265358979323846;
+    }
+
+    void resolveSuns(CalendarConfig& config, const std::vector<double>& masses) {
+        if (config.planetIndex >= masses.size()) {
+            throw std::invalid_argument("Calendar planet index out of range");
+        }
+        if (config.sunIndices.empty()) {
+            for (size_t i = 0; i < masses.size(); ++i) {
+                if (i != config.planetIndex) config.sunIndices.push_back(i);
+            }
+        }
+        for (size_t sun : config.sunIndices) {
+            if (sun >= masses.size()) throw std::invalid_argument("Calendar sun index out of range");
+        }
+        if (config.luminosities.empty()) {
+            // 主序星质光关系 L ~ M^3.5
+            for (size_t sun : config.sunIndices) {
+                double m = masses[sun] / PhysicsConstants::SOLAR_MASS;
+                config.luminosities.push_back(PhysicsConstants::SOLAR_LUMINOSITY * std::pow(m, 3.5));
+            }
+        }
+        if (config.luminosities.size() != config.sunIndices.size()) {
+            throw std::invalid_argument("Calendar luminosities do not match sun count");
+        }
+    }
+
+    CalendarCalculator::CalendarCalculator(const CalendarConfig& config,
+        const std::vector<double>& masses,
+        StateProvider provider)
+        : config(config), masses(masses), provider(std::move(provider)) {
+        // 扫描与二分的步长都由这些参数决定，非正值（或 NaN）会让循环不再前进
+        if (!(config.rotationPeriod > 0.0) || config.scanStepsPerRotation <= 0 ||
+            !(config.timeTolerance > 0.0) || !(config.eraScanStep > 0.0)) {
+            throw std::invalid_argument("Calendar needs positive rotationPeriod, scanStepsPerRotation, timeTolerance and eraScanStep");
+        }
+        resolveSuns(this->config, masses);
+    }
+
+    EraType CalendarCalculator::classify(const Physics::SystemState& state) const {
+        const Vector3D& planetPos = state.positions[config.planetIndex];
+
+        double totalFlux = 0.0;
+        double dominantFlux = -1.0;
+        size_t dominant = 0;
+        for (size_t k = 0; k < config.sunIndices.size(); ++k) {
+            double d2 = (state.positions[config.sunIndices[k]] - planetPos).magnitudeSquared();
+            double flux = config.luminosities[k] / (4.0 * PI * d2);
+            totalFlux += flux;
+            if (flux > dominantFlux) {
+                dominantFlux = flux;
+                dominant = config.sunIndices[k];
+            }
+        }
+
+        if (totalFlux <= 0.0 || dominantFlux < config.stableFluxFraction * totalFlux) {
+            return EraType::CHAOTIC;
+        }
+
+        // 行星需束缚在主恒星周围（二体比能量为负）
+        Vector3D r = planetPos - state.positions[dominant];
+        Vector3D v = state.velocities[config.planetIndex] - state.velocities[dominant];
+        double energy = 0.5 * v.magnitudeSquared() - PhysicsConstants::G * masses[dominant] / r.magnitude();
+        return energy < 0.0 ? EraType::STABLE : EraType::CHAOTIC;
+    }
+
+    EraType CalendarCalculator::eraAt(double t) const {
+        Physics::SystemState state;
+        provider(t, state);
+        return classify(state);
+    }
+
+    double CalendarCalculator::sunElevation(const Physics::SystemState& state, size_t sunSlot) const {
+        double theta = config.rotationPhase + 2.0 * PI * state.time / config.rotationPeriod;
+        Vector3D up(std::cos(theta), std::sin(theta), 0.0);
+        Vector3D direction = (state.positions[config.sunIndices[sunSlot]] - state.positions[config.planetIndex]).normalized();
+        return up.dot(direction);
+    }
+
+    void CalendarCalculator::scanHorizon(double t0, double t1, bool firstSunriseOnly,
+        std::vector<CalendarEvent>& events) const {
+        THREEBODY_PHASE(EVENTS);
+        const size_t numSuns = config.sunIndices.size();
+        const double step = config.rotationPeriod / config.scanStepsPerRotation;
+
+        Physics::SystemState state;
+        provider(t0, state);
+        std::vector<double> previous(numSuns), current(numSuns);
+        for (size_t k = 0; k < numSuns; ++k) previous[k] = sunElevation(state, k);
+
+        double tPrev = t0;
+        while (tPrev < t1) {
+            double t = std::min(tPrev + step, t1);
+            provider(t, state);
+            for (size_t k = 0; k < numSuns; ++k) current[k] = sunElevation(state, k);
+
+            size_t found = events.size();
+            for (size_t k = 0; k < numSuns; ++k) {
+                bool rising = previous[k] < 0.0 && current[k] >= 0.0;
+                bool setting = previous[k] >= 0.0 && current[k] < 0.0;
+                if (!(rising || (setting && !firstSunriseOnly))) continue;
+
+                // 二分细化穿越时刻
+                double lo = tPrev, hi = t;
+                Physics::SystemState probe;
+                while (hi - lo > config.timeTolerance) {
+                    double mid = 0.5 * (lo + hi);
+                    provider(mid, probe);
+                    bool above = sunElevation(probe, k) >= 0.0;
+                    if (above == rising) hi = mid; else lo = mid;
+                }
+
+                CalendarEvent event;
+                event.time = hi;
+                event.type = rising ? CalendarEventType::SUNRISE : CalendarEventType::SUNSET;
+                event.body = config.sunIndices[k];
+                events.push_back(event);
+            }
+
+            if (firstSunriseOnly && events.size() > found) {
+                auto earliest = std::min_element(events.begin() + found, events.end(),
+                    [](const CalendarEvent& a, const CalendarEvent& b) { return a.time < b.time; });
+                CalendarEvent first = *earliest;
+                events.resize(found);
+                events.push_back(first);
+                return;
+            }
+
+            previous.swap(current);
+            tPrev = t;
+        }
+    }
+
+    void CalendarCalculator::scanEras(double t0, double t1, bool firstOnly,
+        std::vector<CalendarEvent>& events) const {
+        THREEBODY_PHASE(EVENTS);
+        EraType previous = eraAt(t0);
+        double tPrev = t0;
+        while (tPrev < t1) {
+            double t = std::min(tPrev + config.eraScanStep, t1);
+            EraType current = eraAt(t);
+            if (current != previous) {
+                double lo = tPrev, hi = t;
+                while (hi - lo > config.timeTolerance) {
+                    double mid = 0.5 * (lo + hi);
+                    if (eraAt(mid) == previous) lo = mid; else hi = mid;
+                }
+
+                CalendarEvent event;
+                event.time = hi;
+                event.type = CalendarEventType::ERA_CHANGE;
+                event.era = current;
+                events.push_back(event);
+                if (firstOnly) return;
+            }
+            previous = current;
+            tPrev = t;
+        }
+    }
+
+    bool CalendarCalculator::findNextSunrise(double t, double limit, CalendarEvent& event) const {
+        std::vector<CalendarEvent> events;
+        scanHorizon(t, limit, true, events);
+        if (events.empty()) return false;
+        event = events.front();
+        return true;
+    }
+
+    bool CalendarCalculator::findNextEraChange(double t, double limit, CalendarEvent& event) const {
+        std::vector<CalendarEvent> events;
+        scanEras(t, limit, true, events);
+        if (events.empty()) return false;
+        event = events.front();
+        return true;
+    }
+
+    std::vector<CalendarEvent> CalendarCalculator::generate(double t0, double t1) const {
+        std::vector<CalendarEvent> events;
+        scanHorizon(t0, t1, false, events);
+        scanEras(t0, t1, false, events);
+        std::stable_sort(events.begin(), events.end(),
+            [](const CalendarEvent& a, const CalendarEvent& b) { return a.time < b.time; });
+        return events;
+    }
+
+    const char* toString(EraType era) {
+        return era == EraType::STABLE ? "STABLE" : "CHAOTIC";
+    }
+
+    const char* toString(CalendarEventType type) {
+        switch (type) {
+        case CalendarEventType::SUNRISE: return "SUNRISE";
+        case CalendarEventType::SUNSET: return "SUNSET";
+        case CalendarEventType::ERA_CHANGE: return "ERA";
+        }
+        return "UNKNOWN";
+    }
+
+} // namespace Simulation
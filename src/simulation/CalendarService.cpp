@@ -0,0 +1,144 @@
+﻿#include "simulation/CalendarService.h"
+#include "utils/Instrumentation.h"
+#include "utils/Trace.h"
+#include "utils/ThreadPool.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace Simulation {
+
+    namespace {
+
+        std::vector<double> bodyMasses(const Ephemeris& index) {
+            std::vector<double> masses(index.getBodyCount());
+            for (size_t i = 0; i < masses.size(); ++i) {
+                masses[i] = index.getBody(i).mass;
+            }
+            return masses;
+        }
+
+        void writeEvent(std::ostream& out, const CalendarEvent& event, const Ephemeris& index) {
+            out << ' ' << toString(event.type) << ':' << event.time << ':';
+            if (event.type == CalendarEventType::ERA_CHANGE) {
+                out << toString(event.era);
+            } else {
+                out << index.getBody(event.body).name;
+            }
+        }
+
+    } // namespace
+
+    CalendarService::CalendarService(const std::string& ephemerisPath,
+        const CalendarConfig& config,
+        size_t cacheSegments)
+        : ephemeris(ephemerisPath, cacheSegments),
+        calculator(config, bodyMasses(ephemeris.getIndex()),
+            [this](double t, Physics::SystemState& state) { ephemeris.evaluateAll(t, state); }) {
+        THREEBODY_TRACE_SCOPE("era_boundaries", "calendar");
+        const Ephemeris& index = ephemeris.getIndex();
+        CalendarEvent event;
+        double t = index.getStartTime();
+        while (calculator.findNextEraChange(t, index.getEndTime(), event)) {
+            eras.push_back(event);
+            t = event.time;
+        }
+    }
+
+    std::string CalendarService::handle(const std::string& request) {
+        std::istringstream in(request);
+        std::string id, command;
+        in >> id >> command;
+
+        std::ostringstream out;
+        out.precision(15);
+        out << id;
+
+        const Ephemeris& index = ephemeris.getIndex();
+        try {
+            if (command == "STATE") {
+                double t;
+                if (!(in >> t)) throw std::invalid_argument("usage: STATE <t>");
+                Physics::SystemState state;
+                ephemeris.evaluateAll(t, state);
+                out << " OK STATE " << t;
+                for (size_t i = 0; i < index.getBodyCount(); ++i) {
+                    const Vector3D& p = state.positions[i];
+                    const Vector3D& v = state.velocities[i];
+                    out << ' ' << index.getBody(i).name << ' ' << p.x << ' ' << p.y << ' ' << p.z
+                        << ' ' << v.x << ' ' << v.y << ' ' << v.z;
+                }
+            }
+            else if (command == "CALENDAR") {
+                double t0, t1;
+                if (!(in >> t0 >> t1) || t1 < t0) throw std::invalid_argument("usage: CALENDAR <t0> <t1>");
+                if (t1 - t0 > maxCalendarSpan) {
+                    std::ostringstream limit;
+                    limit << "CALENDAR span exceeds " << maxCalendarSpan << " s";
+                    throw std::invalid_argument(limit.str());
+                }
+                std::vector<CalendarEvent> events = calculator.generate(t0, t1);
+                out << " OK CALENDAR " << toString(calculator.eraAt(t0)) << ' ' << events.size();
+                for (const CalendarEvent& event : events) writeEvent(out, event, index);
+            }
+            else if (command == "NEXT_SUNRISE") {
+                double t;
+                if (!(in >> t)) throw std::invalid_argument("usage: NEXT_SUNRISE <t>");
+                CalendarEvent event;
+                const double limit = std::min(index.getEndTime(),
+                    t + sunriseHorizon * calculator.getConfig().rotationPeriod);
+                if (calculator.findNextSunrise(t, limit, event)) {
+                    out << " OK";
+                    writeEvent(out, event, index);
+                } else {
+                    out << " OK NONE";
+                }
+            }
+            else if (command == "NEXT_ERA") {
+                double t;
+                if (!(in >> t)) throw std::invalid_argument("usage: NEXT_ERA <t>");
+                auto next = std::upper_bound(eras.begin(), eras.end(), t,
+                    [](double time, const CalendarEvent& e) { return time < e.time; });
+                if (next != eras.end()) {
+                    out << " OK";
+                    writeEvent(out, *next, index);
+                } else {
+                    out << " OK NONE";
+                }
+            }
+            else {
+                throw std::invalid_argument("unknown command '" + command + "'");
+            }
+        }
+        catch (const std::exception& e) {
+            std::ostringstream error;
+            error << id << " ERROR " << e.what();
+            return error.str();
+        }
+
+        return out.str();
+    }
+
+    void CalendarService::serve(std::istream& in, std::ostream& out, size_t numThreads) {
+        std::mutex outputMutex;
+        Utils::ThreadPool pool(numThreads);
+
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.empty()) continue;
+            if (line == "QUIT") break;
+            pool.submit([this, line, &out, &outputMutex]() {
+                std::string response = handle(line);
+                THREEBODY_PHASE(IO);
+                THREEBODY_TRACE_SCOPE("response_flush", "io");
+                std::lock_guard<std::mutex> lock(outputMutex);
+                out << response << '\n';
+                out.flush();
+                THREEBODY_COUNT(BYTES_WRITTEN, response.size() + 1);
+            });
+        }
+        // pool 析构时等待所有请求完成
+    }
+
+} // namespace Simulation
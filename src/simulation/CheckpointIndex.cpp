@@ -0,0 +1,102 @@
+﻿#include "simulation/CheckpointIndex.h"
+#include "physics/GravityEngine.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace Simulation {
+
+    CheckpointIndex::CheckpointIndex(const CheckpointPolicy& policy) : policy(policy) {
+        if (policy.denseInterval <= 0.0 || policy.growthFactor < 1.0 || policy.maxInterval < 0.0) {
+            throw std::invalid_argument("Invalid checkpoint policy");
+        }
+        // 不设上限时间距随运行时长无限增长，seek 的最坏延迟也随之增长
+        if (policy.maxInterval == 0.0) {
+            this->policy.maxInterval = std::max(policy.denseSpan,
+                CheckpointPolicy::DEFAULT_MAX_DENSE_INTERVALS * policy.denseInterval);
+        }
+    }
+
+    bool CheckpointIndex::isDue(double t) const {
+        return checkpoints.empty() || t >= nextTime;
+    }
+
+    void CheckpointIndex::record(const Physics::SystemState& state, const Physics::IntegratorState& integrator) {
+        checkpoints.push_back(Checkpoint{ state, integrator });
+        nextTime = state.time + intervalAfter(state.time);
+    }
+
+    double CheckpointIndex::intervalAfter(double t) const {
+        double elapsed = checkpoints.empty() ? 0.0 : t - checkpoints.front().state.time;
+        if (elapsed < policy.denseSpan) {
+            return policy.denseInterval;
+        }
+        double interval = std::max(policy.denseInterval, elapsed * (policy.growthFactor - 1.0));
+        return std::min(interval, policy.maxInterval);
+    }
+
+    const Checkpoint* CheckpointIndex::findBefore(double t) const {
+        auto it = std::upper_bound(checkpoints.begin(), checkpoints.end(), t,
+            [](double value, const Checkpoint& c) { return value < c.state.time; });
+        if (it == checkpoints.begin()) return nullptr;
+        return &*(it - 1);
+    }
+
+    SeekableSimulation::SeekableSimulation(const Physics::SystemState& initial,
+        const std::vector<double>& masses,
+        double timeStep,
+        Physics::Integrator::Method method,
+        const CheckpointPolicy& policy)
+        : derivFunc([masses](const Physics::SystemState& s, Physics::SystemState& d) {
+            Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        }),
+        timeStep(timeStep), method(method), index(policy), frontier(initial) {
+        if (timeStep <= 0.0) {
+            throw std::invalid_argument("SeekableSimulation needs a positive time step");
+        }
+        index.record(frontier, frontierIntegrator);
+    }
+
+    void SeekableSimulation::advanceTo(double t) {
+        Physics::Integrator integrator(method);
+        integrator.restoreState(frontierIntegrator);
+        while (frontier.time < t) {
+            integrator.step(frontier, derivFunc, timeStep);
+            frontier.time += timeStep;
+            if (index.isDue(frontier.time)) {
+                index.record(frontier, integrator.captureState());
+            }
+        }
+        frontierIntegrator = integrator.captureState();
+    }
+
+    Physics::SystemState SeekableSimulation::seek(double t) {
+        if (t > frontier.time) {
+            advanceTo(t);
+        }
+
+        const Checkpoint* start = index.findBefore(t);
+        if (start == nullptr) {
+            throw std::out_of_range("Seek time precedes the first checkpoint");
+        }
+
+        Physics::SystemState state = start->state;
+        Physics::Integrator integrator(method);
+        integrator.restoreState(start->integrator);
+        lastSeekSteps = 0;
+        while (state.time + timeStep <= t + 1e-9 * timeStep) {
+            integrator.step(state, derivFunc, timeStep);
+            state.time += timeStep;
+            ++lastSeekSteps;
+        }
+
+        // 不在步长网格上的余量用一步 RK4 补齐（不影响多步法的历史）
+        double remainder = t - state.time;
+        if (remainder > 1e-9 * timeStep) {
+            Physics::Integrator(Physics::Integrator::RUNGE_KUTTA_4).step(state, derivFunc, remainder);
+            state.time = t;
+        }
+
+        return state;
+    }
+
+} // namespace Simulation
@@ -0,0 +1,391 @@
+﻿#include "simulation/Ephemeris.h"
+#include "utils/Instrumentation.h"
+#include "utils/Trace.h"
+#include "simulation/Trajectory.h"
+#include "utils/BinaryIO.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace Simulation {
+
+    using Utils::writePod;
+    using Utils::writeArray;
+    using Utils::readPod;
+    using Utils::readArray;
+
+    namespace {
+
+        const char EPHEMERIS_MAGIC[8] = { 'T', 'B', 'C', 'E', 'P', 'H', '0', '1' };
+        const uint32_t EPHEMERIS_VERSION = 1;
+        const double PI = 3.14159265358979323846;
+
+        // 在轨迹采样点之间插值
+        class TrajectorySampler {
+        public:
+            explicit TrajectorySampler(const std::vector<Physics::SystemState>& trajectory)
+                : trajectory(trajectory), times(trajectory.size()) {
+                for (size_t i = 0; i < trajectory.size(); ++i) {
+                    times[i] = trajectory[i].time;
+                }
+            }
+
+            Vector3D position(size_t body, double t) const {
+                size_t hi = std::upper_bound(times.begin(), times.end(), t) - times.begin();
+                if (hi == 0) hi = 1;
+                if (hi >= times.size()) hi = times.size() - 1;
+                return hermitePosition(trajectory[hi - 1], trajectory[hi], body, t);
+            }
+
+            const std::vector<double>& getTimes() const { return times; }
+
+        private:
+            const std::vector<Physics::SystemState>& trajectory;
+            std::vector<double> times;
+        };
+
+        // 在切比雪夫节点上取值并做离散余弦变换得到系数
+        void fitCoefficients(const TrajectorySampler& sampler, size_t body,
+            double a, double b, int degree, double* coefficients) {
+            const int n = degree + 1;
+            const double mid = 0.5 * (a + b);
+            const double half = 0.5 * (b - a);
+
+            std::vector<Vector3D> values(n);
+            for (int k = 0; k < n; ++k) {
+                double x = std::cos(PI * (k + 0.5) / n);
+                values[k] = sampler.position(body, mid + half * x);
+            }
+
+            for (int j = 0; j < n; ++j) {
+                Vector3D sum(0, 0, 0);
+                for (int k = 0; k < n; ++k) {
+                    sum = sum + values[k] * std::cos(PI * j * (k + 0.5) / n);
+                }
+                double factor = (j == 0 ? 1.0 : 2.0) / n;
+                coefficients[j] = sum.x * factor;
+                coefficients[n + j] = sum.y * factor;
+                coefficients[2 * n + j] = sum.z * factor;
+            }
+        }
+
+        struct SegmentFitter {
+            const std::vector<Physics::SystemState>& trajectory;
+            const TrajectorySampler& sampler;
+            const EphemerisFitOptions& options;
+            size_t body;
+            BodyEphemeris& out;
+
+            void fitRange(double a, double b, int depth) {
+                const size_t blockSize = 3 * static_cast<size_t>(options.degree + 1);
+                std::vector<double> block(blockSize);
+                fitCoefficients(sampler, body, a, b, options.degree, block.data());
+
+                if (depth < options.maxDepth && !withinTolerance(block.data(), a, b)) {
+                    double mid = 0.5 * (a + b);
+                    fitRange(a, mid, depth + 1);
+                    fitRange(mid, b, depth + 1);
+                    return;
+                }
+
+                if (out.boundaries.empty()) out.boundaries.push_back(a);
+                out.boundaries.push_back(b);
+                out.coefficients.insert(out.coefficients.end(), block.begin(), block.end());
+            }
+
+            // 在区间内所有原始采样点上检查拟合误差
+            bool withinTolerance(const double* block, double a, double b) const {
+                const std::vector<double>& times = sampler.getTimes();
+                double scale = 2.0 / (b - a);
+                size_t i = std::lower_bound(times.begin(), times.end(), a) - times.begin();
+
+                for (; i < times.size() && times[i] <= b; ++i) {
+                    Vector3D pos, vel;
+                    Ephemeris::evaluateSegment(block, options.degree, (times[i] - a) * scale - 1.0, scale, pos, vel);
+
+                    if ((pos - trajectory[i].positions[body]).magnitude() > options.positionTolerance) {
+                        return false;
+                    }
+                    if (options.velocityTolerance > 0.0 &&
+                        (vel - trajectory[i].velocities[body]).magnitude() > options.velocityTolerance) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        };
+
+    } // namespace
+
+    Ephemeris Ephemeris::fit(const std::vector<Physics::SystemState>& trajectory,
+        const std::vector<std::string>& names,
+        const std::vector<double>& masses,
+        const EphemerisFitOptions& options) {
+        if (trajectory.size() < 2) {
+            throw std::invalid_argument("Ephemeris fit needs at least two trajectory samples");
+        }
+        size_t numBodies = trajectory.front().positions.size();
+        if (names.size() != numBodies || masses.size() != numBodies) {
+            throw std::invalid_argument("Ephemeris fit: names/masses do not match body count");
+        }
+        if (options.degree < 1 || options.maxSegmentLength <= 0.0) {
+            throw std::invalid_argument("Ephemeris fit: invalid options");
+        }
+
+        Ephemeris ephemeris;
+        ephemeris.degree = options.degree;
+        ephemeris.startTime = trajectory.front().time;
+        ephemeris.endTime = trajectory.back().time;
+        ephemeris.granule = options.maxSegmentLength;
+
+        double span = ephemeris.endTime - ephemeris.startTime;
+        size_t granules = static_cast<size_t>(std::ceil(span / ephemeris.granule));
+        if (granules == 0) granules = 1;
+
+        TrajectorySampler sampler(trajectory);
+        ephemeris.bodies.resize(numBodies);
+
+        for (size_t body = 0; body < numBodies; ++body) {
+            BodyEphemeris& out = ephemeris.bodies[body];
+            out.name = names[body];
+            out.mass = masses[body];
+            out.granuleIndex.reserve(granules + 1);
+
+            SegmentFitter fitter{ trajectory, sampler, options, body, out };
+            for (size_t g = 0; g < granules; ++g) {
+                double a = ephemeris.startTime + g * ephemeris.granule;
+                double b = std::min(a + ephemeris.granule, ephemeris.endTime);
+                out.granuleIndex.push_back(static_cast<uint32_t>(out.segmentCount()));
+                fitter.fitRange(a, b, 0);
+            }
+            out.granuleIndex.push_back(static_cast<uint32_t>(out.segmentCount()));
+        }
+
+        return ephemeris;
+    }
+
+    size_t Ephemeris::findBody(const std::string& name) const {
+        for (size_t i = 0; i < bodies.size(); ++i) {
+            if (bodies[i].name == name) return i;
+        }
+        throw std::out_of_range("Unknown body in ephemeris: " + name);
+    }
+
+    size_t Ephemeris::findSegment(size_t body, double t) const {
+        if (t < startTime || t > endTime) {
+            throw std::out_of_range("Time outside ephemeris coverage");
+        }
+        const BodyEphemeris& eph = bodies[body];
+        size_t granules = eph.granuleIndex.size() - 1;
+        size_t g = static_cast<size_t>((t - startTime) / granule);
+        if (g >= granules) g = granules - 1;
+
+        size_t lo = eph.granuleIndex[g];
+        size_t hi = eph.granuleIndex[g + 1];
+        auto first = eph.boundaries.begin() + lo + 1;
+        auto last = eph.boundaries.begin() + hi;
+        size_t index = std::upper_bound(first, last, t) - eph.boundaries.begin() - 1;
+        return std::min(std::max(index, lo), hi - 1);
+    }
+
+    void Ephemeris::evaluate(size_t body, double t, Vector3D& position, Vector3D& velocity) const {
+        size_t index = findSegment(body, t);
+        const BodyEphemeris& eph = bodies[body];
+        double a = eph.boundaries[index];
+        double b = eph.boundaries[index + 1];
+        double scale = 2.0 / (b - a);
+        const double* block = eph.coefficients.data() + index * 3 * static_cast<size_t>(degree + 1);
+        evaluateSegment(block, degree, (t - a) * scale - 1.0, scale, position, velocity);
+    }
+
+    void Ephemeris::evaluateAll(double t, Physics::SystemState& state) const {
+        state.positions.resize(bodies.size());
+        state.velocities.resize(bodies.size());
+        for (size_t i = 0; i < bodies.size(); ++i) {
+            evaluate(i, t, state.positions[i], state.velocities[i]);
+        }
+        state.time = t;
+    }
+
+    void Ephemeris::evaluateSegment(const double* coefficients, int degree,
+        double x, double scale, Vector3D& position, Vector3D& velocity) {
+        const int n = degree + 1;
+        const double* cx = coefficients;
+        const double* cy = coefficients + n;
+        const double* cz = coefficients + 2 * n;
+
+        // T_k 与其导数 T_k' 同时递推
+        double tPrev = 1.0, tCur = x;
+        double dPrev = 0.0, dCur = 1.0;
+        double px = cx[0] + cx[1] * x, py = cy[0] + cy[1] * x, pz = cz[0] + cz[1] * x;
+        double vx = cx[1], vy = cy[1], vz = cz[1];
+
+        for (int k = 2; k < n; ++k) {
+            double tNext = 2.0 * x * tCur - tPrev;
+            double dNext = 2.0 * tCur + 2.0 * x * dCur - dPrev;
+            px += cx[k] * tNext; py += cy[k] * tNext; pz += cz[k] * tNext;
+            vx += cx[k] * dNext; vy += cy[k] * dNext; vz += cz[k] * dNext;
+            tPrev = tCur; tCur = tNext;
+            dPrev = dCur; dCur = dNext;
+        }
+
+        position = Vector3D(px, py, pz);
+        velocity = Vector3D(vx * scale, vy * scale, vz * scale);
+    }
+
+    // 文件格式：头部 | 天体表 | 各天体分段边界与粒度索引 | 全部系数
+    void Ephemeris::save(const std::string& path) const {
+        THREEBODY_PHASE(IO);
+        THREEBODY_TRACE_SCOPE("ephemeris_save", "io");
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot open ephemeris file for writing: " + path);
+        }
+
+        uint32_t granules = bodies.empty() ? 0 : static_cast<uint32_t>(bodies.front().granuleIndex.size() - 1);
+
+        out.write(EPHEMERIS_MAGIC, sizeof(EPHEMERIS_MAGIC));
+        writePod(out, EPHEMERIS_VERSION);
+        writePod(out, static_cast<uint32_t>(bodies.size()));
+        writePod(out, static_cast<int32_t>(degree));
+        writePod(out, granules);
+        writePod(out, startTime);
+        writePod(out, endTime);
+        writePod(out, granule);
+
+        for (const BodyEphemeris& body : bodies) {
+            writePod(out, static_cast<uint32_t>(body.name.size()));
+            out.write(body.name.data(), body.name.size());
+            writePod(out, body.mass);
+            writePod(out, static_cast<uint32_t>(body.segmentCount()));
+        }
+        for (const BodyEphemeris& body : bodies) {
+            writeArray(out, body.boundaries);
+            writeArray(out, body.granuleIndex);
+        }
+        for (const BodyEphemeris& body : bodies) {
+            writeArray(out, body.coefficients);
+        }
+
+        if (!out) {
+            throw std::runtime_error("Failed writing ephemeris file: " + path);
+        }
+        THREEBODY_COUNT(BYTES_WRITTEN, out.tellp());
+    }
+
+    Ephemeris Ephemeris::readIndex(std::istream& in, const std::string& path) {
+        char magic[sizeof(EPHEMERIS_MAGIC)];
+        if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, EPHEMERIS_MAGIC, sizeof(magic)) != 0) {
+            throw std::runtime_error("Not an ephemeris file: " + path);
+        }
+        if (readPod<uint32_t>(in) != EPHEMERIS_VERSION) {
+            throw std::runtime_error("Unsupported ephemeris version: " + path);
+        }
+
+        // 文件可能来自用户给出的路径：每个字段先检查再使用，长度与文件剩余字节数比较后才分配
+        const std::streamoff position = in.tellg();
+        in.seekg(0, std::ios::end);
+        const std::streamoff fileSize = in.tellg();
+        in.seekg(position);
+        auto corrupt = [&path](const std::string& what) {
+            return std::runtime_error("Corrupt ephemeris file " + path + ": " + what);
+        };
+        auto ensureBytes = [&](uint64_t count, size_t size) {
+            uint64_t remaining = static_cast<uint64_t>(fileSize - in.tellg());
+            if (count > remaining / size) throw std::runtime_error("Ephemeris file truncated");
+        };
+
+        Ephemeris ephemeris;
+        uint32_t bodyCount = readPod<uint32_t>(in);
+        ephemeris.degree = readPod<int32_t>(in);
+        uint32_t granules = readPod<uint32_t>(in);
+        ephemeris.startTime = readPod<double>(in);
+        ephemeris.endTime = readPod<double>(in);
+        ephemeris.granule = readPod<double>(in);
+        if (ephemeris.degree < 1 || ephemeris.degree > 64) throw corrupt("degree out of range");
+        if (!std::isfinite(ephemeris.granule) || !(ephemeris.granule > 0.0)) throw corrupt("bad granule length");
+        if (!std::isfinite(ephemeris.startTime) || !std::isfinite(ephemeris.endTime) ||
+            !(ephemeris.endTime > ephemeris.startTime)) {
+            throw corrupt("bad time span");
+        }
+        if (granules == 0) throw corrupt("no granules");
+
+        ensureBytes(bodyCount, 2 * sizeof(uint32_t) + sizeof(double));
+        std::vector<uint32_t> segmentCounts(bodyCount);
+        ephemeris.bodies.resize(bodyCount);
+        for (uint32_t i = 0; i < bodyCount; ++i) {
+            BodyEphemeris& body = ephemeris.bodies[i];
+            uint32_t nameLength = readPod<uint32_t>(in);
+            ensureBytes(nameLength, 1);
+            body.name.resize(nameLength);
+            if (!body.name.empty() && !in.read(&body.name[0], body.name.size())) {
+                throw std::runtime_error("Ephemeris file truncated");
+            }
+            body.mass = readPod<double>(in);
+            segmentCounts[i] = readPod<uint32_t>(in);
+            if (segmentCounts[i] == 0) throw corrupt("body without segments");
+        }
+
+        const uint64_t blockBytes = 3 * static_cast<uint64_t>(ephemeris.degree + 1) * sizeof(double);
+        uint64_t coefficientBytes = 0;
+        for (uint32_t i = 0; i < bodyCount; ++i) {
+            BodyEphemeris& body = ephemeris.bodies[i];
+            ensureBytes(static_cast<uint64_t>(segmentCounts[i]) + 1, sizeof(double));
+            readArray(in, body.boundaries, static_cast<size_t>(segmentCounts[i]) + 1);
+            ensureBytes(static_cast<uint64_t>(granules) + 1, sizeof(uint32_t));
+            readArray(in, body.granuleIndex, static_cast<size_t>(granules) + 1);
+
+            // findSegment 直接用这些值做下标：分段边界须有限且递增，
+            // 粒度索引从 0 开始严格递增（每个粒度至少一段）并止于分段数
+            for (size_t k = 0; k < body.boundaries.size(); ++k) {
+                if (!std::isfinite(body.boundaries[k]) || (k > 0 && !(body.boundaries[k] > body.boundaries[k - 1]))) {
+                    throw corrupt("segment boundaries of '" + body.name + "' are not increasing");
+                }
+            }
+            if (body.granuleIndex.front() != 0 || body.granuleIndex.back() != segmentCounts[i]) {
+                throw corrupt("granule index of '" + body.name + "' does not cover its segments");
+            }
+            for (size_t g = 1; g < body.granuleIndex.size(); ++g) {
+                if (body.granuleIndex[g] <= body.granuleIndex[g - 1]) {
+                    throw corrupt("granule index of '" + body.name + "' is not increasing");
+                }
+            }
+            coefficientBytes += segmentCounts[i] * blockBytes;
+        }
+        if (coefficientBytes > static_cast<uint64_t>(fileSize - in.tellg())) {
+            throw std::runtime_error("Ephemeris file truncated");
+        }
+        return ephemeris;
+    }
+
+    Ephemeris Ephemeris::load(const std::string& path) {
+        THREEBODY_PHASE(IO);
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open ephemeris file: " + path);
+        }
+
+        Ephemeris ephemeris = readIndex(in, path);
+        size_t blockSize = 3 * static_cast<size_t>(ephemeris.degree + 1);
+        for (BodyEphemeris& body : ephemeris.bodies) {
+            readArray(in, body.coefficients, body.segmentCount() * blockSize);
+        }
+        return ephemeris;
+    }
+
+    Ephemeris Ephemeris::loadIndex(const std::string& path, uint64_t& coefficientOffset) {
+        THREEBODY_PHASE(IO);
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open ephemeris file: " + path);
+        }
+
+        Ephemeris ephemeris = readIndex(in, path);
+        coefficientOffset = static_cast<uint64_t>(in.tellg());
+        return ephemeris;
+    }
+
+} // namespace Simulation
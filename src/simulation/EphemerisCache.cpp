@@ -0,0 +1,69 @@
+#include "simulation/EphemerisCache.h"
+#include "utils/Instrumentation.h"
+#include "utils/Trace.h"
+#include <stdexcept>
+
+namespace Simulation {
+
+    EphemerisFile::EphemerisFile(const std::string& path)
+        : path(path), stream(path, std::ios::binary) {
+        index = Ephemeris::loadIndex(path, coefficientOffset);
+        if (!stream) {
+            throw std::runtime_error("Cannot open ephemeris file: " + path);
+        }
+
+        uint64_t segments = 0;
+        firstSegment.reserve(index.getBodyCount());
+        for (size_t i = 0; i < index.getBodyCount(); ++i) {
+            firstSegment.push_back(segments);
+            segments += index.getBody(i).segmentCount();
+        }
+    }
+
+    std::vector<double> EphemerisFile::readSegment(size_t body, size_t segment) {
+        size_t blockSize = 3 * static_cast<size_t>(index.getDegree() + 1);
+        uint64_t offset = coefficientOffset + (firstSegment[body] + segment) * blockSize * sizeof(double);
+
+        std::vector<double> block(blockSize);
+        THREEBODY_PHASE(IO);
+        THREEBODY_TRACE_SCOPE("segment_read", "io");
+        std::lock_guard<std::mutex> lock(mutex);
+        stream.seekg(static_cast<std::streamoff>(offset));
+        if (!stream.read(reinterpret_cast<char*>(block.data()), blockSize * sizeof(double))) {
+            stream.clear();
+            throw std::runtime_error("Failed reading ephemeris segment from " + path);
+        }
+        return block;
+    }
+
+    CachedEphemeris::CachedEphemeris(const std::string& path, size_t capacity)
+        : file(path), cache(capacity) {
+    }
+
+    void CachedEphemeris::evaluate(size_t body, double t, Vector3D& position, Vector3D& velocity) {
+        const Ephemeris& index = file.getIndex();
+        size_t segment = index.findSegment(body, t);
+        uint64_t key = (static_cast<uint64_t>(body) << 40) | segment;
+
+        Segment block = cache.getOrLoad(key, [&]() {
+            return std::make_shared<const std::vector<double>>(file.readSegment(body, segment));
+        });
+
+        const BodyEphemeris& eph = index.getBody(body);
+        double a = eph.boundaries[segment];
+        double b = eph.boundaries[segment + 1];
+        double scale = 2.0 / (b - a);
+        Ephemeris::evaluateSegment(block->data(), index.getDegree(), (t - a) * scale - 1.0, scale, position, velocity);
+    }
+
+    void CachedEphemeris::evaluateAll(double t, Physics::SystemState& state) {
+        size_t n = file.getIndex().getBodyCount();
+        state.positions.resize(n);
+        state.velocities.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            evaluate(i, t, state.positions[i], state.velocities[i]);
+        }
+        state.time = t;
+    }
+
+} // namespace Simulation
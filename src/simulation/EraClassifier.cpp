@@ -0,0 +1,107 @@
+﻿#include "simulation/EraClassifier.h"
+#include "utils/Instrumentation.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Simulation {
+
+    namespace {
+        const double PI = 3.14159265358979323846;
+    }
+
+    EraClassifier::EraClassifier(const CalendarConfig& calendar,
+        const std::vector<double>& masses,
+        const EraClassifierConfig& config,
+        EraCallback onChange)
+        : calendar(calendar), config(config), masses(masses), onChange(std::move(onChange)),
+          semiMajorAxis(config.window), eccentricity(config.window), fluxFraction(config.window) {
+        resolveSuns(this->calendar, masses);
+        if (!(config.hysteresis >= 1.0)) {
+            throw std::invalid_argument("Era hysteresis must be at least 1");
+        }
+        distances.assign(this->calendar.sunIndices.size(), Utils::SlidingStats(config.window));
+    }
+
+    bool EraClassifier::push(const Physics::SystemState& state) {
+        THREEBODY_PHASE(EVENTS);
+        if (steps == 0) firstTime = state.time;
+        ++steps;
+
+        const Vector3D& planetPos = state.positions[calendar.planetIndex];
+        double totalFlux = 0.0;
+        double dominantFlux = -1.0;
+        size_t brightest = 0;
+        for (size_t k = 0; k < calendar.sunIndices.size(); ++k) {
+            double d2 = (state.positions[calendar.sunIndices[k]] - planetPos).magnitudeSquared();
+            distances[k].push(std::sqrt(d2));
+            double flux = calendar.luminosities[k] / (4.0 * PI * d2);
+            totalFlux += flux;
+            if (flux > dominantFlux) {
+                dominantFlux = flux;
+                brightest = calendar.sunIndices[k];
+            }
+        }
+        fluxFraction.push(totalFlux > 0.0 ? dominantFlux / totalFlux : 0.0);
+
+        // 轨道根数只对同一颗主恒星有意义，换主恒星时重新累计
+        if (!hasDominant || brightest != dominant) {
+            dominant = brightest;
+            hasDominant = true;
+            semiMajorAxis.clear();
+            eccentricity.clear();
+        }
+
+        // 绕主恒星的密切半长轴与偏心率
+        Vector3D r = planetPos - state.positions[dominant];
+        Vector3D v = state.velocities[calendar.planetIndex] - state.velocities[dominant];
+        double mu = PhysicsConstants::G * (masses[dominant] + masses[calendar.planetIndex]);
+        double distance = r.magnitude();
+        double speed2 = v.magnitudeSquared();
+        double energy = 0.5 * speed2 - mu / distance;
+        Vector3D e = (r * (speed2 - mu / distance) - v * r.dot(v)) / mu;
+        // 非束缚时半长轴无意义，以当前距离代替；此时偏心率不小于 1，窗口必然判为乱纪元
+        semiMajorAxis.push(energy < 0.0 ? -mu / (2.0 * energy) : distance);
+        eccentricity.push(energy < 0.0 ? e.magnitude() : std::max(e.magnitude(), 1.0));
+
+        if (!ready) {
+            if (!fluxFraction.full()) return false;
+            ready = true;
+            emit(firstTime, windowIsStable(1.0) ? EraType::STABLE : EraType::CHAOTIC);
+            return true;
+        }
+
+        if (era == EraType::STABLE && !windowIsStable(config.hysteresis)) {
+            emit(state.time, EraType::CHAOTIC);
+            return true;
+        }
+        if (era == EraType::CHAOTIC && windowIsStable(1.0)) {
+            emit(state.time, EraType::STABLE);
+            return true;
+        }
+        return false;
+    }
+
+    bool EraClassifier::windowIsStable(double relax) const {
+        if (!semiMajorAxis.full()) return false;
+        double minFraction = 1.0 - (1.0 - calendar.stableFluxFraction) * relax;
+        double maxEccentricity = std::min(config.maxEccentricity * relax, 1.0);
+        double maxSpread = config.maxSemiMajorSpread * relax * std::fabs(semiMajorAxis.mean());
+        return fluxFraction.min() >= minFraction &&
+            eccentricity.max() < maxEccentricity &&
+            semiMajorAxis.stddev() <= maxSpread;
+    }
+
+    void EraClassifier::emit(double time, EraType newEra) {
+        era = newEra;
+        lastChange = time;
+        if (onChange) {
+            CalendarEvent event;
+            event.time = time;
+            event.type = CalendarEventType::ERA_CHANGE;
+            event.era = newEra;
+            onChange(event);
+        }
+    }
+
+} // namespace Simulation
@@ -0,0 +1,282 @@
+﻿#include "simulation/IncrementalCalendar.h"
+#include "utils/Instrumentation.h"
+#include "utils/Trace.h"
+#include "simulation/Trajectory.h"
+#include "physics/GravityEngine.h"
+#include "utils/BinaryIO.h"
+#include "utils/AtomicFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace Simulation {
+
+    using Utils::writePod;
+    using Utils::writeArray;
+    using Utils::readPod;
+    using Utils::readArray;
+
+    namespace {
+        const char CALENDAR_CACHE_MAGIC[8] = { 'T', 'B', 'C', 'C', 'A', 'L', '0', '1' };
+        const uint32_t CALENDAR_CACHE_VERSION = 3;
+        const char CALENDAR_EVENTS_MAGIC[8] = { 'T', 'B', 'C', 'E', 'V', 'T', '0', '1' };
+        const size_t CALENDAR_EVENTS_HEADER_BYTES = sizeof(CALENDAR_EVENTS_MAGIC) + sizeof(uint64_t);
+        const size_t CALENDAR_EVENT_BYTES = sizeof(double) + 3 * sizeof(int32_t);
+
+        void writeEvent(std::ostream& out, const CalendarEvent& e) {
+            writePod(out, e.time);
+            writePod(out, static_cast<int32_t>(e.type));
+            writePod(out, static_cast<uint32_t>(e.body));
+            writePod(out, static_cast<int32_t>(e.era));
+        }
+
+        void readEvent(std::istream& in, CalendarEvent& e) {
+            e.time = readPod<double>(in);
+            e.type = static_cast<CalendarEventType>(readPod<int32_t>(in));
+            e.body = readPod<uint32_t>(in);
+            e.era = static_cast<EraType>(readPod<int32_t>(in));
+        }
+
+        // 影响积分结果或事件判定的全部输入
+        uint64_t calendarFingerprint(const Physics::SystemState& initial, const std::vector<double>& masses,
+            const CalendarConfig& config, double timeStep, Physics::Integrator::Method method) {
+            std::ostringstream bytes;
+            auto number = [&bytes](double v) { writePod(bytes, v); };
+            auto index = [&bytes](size_t v) { writePod(bytes, static_cast<uint64_t>(v)); };
+            index(masses.size());
+            for (double m : masses) number(m);
+            number(initial.time);
+            for (size_t i = 0; i < initial.positions.size(); ++i) {
+                const Vector3D& r = initial.positions[i];
+                const Vector3D& v = initial.velocities[i];
+                number(r.x); number(r.y); number(r.z);
+                number(v.x); number(v.y); number(v.z);
+            }
+            index(config.planetIndex);
+            index(config.sunIndices.size());
+            for (size_t sun : config.sunIndices) index(sun);
+            index(config.luminosities.size());
+            for (double l : config.luminosities) number(l);
+            number(config.rotationPeriod);
+            number(config.rotationPhase);
+            writePod(bytes, static_cast<int32_t>(config.scanStepsPerRotation));
+            number(config.eraScanStep);
+            number(config.timeTolerance);
+            number(config.stableFluxFraction);
+            number(timeStep);
+            writePod(bytes, static_cast<int32_t>(method));
+            return Utils::hashBytes(bytes.str());
+        }
+    }
+
+    IncrementalCalendar::IncrementalCalendar(const Physics::SystemState& initial,
+        const std::vector<double>& masses,
+        const CalendarConfig& config,
+        double timeStep,
+        Physics::Integrator::Method method,
+        const std::string& cachePath)
+        : masses(masses), config(config), timeStep(timeStep), method(method), cachePath(cachePath),
+        chunkLength(30.0 * PhysicsConstants::DAY_SECONDS), lastState(initial),
+        calculator(config, masses,
+            [this](double t, Physics::SystemState& state) { interpolateTrajectory(chunk, t, state); }) {
+        if (timeStep <= 0.0) {
+            throw std::invalid_argument("IncrementalCalendar needs a positive time step");
+        }
+        initialEra = calculator.classify(initial);
+        fingerprint = calendarFingerprint(initial, masses, config, timeStep, method);
+        if (!cachePath.empty()) {
+            load(cachePath);
+        }
+    }
+
+    std::vector<CalendarEvent> IncrementalCalendar::generate(double t0, double t1) {
+        extendTo(t1);
+
+        auto first = std::lower_bound(events.begin(), events.end(), t0,
+            [](const CalendarEvent& e, double t) { return e.time < t; });
+        auto last = std::upper_bound(events.begin(), events.end(), t1,
+            [](double t, const CalendarEvent& e) { return t < e.time; });
+        return std::vector<CalendarEvent>(first, last);
+    }
+
+    EraType IncrementalCalendar::eraAt(double t) const {
+        auto next = std::upper_bound(eraChanges.begin(), eraChanges.end(), t,
+            [](double time, const CalendarEvent& e) { return time < e.time; });
+        return next == eraChanges.begin() ? initialEra : std::prev(next)->era;
+    }
+
+    void IncrementalCalendar::indexEras(size_t first) {
+        for (size_t i = first; i < events.size(); ++i) {
+            if (events[i].type == CalendarEventType::ERA_CHANGE) eraChanges.push_back(events[i]);
+        }
+    }
+
+    void IncrementalCalendar::extendTo(double t) {
+        if (lastState.time >= t) return;
+        while (lastState.time < t) {
+            extendChunk(std::min(t, lastState.time + chunkLength));
+        }
+        if (!cachePath.empty()) {
+            save(cachePath);
+        }
+    }
+
+    void IncrementalCalendar::extendChunk(double t) {
+        Physics::DerivativeFunction derivFunc = [this](const Physics::SystemState& s, Physics::SystemState& d) {
+            Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        };
+
+        chunk.clear();
+        chunk.push_back(lastState);
+
+        Physics::SystemState state = lastState;
+        Physics::Integrator integrator(method);
+        integrator.restoreState(integratorState);
+        while (state.time < t) {
+            integrator.step(state, derivFunc, timeStep);
+            state.time += timeStep;
+            chunk.push_back(state);
+            ++stepsIntegrated;
+        }
+        integratorState = integrator.captureState();
+
+        // 只对新积分的区间计算事件
+        std::vector<CalendarEvent> fresh = calculator.generate(lastState.time, state.time);
+        const size_t first = events.size();
+        events.insert(events.end(), fresh.begin(), fresh.end());
+        indexEras(first);
+        lastState = state;
+        chunk.clear();
+    }
+
+    // 状态文件：头部（含输入指纹）| 末状态 | 积分器状态 | 事件数
+    // 事件文件：头部（含输入指纹）| 事件，只追加
+    // 先把新事件写到事件文件末尾，再用临时文件原子替换状态文件。中途中断时状态文件仍是旧的，
+    // 其事件数之后多写的部分在加载时被忽略、下次保存时被覆盖，不会留下不一致的缓存
+    void IncrementalCalendar::save(const std::string& path) const {
+        THREEBODY_PHASE(IO);
+        THREEBODY_TRACE_SCOPE("calendar_cache_save", "io");
+
+        const std::string eventsPath = path + ".events";
+        size_t first = path == syncedPath ? syncedEvents : 0;
+        {
+            std::fstream out;
+            if (first > 0) {
+                out.open(eventsPath, std::ios::binary | std::ios::in | std::ios::out);
+                if (out) out.seekp(static_cast<std::streamoff>(CALENDAR_EVENTS_HEADER_BYTES + first * CALENDAR_EVENT_BYTES));
+                else first = 0;  // 事件文件被删掉了：整份重写
+            }
+            if (first == 0) {
+                out.clear();
+                out.open(eventsPath, std::ios::binary | std::ios::out | std::ios::trunc);
+                if (!out) {
+                    throw std::runtime_error("Cannot open calendar events for writing: " + eventsPath);
+                }
+                out.write(CALENDAR_EVENTS_MAGIC, sizeof(CALENDAR_EVENTS_MAGIC));
+                writePod(out, fingerprint);
+            }
+            for (size_t i = first; i < events.size(); ++i) {
+                writeEvent(out, events[i]);
+            }
+            out.flush();
+            if (!out) {
+                throw std::runtime_error("Failed writing calendar events: " + eventsPath);
+            }
+            THREEBODY_COUNT(BYTES_WRITTEN, (events.size() - first) * CALENDAR_EVENT_BYTES);
+        }
+
+        const std::string temp = path + ".tmp";
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot open calendar cache for writing: " + temp);
+        }
+
+        out.write(CALENDAR_CACHE_MAGIC, sizeof(CALENDAR_CACHE_MAGIC));
+        writePod(out, CALENDAR_CACHE_VERSION);
+        writePod(out, fingerprint);
+        writePod(out, static_cast<uint32_t>(lastState.positions.size()));
+        writePod(out, static_cast<int32_t>(initialEra));
+
+        writePod(out, lastState.time);
+        writeArray(out, lastState.positions);
+        writeArray(out, lastState.velocities);
+
+        writePod(out, static_cast<uint32_t>(integratorState.previousPositions.size()));
+        writeArray(out, integratorState.previousPositions);
+
+        writePod(out, static_cast<uint64_t>(events.size()));
+
+        if (!out) {
+            throw std::runtime_error("Failed writing calendar cache: " + temp);
+        }
+        THREEBODY_COUNT(BYTES_WRITTEN, out.tellp());
+        out.close();
+        if (!Utils::replaceFile(temp, path)) {
+            throw std::runtime_error("Cannot replace calendar cache: " + path);
+        }
+        syncedPath = path;
+        syncedEvents = events.size();
+    }
+
+    bool IncrementalCalendar::load(const std::string& path) {
+        THREEBODY_PHASE(IO);
+        std::ifstream in(path, std::ios::binary);
+        std::ifstream eventsIn(path + ".events", std::ios::binary | std::ios::ate);
+        if (!in || !eventsIn) return false;
+        const std::streamoff eventsSize = eventsIn.tellg();
+        eventsIn.seekg(0);
+
+        // 损坏、截断或属于其他输入的缓存都视为没有缓存
+        EraType savedEra;
+        Physics::SystemState savedState;
+        Physics::IntegratorState savedIntegrator;
+        std::vector<CalendarEvent> savedEvents;
+        try {
+            char magic[sizeof(CALENDAR_CACHE_MAGIC)];
+            if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, CALENDAR_CACHE_MAGIC, sizeof(magic)) != 0 ||
+                readPod<uint32_t>(in) != CALENDAR_CACHE_VERSION || readPod<uint64_t>(in) != fingerprint) {
+                return false;
+            }
+            const uint32_t numBodies = readPod<uint32_t>(in);
+            if (numBodies != lastState.positions.size()) return false;
+
+            savedEra = static_cast<EraType>(readPod<int32_t>(in));
+            savedState.time = readPod<double>(in);
+            readArray(in, savedState.positions, numBodies);
+            readArray(in, savedState.velocities, numBodies);
+
+            // 计数来自文件，分配前先核对
+            const uint32_t previousCount = readPod<uint32_t>(in);
+            if (previousCount != 0 && previousCount != numBodies) return false;
+            readArray(in, savedIntegrator.previousPositions, previousCount);
+
+            // 事件文件可能比事件数长（上次追加后未及替换状态文件），只读前 eventCount 个
+            const uint64_t eventCount = readPod<uint64_t>(in);
+            if (!eventsIn.read(magic, sizeof(magic)) || std::memcmp(magic, CALENDAR_EVENTS_MAGIC, sizeof(magic)) != 0 ||
+                readPod<uint64_t>(eventsIn) != fingerprint) {
+                return false;
+            }
+            if (eventCount > static_cast<uint64_t>(eventsSize - eventsIn.tellg()) / CALENDAR_EVENT_BYTES) return false;
+            savedEvents.resize(static_cast<size_t>(eventCount));
+            for (CalendarEvent& e : savedEvents) {
+                readEvent(eventsIn, e);
+            }
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+
+        initialEra = savedEra;
+        lastState = savedState;
+        integratorState = savedIntegrator;
+        events.swap(savedEvents);
+        eraChanges.clear();
+        indexEras(0);
+        syncedPath = path;
+        syncedEvents = events.size();
+        return true;
+    }
+
+} // namespace Simulation
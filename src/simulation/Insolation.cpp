@@ -0,0 +1,203 @@
+﻿#include "simulation/Insolation.h"
+#include "utils/BinaryIO.h"
+#include "utils/Instrumentation.h"
+#include "utils/ThreadPool.h"
+#include "utils/Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <future>
+#include <ostream>
+#include <stdexcept>
+
+namespace Simulation {
+
+    namespace {
+        const double PI = 3.14159265358979323846;
+        const char INSOLATION_MAGIC[8] = { 'T', 'B', 'C', 'I', 'N', 'S', '0', '1' };
+    }
+
+    InsolationTimeline::InsolationTimeline(const CalendarConfig& config,
+        const std::vector<double>& masses,
+        const InsolationOptions& options,
+        StateProvider provider)
+        : config(config), options(options), provider(std::move(provider)) {
+        resolveSuns(this->config, masses);
+        if (!(options.outputStep > 0.0)) {
+            throw std::invalid_argument("Insolation output step must be positive");
+        }
+        if (!(options.endTime >= options.startTime)) {
+            throw std::invalid_argument("Insolation end time precedes start time");
+        }
+        if (options.chunkSamples == 0) {
+            throw std::invalid_argument("Insolation chunk size must be positive");
+        }
+        // 容许 endTime 恰为网格点时的舍入误差
+        samples = static_cast<size_t>(std::floor((options.endTime - options.startTime) / options.outputStep + 1e-9)) + 1;
+    }
+
+    size_t InsolationTimeline::chunkCount() const {
+        return (samples + options.chunkSamples - 1) / options.chunkSamples;
+    }
+
+    void InsolationTimeline::computeChunk(size_t firstSample, size_t count, InsolationChunk& chunk) const {
+        THREEBODY_PHASE(EVENTS);
+        firstSample = std::min(firstSample, samples);
+        count = std::min(count, samples - firstSample);
+        const size_t numSuns = config.sunIndices.size();
+
+        chunk.firstSample = firstSample;
+        chunk.sampleCount = count;
+        chunk.sunCount = numSuns;
+        chunk.time.resize(count);
+        chunk.totalFlux.assign(count, 0.0);
+        chunk.distance.resize(numSuns * count);
+        chunk.flux.resize(numSuns * count);
+        chunk.phaseAngle.resize(numSuns * count);
+
+        // 第一遍逐样本取状态，行星指向各恒星的矢量三个分量暂存在 distance / flux / phaseAngle 中
+        double* dx = chunk.distance.data();
+        double* dy = chunk.flux.data();
+        double* dz = chunk.phaseAngle.data();
+        Physics::SystemState state;
+        for (size_t i = 0; i < count; ++i) {
+            double t = sampleTime(firstSample + i);
+            chunk.time[i] = t;
+            provider(t, state);
+            const Vector3D& planet = state.positions[config.planetIndex];
+            for (size_t k = 0; k < numSuns; ++k) {
+                Vector3D d = state.positions[config.sunIndices[k]] - planet;
+                dx[k * count + i] = d.x;
+                dy[k * count + i] = d.y;
+                dz[k * count + i] = d.z;
+            }
+        }
+
+        // 第二遍按恒星对整块样本做连续的逐元素运算，原地换成输出量
+        for (size_t k = 0; k < numSuns; ++k) {
+            const double fluxScale = config.luminosities[k] / (4.0 * PI);
+            double* distance = dx + k * count;
+            double* flux = dy + k * count;
+            double* phase = dz + k * count;
+            double* total = chunk.totalFlux.data();
+            for (size_t i = 0; i < count; ++i) {
+                double x = distance[i], y = flux[i], z = phase[i];
+                double d2 = x * x + y * y + z * z;
+                distance[i] = std::sqrt(d2);
+                flux[i] = fluxScale / d2;
+                total[i] += flux[i];
+                phase[i] = std::atan2(y, x);
+            }
+        }
+    }
+
+    void InsolationTimeline::generate(const ChunkSink& sink, Utils::ThreadPool* pool) const {
+        THREEBODY_TRACE_SCOPE("insolation_generate", "analysis");
+        const size_t chunks = chunkCount();
+        const size_t chunkSize = options.chunkSamples;
+
+        if (pool == nullptr) {
+            InsolationChunk chunk;
+            for (size_t c = 0; c < chunks; ++c) {
+                computeChunk(c * chunkSize, chunkSize, chunk);
+                sink(chunk);
+            }
+            return;
+        }
+
+        // 环形缓冲：块 c 写出后，其缓冲区立即用于计算块 c + window
+        size_t window = options.chunksInFlight > 0 ? options.chunksInFlight : 2 * std::max<size_t>(pool->size(), 1);
+        window = std::min(window, chunks);
+        std::vector<InsolationChunk> buffers(window);
+        std::vector<std::future<void>> pending(window);
+        auto launch = [&](size_t c) {
+            InsolationChunk* target = &buffers[c % window];
+            pending[c % window] = pool->submit([this, c, chunkSize, target]() {
+                computeChunk(c * chunkSize, chunkSize, *target);
+            });
+        };
+
+        for (size_t c = 0; c < window; ++c) launch(c);
+        try {
+            for (size_t c = 0; c < chunks; ++c) {
+                pending[c % window].get();
+                sink(buffers[c % window]);
+                if (c + window < chunks) launch(c + window);
+            }
+        }
+        catch (...) {
+            // 缓冲区随本函数销毁，须等仍在计算的块结束后再抛出
+            for (std::future<void>& f : pending) {
+                if (f.valid()) f.wait();
+            }
+            throw;
+        }
+    }
+
+    InsolationWriter::InsolationWriter(std::ostream& out, InsolationFormat format,
+        const std::vector<std::string>& sunNames)
+        : out(out), format(format), sunCount(sunNames.size()) {
+        if (format == InsolationFormat::CSV) {
+            out << "time,total_flux";
+            for (const std::string& name : sunNames) {
+                out << ',' << name << "_distance," << name << "_flux," << name << "_phase";
+            }
+            out << '\n';
+        } else {
+            out.write(INSOLATION_MAGIC, sizeof(INSOLATION_MAGIC));
+            Utils::writePod(out, static_cast<uint32_t>(sunCount));
+            for (const std::string& name : sunNames) {
+                Utils::writePod(out, static_cast<uint32_t>(name.size()));
+                out.write(name.data(), name.size());
+            }
+        }
+    }
+
+    void InsolationWriter::operator()(const InsolationChunk& chunk) {
+        THREEBODY_PHASE(IO);
+        if (chunk.sunCount != sunCount) {
+            throw std::invalid_argument("Insolation chunk does not match writer sun count");
+        }
+        const size_t n = chunk.sampleCount;
+        if (format == InsolationFormat::CSV) {
+            // 整块格式化到文本缓冲区后一次写出，省去逐个数值经过 ostream 的开销
+            text.clear();
+            char field[32];
+            auto append = [&](double value, char separator) {
+                int length = std::snprintf(field, sizeof(field), "%.10g", value);
+                text.append(field, static_cast<size_t>(length));
+                text.push_back(separator);
+            };
+            for (size_t i = 0; i < n; ++i) {
+                append(chunk.time[i], ',');
+                append(chunk.totalFlux[i], sunCount == 0 ? '\n' : ',');
+                for (size_t k = 0; k < sunCount; ++k) {
+                    append(chunk.distanceOf(k, i), ',');
+                    append(chunk.fluxOf(k, i), ',');
+                    append(chunk.phaseOf(k, i), k + 1 == sunCount ? '\n' : ',');
+                }
+            }
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+            THREEBODY_COUNT(BYTES_WRITTEN, text.size());
+        } else {
+            // 转置为逐行存放后一次写出
+            const size_t width = 2 + 3 * sunCount;
+            buffer.resize(n * width);
+            for (size_t i = 0; i < n; ++i) {
+                double* row = &buffer[i * width];
+                row[0] = chunk.time[i];
+                row[1] = chunk.totalFlux[i];
+                for (size_t k = 0; k < sunCount; ++k) {
+                    row[2 + 3 * k] = chunk.distanceOf(k, i);
+                    row[3 + 3 * k] = chunk.fluxOf(k, i);
+                    row[4 + 3 * k] = chunk.phaseOf(k, i);
+                }
+            }
+            Utils::writeArray(out, buffer);
+            THREEBODY_COUNT(BYTES_WRITTEN, buffer.size() * sizeof(double));
+        }
+        if (!out) throw std::runtime_error("Failed to write insolation timeline");
+        rows += n;
+    }
+
+} // namespace Simulation
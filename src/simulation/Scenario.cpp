@@ -0,0 +1,457 @@
+﻿#include "simulation/Scenario.h"
+#include "physics/GravityEngine.h"
+#include "utils/Json.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace Simulation {
+
+    using Utils::JsonValue;
+
+    namespace {
+
+        Vector3D readVector(const JsonValue& value, const std::string& what) {
+            if (!value.isArray() || value.size() != 3) {
+                throw std::runtime_error(what + " must be an array of three numbers");
+            }
+            return Vector3D(value[0].asNumber(), value[1].asNumber(), value[2].asNumber());
+        }
+
+        ScenarioBody readBody(const JsonValue& value) {
+            ScenarioBody body;
+            body.name = value.stringOr("name", "");
+            body.mass = value.at("mass").asNumber();
+            body.radius = value.numberOr("radius", 0.0);
+            if (const JsonValue* p = value.find("position")) body.position = readVector(*p, "position");
+            if (const JsonValue* v = value.find("velocity")) body.velocity = readVector(*v, "velocity");
+            return body;
+        }
+
+        ScenarioSink readSink(const JsonValue& value) {
+            ScenarioSink sink;
+            std::string type = value.at("type").asString();
+            if (type == "trajectory_csv") sink.type = ScenarioSink::TRAJECTORY_CSV;
+            else if (type == "final_state_json") sink.type = ScenarioSink::FINAL_STATE_JSON;
+            else throw std::runtime_error("Unknown output type '" + type + "'");
+            sink.path = value.at("path").asString();
+            double every = value.numberOr("every", 1.0);
+            if (every < 1.0) throw std::runtime_error("Output 'every' must be at least 1");
+            sink.every = static_cast<size_t>(every);
+            return sink;
+        }
+
+        // 把对象中出现的字段覆盖到 scenario 上（defaults 与场景本身共用）
+        void applyFields(const JsonValue& object, Scenario& scenario) {
+            if (!object.isObject()) throw std::runtime_error("Scenario must be a JSON object");
+            if (const JsonValue* v = object.find("name")) scenario.name = v->asString();
+            if (const JsonValue* v = object.find("integrator")) ScenarioLoader::parseMethod(v->asString(), scenario);
+            if (const JsonValue* v = object.find("step")) scenario.timeStep = v->asNumber();
+            if (const JsonValue* v = object.find("duration")) scenario.duration = v->asNumber();
+            if (const JsonValue* t = object.find("tolerance")) {
+                Physics::AdaptiveOptions& o = scenario.tolerances;
+                o.relativeTolerance = t->numberOr("relative", o.relativeTolerance);
+                o.absoluteTolerance = t->numberOr("absolute", o.absoluteTolerance);
+                o.initialStep = t->numberOr("initial_step", o.initialStep);
+                o.minStep = t->numberOr("min_step", o.minStep);
+                o.maxStep = t->numberOr("max_step", o.maxStep);
+            }
+            if (const JsonValue* v = object.find("ejection")) {
+                const std::string& mode = v->asString();
+                if (mode == "none") scenario.ejection = EjectionMode::NONE;
+                else if (mode == "stop") scenario.ejection = EjectionMode::STOP;
+                else if (mode == "analytic") scenario.ejection = EjectionMode::ANALYTIC;
+                else throw std::runtime_error("Unknown ejection mode: " + mode);
+            }
+            scenario.ejectionCriteria.distanceFactor = object.numberOr("ejection_factor", scenario.ejectionCriteria.distanceFactor);
+            if (const JsonValue* bodies = object.find("bodies")) {
+                scenario.bodies.clear();
+                scenario.bodies.reserve(bodies->size());
+                for (size_t i = 0; i < bodies->size(); ++i) scenario.bodies.push_back(readBody((*bodies)[i]));
+            }
+            if (const JsonValue* outputs = object.find("outputs")) {
+                scenario.sinks.clear();
+                for (size_t i = 0; i < outputs->size(); ++i) scenario.sinks.push_back(readSink((*outputs)[i]));
+            }
+        }
+
+        void validate(Scenario& scenario, size_t index) {
+            if (scenario.name.empty()) scenario.name = "scenario" + std::to_string(index);
+            const std::string where = "Scenario '" + scenario.name + "': ";
+            if (scenario.bodies.empty()) throw std::runtime_error(where + "no bodies");
+            for (size_t i = 0; i < scenario.bodies.size(); ++i) {
+                ScenarioBody& body = scenario.bodies[i];
+                if (body.name.empty()) body.name = "body" + std::to_string(i);
+                if (!(body.mass >= 0.0) || !(body.radius >= 0.0)) {
+                    throw std::runtime_error(where + "body '" + body.name + "' has a negative mass or radius");
+                }
+            }
+            if (!(scenario.duration > 0.0)) throw std::runtime_error(where + "duration must be positive");
+            if (!scenario.adaptive && !(scenario.timeStep > 0.0)) throw std::runtime_error(where + "step must be positive");
+            if (scenario.adaptive && scenario.ejection != EjectionMode::NONE) {
+                throw std::runtime_error(where + "ejection handling needs a fixed-step integrator");
+            }
+            if (!(scenario.ejectionCriteria.distanceFactor >= 1.0)) throw std::runtime_error(where + "ejection_factor must be at least 1");
+
+            // 输出路径中的 {name} 换成场景名（defaults 中的输出靠它区分各场景的文件）
+            const std::string placeholder = "{name}";
+            for (ScenarioSink& sink : scenario.sinks) {
+                for (size_t at = sink.path.find(placeholder); at != std::string::npos;
+                    at = sink.path.find(placeholder, at + scenario.name.size())) {
+                    sink.path.replace(at, placeholder.size(), scenario.name);
+                }
+            }
+        }
+
+        // 场景会并行运行，两个输出写同一个文件会互相破坏
+        void checkDistinctOutputs(const std::vector<Scenario>& scenarios) {
+            std::vector<std::pair<std::string, const std::string*>> paths;
+            for (const Scenario& scenario : scenarios) {
+                for (const ScenarioSink& sink : scenario.sinks) paths.emplace_back(sink.path, &scenario.name);
+            }
+            std::sort(paths.begin(), paths.end());
+            for (size_t i = 1; i < paths.size(); ++i) {
+                if (paths[i].first != paths[i - 1].first) continue;
+                throw std::runtime_error("Scenarios '" + *paths[i - 1].second + "' and '" + *paths[i].second +
+                    "' write the same output file '" + paths[i].first + "'; use {name} in output paths given in defaults");
+            }
+        }
+
+        // CSV 的一个字段：指向原文的区间，不复制
+        struct Field {
+            const char* begin = nullptr;
+            const char* end = nullptr;
+
+            std::string_view view() const { return std::string_view(begin, static_cast<size_t>(end - begin)); }
+        };
+
+        void trim(Field& f) {
+            while (f.begin < f.end && (*f.begin == ' ' || *f.begin == '\t')) ++f.begin;
+            while (f.end > f.begin && (f.end[-1] == ' ' || f.end[-1] == '\t' || f.end[-1] == '\r')) --f.end;
+        }
+
+        // 把一行切成字段，复用 fields 的存储
+        void splitLine(const char* begin, const char* end, std::vector<Field>& fields) {
+            fields.clear();
+            const char* start = begin;
+            for (const char* p = begin; ; ++p) {
+                if (p == end || *p == ',') {
+                    Field f{ start, p };
+                    trim(f);
+                    fields.push_back(f);
+                    if (p == end) break;
+                    start = p + 1;
+                }
+            }
+        }
+
+        enum CsvColumn { COL_SCENARIO, COL_NAME, COL_MASS, COL_X, COL_Y, COL_Z, COL_VX, COL_VY, COL_VZ,
+            COL_RADIUS, COL_METHOD, COL_STEP, COL_DURATION, COL_RTOL, COL_ATOL, COL_COUNT };
+        const char* const CSV_COLUMN_NAMES[COL_COUNT] = { "scenario", "name", "mass", "x", "y", "z", "vx", "vy", "vz",
+            "radius", "method", "step", "duration", "rtol", "atol" };
+        const int CSV_REQUIRED_COLUMNS = COL_VZ + 1;
+
+        void writeVector(std::ostream& out, const Vector3D& v) {
+            out << v.x << ',' << v.y << ',' << v.z;
+        }
+
+        JsonValue vectorJson(const Vector3D& v) {
+            JsonValue array = JsonValue::array();
+            array.push(v.x);
+            array.push(v.y);
+            array.push(v.z);
+            return array;
+        }
+
+    } // namespace
+
+    Physics::SystemState Scenario::initialState() const {
+        Physics::SystemState state(bodies.size());
+        for (size_t i = 0; i < bodies.size(); ++i) {
+            state.positions[i] = bodies[i].position;
+            state.velocities[i] = bodies[i].velocity;
+        }
+        return state;
+    }
+
+    std::vector<double> Scenario::masses() const {
+        std::vector<double> m(bodies.size());
+        for (size_t i = 0; i < bodies.size(); ++i) m[i] = bodies[i].mass;
+        return m;
+    }
+
+    void ScenarioLoader::parseMethod(const std::string& name, Scenario& scenario) {
+        scenario.adaptive = false;
+        if (name == "euler") scenario.method = Physics::Integrator::EULER;
+        else if (name == "rk4") scenario.method = Physics::Integrator::RUNGE_KUTTA_4;
+        else if (name == "verlet") scenario.method = Physics::Integrator::VERLET;
+        else if (name == "dopri45") scenario.method = Physics::Integrator::DORMAND_PRINCE_45;
+        else if (name == "adaptive") {
+            scenario.method = Physics::Integrator::DORMAND_PRINCE_45;
+            scenario.adaptive = true;
+        }
+        else throw std::runtime_error("Unknown integrator '" + name + "'");
+    }
+
+    std::vector<Scenario> ScenarioLoader::loadFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open scenario file: " + path);
+        }
+        std::ostringstream buffer;
+        buffer << in.rdbuf();
+        std::string text = buffer.str();
+        if (text.size() >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0) text.erase(0, 3);
+
+        bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+        try {
+            return csv ? parseCsv(text) : parseJson(text);
+        }
+        catch (const std::runtime_error& e) {
+            throw std::runtime_error(path + ": " + e.what());
+        }
+    }
+
+    std::vector<Scenario> ScenarioLoader::parseJson(const std::string& text) {
+        JsonValue document = JsonValue::parse(text);
+        std::vector<Scenario> scenarios;
+
+        const JsonValue* list = document.isObject() ? document.find("scenarios") : nullptr;
+        if (list == nullptr) {
+            Scenario scenario;
+            applyFields(document, scenario);
+            validate(scenario, 0);
+            scenarios.push_back(std::move(scenario));
+            checkDistinctOutputs(scenarios);
+            return scenarios;
+        }
+
+        Scenario defaults;
+        if (const JsonValue* d = document.find("defaults")) applyFields(*d, defaults);
+        scenarios.reserve(list->size());
+        for (size_t i = 0; i < list->size(); ++i) {
+            Scenario scenario = defaults;
+            applyFields((*list)[i], scenario);
+            validate(scenario, i);
+            scenarios.push_back(std::move(scenario));
+        }
+        checkDistinctOutputs(scenarios);
+        return scenarios;
+    }
+
+    Scenario ScenarioLoader::fromJson(const JsonValue& object) {
+        Scenario scenario;
+        applyFields(object, scenario);
+        validate(scenario, 0);
+        return scenario;
+    }
+
+    std::vector<Scenario> ScenarioLoader::parseCsv(const std::string& text) {
+        std::vector<Scenario> scenarios;
+        std::vector<Field> fields;
+        int columns[COL_COUNT];
+        bool haveHeader = false;
+        size_t lineNumber = 0;
+
+        auto fail = [&lineNumber](const std::string& message) {
+            throw std::runtime_error("CSV line " + std::to_string(lineNumber) + ": " + message);
+        };
+        auto number = [&](CsvColumn column, double fallback) {
+            if (columns[column] < 0 || fields[columns[column]].begin == fields[columns[column]].end) return fallback;
+            const Field& f = fields[columns[column]];
+            char* end = nullptr;
+            double value = std::strtod(f.begin, &end);
+            if (end != f.end) fail(std::string("malformed number in column '") + CSV_COLUMN_NAMES[column] + "'");
+            return value;
+        };
+
+        const char* p = text.c_str();
+        const char* textEnd = p + text.size();
+        while (p < textEnd) {
+            const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(textEnd - p)));
+            if (lineEnd == nullptr) lineEnd = textEnd;
+            ++lineNumber;
+            const char* lineBegin = p;
+            p = lineEnd + (lineEnd < textEnd ? 1 : 0);
+
+            splitLine(lineBegin, lineEnd, fields);
+            if (fields.size() == 1 && fields[0].begin == fields[0].end) continue;  // 空行
+            if (*fields[0].begin == '#') continue;                                // 注释
+
+            if (!haveHeader) {
+                for (int c = 0; c < COL_COUNT; ++c) columns[c] = -1;
+                for (size_t i = 0; i < fields.size(); ++i) {
+                    for (int c = 0; c < COL_COUNT; ++c) {
+                        if (fields[i].view() == CSV_COLUMN_NAMES[c]) columns[c] = static_cast<int>(i);
+                    }
+                }
+                for (int c = 0; c < CSV_REQUIRED_COLUMNS; ++c) {
+                    if (columns[c] < 0) fail(std::string("missing column '") + CSV_COLUMN_NAMES[c] + "'");
+                }
+                haveHeader = true;
+                continue;
+            }
+
+            for (int c = 0; c < COL_COUNT; ++c) {
+                if (columns[c] >= static_cast<int>(fields.size())) fail("too few fields");
+            }
+
+            std::string_view scenarioName = fields[columns[COL_SCENARIO]].view();
+            if (scenarios.empty() || scenarios.back().name != scenarioName) {
+                Scenario scenario;
+                scenario.name.assign(scenarioName.data(), scenarioName.size());
+                if (columns[COL_METHOD] >= 0 && fields[columns[COL_METHOD]].begin != fields[columns[COL_METHOD]].end) {
+                    try {
+                        parseMethod(std::string(fields[columns[COL_METHOD]].view()), scenario);
+                    }
+                    catch (const std::runtime_error& e) {
+                        fail(e.what());
+                    }
+                }
+                scenario.timeStep = number(COL_STEP, scenario.timeStep);
+                scenario.duration = number(COL_DURATION, scenario.duration);
+                scenario.tolerances.relativeTolerance = number(COL_RTOL, scenario.tolerances.relativeTolerance);
+                scenario.tolerances.absoluteTolerance = number(COL_ATOL, scenario.tolerances.absoluteTolerance);
+                if (!scenarios.empty()) validate(scenarios.back(), scenarios.size() - 1);
+                scenarios.push_back(std::move(scenario));
+            }
+
+            ScenarioBody body;
+            std::string_view name = fields[columns[COL_NAME]].view();
+            body.name.assign(name.data(), name.size());
+            body.mass = number(COL_MASS, 0.0);
+            body.radius = number(COL_RADIUS, 0.0);
+            body.position = Vector3D(number(COL_X, 0.0), number(COL_Y, 0.0), number(COL_Z, 0.0));
+            body.velocity = Vector3D(number(COL_VX, 0.0), number(COL_VY, 0.0), number(COL_VZ, 0.0));
+            scenarios.back().bodies.push_back(std::move(body));
+        }
+
+        if (!haveHeader) throw std::runtime_error("CSV has no header line");
+        if (!scenarios.empty()) validate(scenarios.back(), scenarios.size() - 1);
+        return scenarios;
+    }
+
+    ScenarioResult runScenario(const Scenario& scenario) {
+        ScenarioResult result;
+        result.name = scenario.name;
+        result.finalState = scenario.initialState();
+        Physics::SystemState& state = result.finalState;
+        const std::vector<double> masses = scenario.masses();
+        const double initialEnergy = Physics::GravityEngine::calculateTotalEnergy(state.positions, state.velocities, masses);
+
+        struct OpenSink {
+            std::unique_ptr<std::ofstream> stream;
+            size_t every;
+        };
+        std::vector<OpenSink> trajectories;
+        for (const ScenarioSink& sink : scenario.sinks) {
+            if (sink.type != ScenarioSink::TRAJECTORY_CSV) continue;
+            OpenSink open{ std::make_unique<std::ofstream>(sink.path), sink.every };
+            if (!*open.stream) throw std::runtime_error("Cannot open output file: " + sink.path);
+            open.stream->precision(17);
+            *open.stream << "time,body,x,y,z,vx,vy,vz\n";
+            trajectories.push_back(std::move(open));
+        }
+
+        auto writeRows = [&](std::ostream& out, const Physics::SystemState& s) {
+            for (size_t i = 0; i < s.positions.size(); ++i) {
+                out << s.time << ',' << scenario.bodies[i].name << ',';
+                writeVector(out, s.positions[i]);
+                out << ',';
+                writeVector(out, s.velocities[i]);
+                out << '\n';
+            }
+        };
+        for (OpenSink& sink : trajectories) writeRows(*sink.stream, state);
+
+        size_t steps = 0;
+        Physics::StepCallback onStep = [&](const Physics::SystemState& s) {
+            ++steps;
+            for (OpenSink& sink : trajectories) {
+                if (steps % sink.every == 0) writeRows(*sink.stream, s);
+            }
+        };
+        Physics::DerivativeFunction derivFunc = [&masses](const Physics::SystemState& s, Physics::SystemState& d) {
+            Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        };
+
+        const int fixedSteps = static_cast<int>(scenario.duration / scenario.timeStep);
+        if (scenario.adaptive) {
+            Physics::Integrator::integrateAdaptive(state, derivFunc, scenario.duration, scenario.tolerances, onStep);
+        } else if (scenario.ejection == EjectionMode::ANALYTIC) {
+            Physics::EscapePropagator propagator(state, masses, scenario.method, scenario.ejectionCriteria);
+            for (int i = 0; i < fixedSteps; ++i) {
+                propagator.step(scenario.timeStep);
+                // 组装完整状态要做 Kepler 外推，只在需要输出时做
+                if (trajectories.empty()) ++steps;
+                else onStep(propagator.getState());
+            }
+            state = propagator.getState();
+            result.ejections = propagator.getEvents();
+        } else if (scenario.ejection == EjectionMode::STOP) {
+            Physics::Integrator integrator(scenario.method);
+            const Physics::EjectionDetector detector(masses, scenario.ejectionCriteria);
+            const size_t interval = std::max<size_t>(scenario.ejectionCriteria.checkInterval, 1);
+            Physics::EjectionEvent event;
+            for (int i = 0; i < fixedSteps; ++i) {
+                integrator.step(state, derivFunc, scenario.timeStep);
+                state.time += scenario.timeStep;
+                onStep(state);
+                if (steps % interval == 0 && detector.check(state, event)) {
+                    result.ejections.push_back(event);
+                    break;
+                }
+            }
+        } else {
+            Physics::Integrator(scenario.method).advance(state, derivFunc, scenario.duration, scenario.timeStep, onStep);
+        }
+        result.steps = steps;
+
+        double finalEnergy = Physics::GravityEngine::calculateTotalEnergy(state.positions, state.velocities, masses);
+        result.relativeEnergyError = initialEnergy != 0.0 ? std::fabs((finalEnergy - initialEnergy) / initialEnergy) : 0.0;
+
+        for (const ScenarioSink& sink : scenario.sinks) {
+            if (sink.type != ScenarioSink::FINAL_STATE_JSON) continue;
+            JsonValue document = JsonValue::object();
+            document.set("name", scenario.name);
+            document.set("time", state.time);
+            document.set("steps", static_cast<double>(steps));
+            document.set("relative_energy_error", result.relativeEnergyError);
+            JsonValue bodies = JsonValue::array();
+            for (size_t i = 0; i < scenario.bodies.size(); ++i) {
+                JsonValue body = JsonValue::object();
+                body.set("name", scenario.bodies[i].name);
+                body.set("position", vectorJson(state.positions[i]));
+                body.set("velocity", vectorJson(state.velocities[i]));
+                bodies.push(std::move(body));
+            }
+            document.set("bodies", std::move(bodies));
+            if (scenario.ejection != EjectionMode::NONE) {
+                JsonValue ejections = JsonValue::array();
+                for (const Physics::EjectionEvent& e : result.ejections) {
+                    JsonValue ejection = JsonValue::object();
+                    ejection.set("body", scenario.bodies[e.body].name);
+                    ejection.set("time", e.time);
+                    ejection.set("distance", e.distance);
+                    ejection.set("specific_energy", e.specificEnergy);
+                    ejection.set("remainder_bound", e.remainderBound);
+                    ejections.push(std::move(ejection));
+                }
+                document.set("ejections", std::move(ejections));
+            }
+
+            std::ofstream out(sink.path);
+            if (!out) throw std::runtime_error("Cannot open output file: " + sink.path);
+            document.write(out);
+        }
+        return result;
+    }
+
+} // namespace Simulation
@@ -0,0 +1,172 @@
+﻿#include "simulation/SimulationWorld.h"
+#include "physics/GravityEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace Simulation {
+
+    const std::string& BodyView::getName() const { return world->getName(id); }
+    double BodyView::getMass() const { return world->getMass(id); }
+    double BodyView::getRadius() const { return world->getRadius(id); }
+    const Vector3D& BodyView::getPosition() const { return world->getPosition(id); }
+    const Vector3D& BodyView::getVelocity() const { return world->getVelocity(id); }
+    const Vector3D& BodyView::getAcceleration() const { return world->getAcceleration(id); }
+
+    SimulationWorld::SimulationWorld(Physics::Integrator::Method method) : integrator(method) {}
+
+    BodyId SimulationWorld::addBody(const std::string& name, double mass, double radius,
+        const Vector3D& position, const Vector3D& velocity) {
+        if (mass < 0.0 || radius < 0.0) {
+            throw std::invalid_argument("Body mass and radius must be non-negative");
+        }
+        names.push_back(name);
+        masses.push_back(mass);
+        radii.push_back(radius);
+        state.positions.push_back(position);
+        state.velocities.push_back(velocity);
+        // 天体数变化后多步法的历史不再适用
+        integrator.reset();
+        invalidate();
+        return masses.size() - 1;
+    }
+
+    BodyId SimulationWorld::addBody(const CelestialBody& body) {
+        return addBody(body.getName(), body.getMass(), body.getRadius(), body.getPosition(), body.getVelocity());
+    }
+
+    BodyId SimulationWorld::find(const std::string& name) const {
+        for (BodyId id = 0; id < names.size(); ++id) {
+            if (names[id] == name) return id;
+        }
+        throw std::out_of_range("No body named " + name);
+    }
+
+    const Vector3D& SimulationWorld::getAcceleration(BodyId id) const {
+        if (!accelerationsValid) {
+            derivatives = Physics::SystemState(masses.size());
+            Physics::GravityEngine::calculateGravitationalDerivatives(state, derivatives, masses);
+            accelerationsValid = true;
+        }
+        return derivatives.velocities[id];
+    }
+
+    void SimulationWorld::setPosition(BodyId id, const Vector3D& position) {
+        state.positions[id] = position;
+        integrator.reset();
+        invalidate();
+    }
+
+    void SimulationWorld::setVelocity(BodyId id, const Vector3D& velocity) {
+        state.velocities[id] = velocity;
+        integrator.reset();
+        invalidate();
+    }
+
+    void SimulationWorld::step(double dt) {
+        advance(dt, dt);
+    }
+
+    void SimulationWorld::advance(double totalTime, double timeStep, const Physics::StepCallback& onStep) {
+        const std::vector<double>* m = &masses;
+        Physics::DerivativeFunction derivFunc = [m](const Physics::SystemState& s, Physics::SystemState& d) {
+            Physics::GravityEngine::calculateGravitationalDerivatives(s, d, *m);
+        };
+        invalidate();
+        if (collisionResponse == CollisionResponse::NONE) {
+            integrator.advance(state, derivFunc, totalTime, timeStep, onStep);
+            return;
+        }
+
+        if (halted) return;
+        int steps = static_cast<int>(totalTime / timeStep);
+        std::vector<Vector3D> previous;
+        for (int i = 0; i < steps; ++i) {
+            previous = state.positions;
+            integrator.step(state, derivFunc, timeStep);
+            state.time += timeStep;
+            bool collided = resolveCollisions(previous);
+            if (onStep) onStep(state);
+            if (collided && collisionResponse == CollisionResponse::STOP) {
+                halted = true;
+                return;
+            }
+        }
+    }
+
+    bool SimulationWorld::resolveCollisions(const std::vector<Vector3D>& previous) {
+        const std::vector<Physics::CollisionPair>& pairs = detector.detect(previous, state.positions, radii);
+        if (pairs.empty()) return false;
+
+        if (collisionResponse == CollisionResponse::STOP) {
+            for (const Physics::CollisionPair& p : pairs) {
+                BodyId heavy = masses[p.i] >= masses[p.j] ? p.i : p.j;
+                BodyId light = heavy == p.i ? p.j : p.i;
+                double total = masses[heavy] + masses[light];
+                Vector3D center = total > 0.0
+                    ? (state.positions[heavy] * masses[heavy] + state.positions[light] * masses[light]) * (1.0 / total)
+                    : (state.positions[heavy] + state.positions[light]) * 0.5;
+                collisions.push_back(CollisionEvent{ state.time, names[heavy], names[light], center,
+                    (state.velocities[heavy] - state.velocities[light]).magnitude() });
+            }
+            return true;
+        }
+
+        // 合并：用并查集把连锁碰撞（A-B、B-C）归为一组，每组并入组内最重的天体
+        const size_t n = masses.size();
+        std::vector<size_t> parent(n);
+        std::iota(parent.begin(), parent.end(), size_t(0));
+        auto root = [&parent](size_t k) {
+            while (parent[k] != k) k = parent[k] = parent[parent[k]];
+            return k;
+        };
+        for (const Physics::CollisionPair& p : pairs) {
+            size_t a = root(p.i), b = root(p.j);
+            if (a == b) continue;
+            // 根为较重者，质量相同时取编号小者
+            if (masses[b] > masses[a] || (masses[b] == masses[a] && b < a)) std::swap(a, b);
+            collisions.push_back(CollisionEvent{ state.time, names[a], names[b], Vector3D::zero(),
+                (state.velocities[a] - state.velocities[b]).magnitude() });
+            double total = masses[a] + masses[b];
+            if (total > 0.0) {
+                double wa = masses[a] / total, wb = masses[b] / total;
+                state.positions[a] = state.positions[a] * wa + state.positions[b] * wb;
+                state.velocities[a] = state.velocities[a] * wa + state.velocities[b] * wb;
+            }
+            masses[a] = total;
+            radii[a] = std::cbrt(radii[a] * radii[a] * radii[a] + radii[b] * radii[b] * radii[b]);
+            collisions.back().position = state.positions[a];
+            parent[b] = a;
+        }
+
+        // 压缩：移除被合并的天体，保持其余天体的相对顺序
+        size_t kept = 0;
+        for (size_t k = 0; k < n; ++k) {
+            if (root(k) != k) continue;
+            if (kept != k) {
+                names[kept] = std::move(names[k]);
+                masses[kept] = masses[k];
+                radii[kept] = radii[k];
+                state.positions[kept] = state.positions[k];
+                state.velocities[kept] = state.velocities[k];
+            }
+            ++kept;
+        }
+        names.resize(kept);
+        masses.resize(kept);
+        radii.resize(kept);
+        state.positions.resize(kept);
+        state.velocities.resize(kept);
+        integrator.reset();
+        invalidate();
+        return true;
+    }
+
+    void SimulationWorld::copyTo(BodyId id, CelestialBody& body) const {
+        body.setPosition(state.positions[id]);
+        body.setVelocity(state.velocities[id]);
+        body.setAcceleration(getAcceleration(id));
+    }
+
+} // namespace Simulation
@@ -0,0 +1,469 @@
+﻿#include "simulation/StabilityMap.h"
+#include "physics/ChaosIndicator.h"
+#include "physics/EjectionDetector.h"
+#include "physics/FixedSystem.h"
+#include "physics/GravityEngine.h"
+#include "utils/BinaryIO.h"
+#include "utils/Json.h"
+#include "utils/ThreadPool.h"
+#include "utils/Trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace Simulation {
+
+    using Utils::JsonValue;
+
+    namespace {
+        const char RASTER_MAGIC[8] = { 'T', 'B', 'C', 'S', 'M', 'A', 'P', '1' };
+        const uint64_t HEADER_SIZE = sizeof(RASTER_MAGIC) + sizeof(uint64_t) + 3 * sizeof(uint32_t);
+        const uint64_t RECORD_SIZE = 2 * sizeof(double) + 2 * sizeof(uint32_t);
+
+        void encodeRecord(const CellResult& cell, char* out) {
+            uint32_t outcome = static_cast<uint32_t>(cell.outcome), reserved = 0;
+            std::memcpy(out, &cell.endTime, sizeof(double));
+            std::memcpy(out + 8, &cell.megno, sizeof(double));
+            std::memcpy(out + 16, &outcome, sizeof(uint32_t));
+            std::memcpy(out + 20, &reserved, sizeof(uint32_t));
+        }
+
+        CellResult decodeRecord(const char* in) {
+            CellResult cell;
+            uint32_t outcome = 0;
+            std::memcpy(&cell.endTime, in, sizeof(double));
+            std::memcpy(&cell.megno, in + 8, sizeof(double));
+            std::memcpy(&outcome, in + 16, sizeof(uint32_t));
+            cell.outcome = outcome <= static_cast<uint32_t>(CellOutcome::COLLIDED)
+                ? static_cast<CellOutcome>(outcome) : CellOutcome::PENDING;
+            return cell;
+        }
+
+        StabilityAxis readAxis(const JsonValue& value, const char* which) {
+            StabilityAxis axis;
+            axis.parameter = StabilityMapConfig::parseParameter(value.at("parameter").asString());
+            axis.min = value.at("min").asNumber();
+            axis.max = value.at("max").asNumber();
+            double cells = value.numberOr("cells", 1.0);
+            if (!(cells >= 1.0 && cells <= 1e6) || !(axis.max >= axis.min)) {
+                throw std::runtime_error(std::string("Stability map axis '") + which + "' needs min <= max and 1..1e6 cells");
+            }
+            axis.cells = static_cast<uint32_t>(cells);
+            return axis;
+        }
+
+        // 逐步推进，每步后检查逃逸与碰撞。Stepper 推进一步，Positions() / Velocities() 给出当前各天体的数组
+        template <typename Stepper, typename Positions, typename Velocities>
+        CellResult evolve(const StabilityMapConfig& config, const Physics::SystemState& initial,
+            const std::vector<double>& masses, Stepper&& stepOnce, Positions&& positions, Velocities&& velocities) {
+            const size_t n = masses.size();
+            const std::vector<double> radii = config.radii();
+            Physics::EjectionCriteria criteria;
+            criteria.distanceFactor = std::max(config.ejectionFactor, 1.0);
+            const Physics::EjectionDetector detector(masses, criteria);
+
+            // 质心匀速运动，逃逸按到当前质心的距离判定
+            double totalMass = 0.0;
+            Vector3D centre = Vector3D::zero(), drift = Vector3D::zero();
+            for (size_t i = 0; i < n; ++i) {
+                totalMass += masses[i];
+                centre.addScaled(initial.positions[i], masses[i]);
+                drift.addScaled(initial.velocities[i], masses[i]);
+            }
+            if (totalMass > 0.0) {
+                centre = centre / totalMass;
+                drift = drift / totalMass;
+            }
+            double escape = config.escapeDistance;
+            if (!(escape > 0.0)) {
+                for (size_t i = 0; i < n; ++i) escape = std::max(escape, (initial.positions[i] - centre).magnitude());
+                escape *= 100.0;
+            }
+            const double escape2 = escape * escape;
+
+            auto check = [&](double t, bool checkEjection) {
+                const Vector3D* position = positions();
+                Vector3D c = Vector3D::axpy(centre, drift, t);
+                for (size_t i = 0; i < n; ++i) {
+                    if ((position[i] - c).magnitudeSquared() > escape2) return CellOutcome::EJECTED;
+                }
+                for (size_t i = 0; i < n; ++i) {
+                    for (size_t j = i + 1; j < n; ++j) {
+                        double contact = radii[i] + radii[j];
+                        if ((position[i] - position[j]).magnitudeSquared() < contact * contact) return CellOutcome::COLLIDED;
+                    }
+                }
+                // 已处于不可逆的逃逸轨道时不必等它飞到 escapeDistance
+                Physics::EjectionEvent event;
+                if (checkEjection && config.ejectionFactor > 0.0 && detector.check(position, velocities(), t, event)) {
+                    return CellOutcome::EJECTED;
+                }
+                return CellOutcome::PENDING;
+            };
+
+            CellResult result;
+            const double dt = config.system.timeStep;
+            const size_t steps = static_cast<size_t>(config.system.duration / dt);
+            result.outcome = check(0.0, true);
+            for (size_t k = 0; k < steps && result.outcome == CellOutcome::PENDING; ++k) {
+                stepOnce(dt);
+                result.endTime = static_cast<double>(k + 1) * dt;
+                result.outcome = check(result.endTime, (k + 1) % criteria.checkInterval == 0);
+            }
+            if (result.outcome == CellOutcome::PENDING) result.outcome = CellOutcome::SURVIVED;
+            return result;
+        }
+
+        template <size_t N>
+        CellResult evolveFixed(const StabilityMapConfig& config, const Physics::SystemState& initial,
+            const std::vector<double>& masses) {
+            Physics::FixedSystemState<N> state(initial);
+            Physics::FixedIntegrator<N> integrator(Physics::FixedGravity<N>(masses), config.system.method);
+            return evolve(config, initial, masses,
+                [&](double dt) { integrator.step(state, dt); state.time += dt; },
+                [&]() { return state.positions.data(); },
+                [&]() { return state.velocities.data(); });
+        }
+    }
+
+    void PlanetOrbit::set(StabilityParameter parameter, double value) {
+        switch (parameter) {
+        case StabilityParameter::SEMI_MAJOR_AXIS: semiMajorAxis = value; break;
+        case StabilityParameter::ECCENTRICITY: eccentricity = value; break;
+        case StabilityParameter::INCLINATION: inclination = value; break;
+        case StabilityParameter::TRUE_ANOMALY: trueAnomaly = value; break;
+        }
+    }
+
+    Physics::SystemState StabilityMapConfig::initialState(double xValue, double yValue) const {
+        PlanetOrbit orbit = planet;
+        orbit.set(x.parameter, xValue);
+        orbit.set(y.parameter, yValue);
+        if (orbit.host >= system.bodies.size()) throw std::invalid_argument("Stability map planet host out of range");
+        if (!(orbit.semiMajorAxis > 0.0) || !(orbit.eccentricity >= 0.0 && orbit.eccentricity < 1.0)) {
+            throw std::invalid_argument("Stability map planet needs a > 0 and 0 <= e < 1");
+        }
+
+        Physics::SystemState state = system.initialState();
+        const ScenarioBody& host = system.bodies[orbit.host];
+        double mu = PhysicsConstants::G * (host.mass + orbit.mass);
+        double p = orbit.semiMajorAxis * (1.0 - orbit.eccentricity * orbit.eccentricity);
+        double cosNu = std::cos(orbit.trueAnomaly), sinNu = std::sin(orbit.trueAnomaly);
+        double r = p / (1.0 + orbit.eccentricity * cosNu);
+        double speed = std::sqrt(mu / p);
+        // 轨道平面内的位置与速度，再绕 x 轴转过倾角
+        double ci = std::cos(orbit.inclination), si = std::sin(orbit.inclination);
+        Vector3D position(r * cosNu, r * sinNu * ci, r * sinNu * si);
+        Vector3D velocity(-speed * sinNu, speed * (orbit.eccentricity + cosNu) * ci, speed * (orbit.eccentricity + cosNu) * si);
+
+        state.positions.push_back(host.position + position);
+        state.velocities.push_back(host.velocity + velocity);
+        return state;
+    }
+
+    std::vector<double> StabilityMapConfig::masses() const {
+        std::vector<double> result = system.masses();
+        result.push_back(planet.mass);
+        return result;
+    }
+
+    std::vector<double> StabilityMapConfig::radii() const {
+        std::vector<double> result;
+        result.reserve(system.bodies.size() + 1);
+        for (const ScenarioBody& body : system.bodies) result.push_back(body.radius);
+        result.push_back(planet.radius);
+        return result;
+    }
+
+    uint64_t StabilityMapConfig::fingerprint() const {
+        std::ostringstream bytes;
+        auto number = [&bytes](double v) { Utils::writePod(bytes, v); };
+        for (const ScenarioBody& body : system.bodies) {
+            bytes << body.name << '\0';
+            number(body.mass);
+            number(body.radius);
+            number(body.position.x); number(body.position.y); number(body.position.z);
+            number(body.velocity.x); number(body.velocity.y); number(body.velocity.z);
+        }
+        Utils::writePod(bytes, static_cast<int32_t>(system.method));
+        number(system.timeStep);
+        number(system.duration);
+        number(static_cast<double>(planet.host));
+        number(planet.mass); number(planet.radius);
+        number(planet.semiMajorAxis); number(planet.eccentricity);
+        number(planet.inclination); number(planet.trueAnomaly);
+        for (const StabilityAxis* axis : { &x, &y }) {
+            Utils::writePod(bytes, static_cast<int32_t>(axis->parameter));
+            number(axis->min); number(axis->max);
+            Utils::writePod(bytes, axis->cells);
+        }
+        Utils::writePod(bytes, tileSize);
+        number(escapeDistance);
+        number(ejectionFactor);
+        Utils::writePod(bytes, static_cast<uint8_t>(computeMegno));
+
+        return Utils::hashBytes(bytes.str());
+    }
+
+    StabilityParameter StabilityMapConfig::parseParameter(const std::string& name) {
+        if (name == "semi_major_axis" || name == "a") return StabilityParameter::SEMI_MAJOR_AXIS;
+        if (name == "eccentricity" || name == "e") return StabilityParameter::ECCENTRICITY;
+        if (name == "inclination" || name == "i") return StabilityParameter::INCLINATION;
+        if (name == "true_anomaly" || name == "nu") return StabilityParameter::TRUE_ANOMALY;
+        throw std::runtime_error("Unknown stability map parameter: " + name);
+    }
+
+    StabilityMapConfig StabilityMapConfig::fromJson(const JsonValue& document) {
+        StabilityMapConfig config;
+        config.system = ScenarioLoader::fromJson(document.at("system"));
+        if (config.system.adaptive) throw std::runtime_error("Stability maps need a fixed-step integrator");
+
+        const JsonValue& p = document.at("planet");
+        config.planet.name = p.stringOr("name", config.planet.name);
+        if (const JsonValue* host = p.find("host")) {
+            if (host->isString()) {
+                auto it = std::find_if(config.system.bodies.begin(), config.system.bodies.end(),
+                    [host](const ScenarioBody& b) { return b.name == host->asString(); });
+                if (it == config.system.bodies.end()) throw std::runtime_error("Unknown planet host: " + host->asString());
+                config.planet.host = static_cast<size_t>(it - config.system.bodies.begin());
+            } else {
+                config.planet.host = static_cast<size_t>(host->asNumber());
+            }
+        }
+        if (config.planet.host >= config.system.bodies.size()) throw std::runtime_error("Planet host out of range");
+        config.planet.mass = p.numberOr("mass", 0.0);
+        config.planet.radius = p.numberOr("radius", 0.0);
+        config.planet.semiMajorAxis = p.numberOr("semi_major_axis", 0.0);
+        config.planet.eccentricity = p.numberOr("eccentricity", 0.0);
+        config.planet.inclination = p.numberOr("inclination", 0.0);
+        config.planet.trueAnomaly = p.numberOr("true_anomaly", 0.0);
+
+        config.x = readAxis(document.at("x"), "x");
+        config.y = readAxis(document.at("y"), "y");
+        double tile = document.numberOr("tile", 8.0);
+        if (!(tile >= 1.0 && tile <= 4096.0)) throw std::runtime_error("Stability map tile must be 1..4096 cells");
+        config.tileSize = static_cast<uint32_t>(tile);
+        config.escapeDistance = document.numberOr("escape_distance", 0.0);
+        config.ejectionFactor = document.numberOr("ejection_factor", config.ejectionFactor);
+        if (const JsonValue* megno = document.find("megno")) config.computeMegno = megno->asBool();
+        return config;
+    }
+
+    StabilityMapConfig StabilityMapConfig::loadFile(const std::string& path) {
+        return fromJson(JsonValue::parseFile(path));
+    }
+
+    CellResult runStabilityCell(const StabilityMapConfig& config, double xValue, double yValue) {
+        Physics::SystemState initial = config.initialState(xValue, yValue);
+        std::vector<double> masses = config.masses();
+
+        if (config.computeMegno) {
+            Physics::ChaosIndicator chaos(initial, masses, config.system.method);
+            CellResult result = evolve(config, initial, masses,
+                [&](double dt) { chaos.step(dt); },
+                [&]() { return &chaos.getPosition(0); },
+                [&]() { return &chaos.getVelocity(0); });
+            result.megno = chaos.megno();
+            return result;
+        }
+
+        switch (masses.size()) {
+        case 2: return evolveFixed<2>(config, initial, masses);
+        case 3: return evolveFixed<3>(config, initial, masses);
+        case 4: return evolveFixed<4>(config, initial, masses);
+        default: break;
+        }
+
+        Physics::SystemState state = initial;
+        Physics::Integrator integrator(config.system.method);
+        Physics::DerivativeFunction f = [&masses](const Physics::SystemState& s, Physics::SystemState& d) {
+            Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        };
+        return evolve(config, initial, masses,
+            [&](double dt) { integrator.step(state, f, dt); state.time += dt; },
+            [&]() { return state.positions.data(); },
+            [&]() { return state.velocities.data(); });
+    }
+
+    StabilityRaster::StabilityRaster(const std::string& path, const StabilityMapConfig& config)
+        : path(path), width(config.x.cells), height(config.y.cells), tileSize(config.tileSize) {
+        if (width == 0 || height == 0 || tileSize == 0) throw std::invalid_argument("Stability raster needs a non-empty grid");
+        tilesX = (width + tileSize - 1) / tileSize;
+        const uint32_t tilesY = (height + tileSize - 1) / tileSize;
+        done.assign(static_cast<size_t>(tilesX) * tilesY, 0);
+        flagsOffset = HEADER_SIZE;
+        recordsOffset = flagsOffset + done.size();
+        const uint64_t fingerprint = config.fingerprint();
+
+        file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+        if (file) {
+            char magic[sizeof(RASTER_MAGIC)];
+            if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, RASTER_MAGIC, sizeof(magic)) != 0) {
+                throw std::runtime_error("Not a stability raster: " + path);
+            }
+            uint64_t storedFingerprint = Utils::readPod<uint64_t>(file);
+            uint32_t storedWidth = Utils::readPod<uint32_t>(file);
+            uint32_t storedHeight = Utils::readPod<uint32_t>(file);
+            uint32_t storedTile = Utils::readPod<uint32_t>(file);
+            if (storedFingerprint != fingerprint || storedWidth != width || storedHeight != height || storedTile != tileSize) {
+                throw std::runtime_error("Stability raster " + path + " belongs to a different map configuration");
+            }
+            Utils::readArray(file, done, done.size());
+            return;
+        }
+
+        // 新建：记录区只在末尾写一个字节，由文件系统补零（未计算 = PENDING）
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            if (!out) throw std::runtime_error("Cannot create stability raster: " + path);
+            out.write(RASTER_MAGIC, sizeof(RASTER_MAGIC));
+            Utils::writePod(out, fingerprint);
+            Utils::writePod(out, width);
+            Utils::writePod(out, height);
+            Utils::writePod(out, tileSize);
+            Utils::writeArray(out, done);
+            uint64_t end = recordsOffset + static_cast<uint64_t>(width) * height * RECORD_SIZE;
+            out.seekp(static_cast<std::streamoff>(end - 1));
+            out.put('\0');
+            if (!out) throw std::runtime_error("Cannot create stability raster: " + path);
+        }
+        file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+        if (!file) throw std::runtime_error("Cannot open stability raster: " + path);
+    }
+
+    size_t StabilityRaster::tilesDone() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return static_cast<size_t>(std::count(done.begin(), done.end(), uint8_t(1)));
+    }
+
+    void StabilityRaster::tileBounds(size_t tile, uint32_t& x0, uint32_t& y0, uint32_t& x1, uint32_t& y1) const {
+        x0 = static_cast<uint32_t>(tile % tilesX) * tileSize;
+        y0 = static_cast<uint32_t>(tile / tilesX) * tileSize;
+        x1 = std::min(x0 + tileSize, width);
+        y1 = std::min(y0 + tileSize, height);
+    }
+
+    uint64_t StabilityRaster::recordOffset(uint32_t x, uint32_t y) const {
+        return recordsOffset + (static_cast<uint64_t>(y) * width + x) * RECORD_SIZE;
+    }
+
+    void StabilityRaster::writeTile(size_t tile, const std::vector<CellResult>& cells) {
+        THREEBODY_TRACE_SCOPE("stability_write_tile", "io");
+        uint32_t x0, y0, x1, y1;
+        tileBounds(tile, x0, y0, x1, y1);
+        const uint32_t w = x1 - x0;
+        if (cells.size() != static_cast<size_t>(w) * (y1 - y0)) {
+            throw std::invalid_argument("Stability tile has the wrong number of cells");
+        }
+        std::vector<char> buffer(w * RECORD_SIZE);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t y = y0; y < y1; ++y) {
+            for (uint32_t x = 0; x < w; ++x) encodeRecord(cells[(y - y0) * w + x], &buffer[x * RECORD_SIZE]);
+            file.seekp(static_cast<std::streamoff>(recordOffset(x0, y)));
+            file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+        file.flush();
+        // 记录落盘之后再置完成标志
+        file.seekp(static_cast<std::streamoff>(flagsOffset + tile));
+        file.put(1);
+        file.flush();
+        if (!file) throw std::runtime_error("Failed to write stability raster: " + path);
+        done[tile] = 1;
+    }
+
+    std::vector<CellResult> StabilityRaster::readRow(uint32_t row) {
+        std::vector<char> buffer(width * RECORD_SIZE);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            file.seekg(static_cast<std::streamoff>(recordOffset(0, row)));
+            if (!file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()))) {
+                throw std::runtime_error("Stability raster truncated: " + path);
+            }
+        }
+        std::vector<CellResult> cells(width);
+        for (uint32_t x = 0; x < width; ++x) cells[x] = decodeRecord(&buffer[x * RECORD_SIZE]);
+        return cells;
+    }
+
+    void StabilityRaster::writeImage(const std::string& imagePath, double duration, double timeStep) {
+        writeStabilityImage(imagePath, width, height, [this](uint32_t row) { return readRow(row); }, duration, timeStep);
+    }
+
+    void writeStabilityImage(const std::string& imagePath, uint32_t width, uint32_t height,
+        const std::function<std::vector<CellResult>(uint32_t)>& row, double duration, double timeStep) {
+        std::ofstream out(imagePath, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Cannot write stability image: " + imagePath);
+        out << "P5\n" << width << ' ' << height << "\n255\n";
+
+        const double scale = std::log1p(duration / timeStep);
+        std::vector<unsigned char> pixels(width);
+        for (uint32_t y = height; y-- > 0;) {
+            std::vector<CellResult> cells = row(y);
+            for (uint32_t x = 0; x < width; ++x) {
+                const CellResult& c = cells[x];
+                double shade = 0.0;
+                if (c.outcome == CellOutcome::SURVIVED) shade = 255.0;
+                else if (c.outcome != CellOutcome::PENDING) shade = 32.0 + 190.0 * std::log1p(c.endTime / timeStep) / scale;
+                pixels[x] = static_cast<unsigned char>(std::min(255.0, std::max(0.0, shade)));
+            }
+            out.write(reinterpret_cast<const char*>(pixels.data()), static_cast<std::streamsize>(pixels.size()));
+        }
+        if (!out) throw std::runtime_error("Failed to write stability image: " + imagePath);
+    }
+
+    size_t runStabilityMap(const StabilityMapConfig& config, StabilityRaster& raster,
+        const StabilityRunOptions& options) {
+        THREEBODY_TRACE_SCOPE("stability_map", "analysis");
+        std::vector<size_t> pending;
+        for (size_t t = 0; t < raster.tileCount(); ++t) {
+            if (!raster.isTileDone(t)) pending.push_back(t);
+        }
+        const size_t total = raster.tileCount();
+        size_t finished = total - pending.size();
+        size_t completed = 0;
+        std::mutex progress;
+
+        // 每个任务领取一个瓦片，线程池按提交顺序动态分发
+        auto work = [&](size_t begin, size_t end) {
+            for (size_t k = begin; k < end; ++k) {
+                if (options.stop != nullptr && options.stop->load()) return;
+                const size_t tile = pending[k];
+                uint32_t x0, y0, x1, y1;
+                raster.tileBounds(tile, x0, y0, x1, y1);
+                std::vector<CellResult> cells;
+                cells.reserve(static_cast<size_t>(x1 - x0) * (y1 - y0));
+                for (uint32_t iy = y0; iy < y1; ++iy) {
+                    for (uint32_t ix = x0; ix < x1; ++ix) {
+                        cells.push_back(runStabilityCell(config, config.x.valueAt(ix), config.y.valueAt(iy)));
+                    }
+                }
+                raster.writeTile(tile, cells);
+
+                std::lock_guard<std::mutex> lock(progress);
+                ++completed;
+                ++finished;
+                if (options.onTile) options.onTile(tile, finished, total);
+            }
+        };
+
+        if (options.pool != nullptr) {
+            options.pool->parallelFor(0, pending.size(), 1, work);
+        } else {
+            work(0, pending.size());
+        }
+        return completed;
+    }
+
+    const char* toString(CellOutcome outcome) {
+        switch (outcome) {
+        case CellOutcome::SURVIVED: return "survived";
+        case CellOutcome::EJECTED: return "ejected";
+        case CellOutcome::COLLIDED: return "collided";
+        default: return "pending";
+        }
+    }
+
+} // namespace Simulation
@@ -0,0 +1,59 @@
+﻿#include "simulation/Trajectory.h"
+#include <algorithm>
+
+namespace Simulation {
+
+    Vector3D hermitePosition(const Physics::SystemState& a, const Physics::SystemState& b,
+        size_t body, double t) {
+        double h = b.time - a.time;
+        double s = (t - a.time) / h;
+        double s2 = s * s;
+        double s3 = s2 * s;
+
+        return a.positions[body] * (2.0 * s3 - 3.0 * s2 + 1.0) +
+            a.velocities[body] * ((s3 - 2.0 * s2 + s) * h) +
+            b.positions[body] * (-2.0 * s3 + 3.0 * s2) +
+            b.velocities[body] * ((s3 - s2) * h);
+    }
+
+    void hermiteInterpolate(const Physics::SystemState& a, const Physics::SystemState& b,
+        double t, Physics::SystemState& out) {
+        size_t n = a.positions.size();
+        out.positions.resize(n);
+        out.velocities.resize(n);
+        out.time = t;
+
+        double h = b.time - a.time;
+        double s = (t - a.time) / h;
+        double s2 = s * s;
+        double s3 = s2 * s;
+
+        // 基函数及其对 s 的导数
+        double h00 = 2.0 * s3 - 3.0 * s2 + 1.0, d00 = 6.0 * s2 - 6.0 * s;
+        double h10 = s3 - 2.0 * s2 + s, d10 = 3.0 * s2 - 4.0 * s + 1.0;
+        double h01 = -2.0 * s3 + 3.0 * s2, d01 = -6.0 * s2 + 6.0 * s;
+        double h11 = s3 - s2, d11 = 3.0 * s2 - 2.0 * s;
+
+        for (size_t i = 0; i < n; ++i) {
+            out.positions[i] = a.positions[i] * h00 + a.velocities[i] * (h10 * h) +
+                b.positions[i] * h01 + b.velocities[i] * (h11 * h);
+            out.velocities[i] = a.positions[i] * (d00 / h) + a.velocities[i] * d10 +
+                b.positions[i] * (d01 / h) + b.velocities[i] * d11;
+        }
+    }
+
+    void interpolateTrajectory(const std::vector<Physics::SystemState>& samples,
+        double t, Physics::SystemState& out) {
+        if (samples.size() == 1) {
+            out = samples.front();
+            return;
+        }
+        auto it = std::upper_bound(samples.begin(), samples.end(), t,
+            [](double value, const Physics::SystemState& s) { return value < s.time; });
+        size_t hi = it - samples.begin();
+        if (hi == 0) hi = 1;
+        if (hi >= samples.size()) hi = samples.size() - 1;
+        hermiteInterpolate(samples[hi - 1], samples[hi], t, out);
+    }
+
+} // namespace Simulation
@@ -0,0 +1,209 @@
+﻿#include "utils/Instrumentation.h"
+#include "utils/AtomicFile.h"
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace Utils {
+namespace Instrumentation {
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<ThreadBlock*> live;
+            uint64_t retiredCounters[COUNTER_COUNT] = {};
+            uint64_t retiredTicks[PHASE_COUNT] = {};
+            uint64_t retiredCalls[PHASE_COUNT] = {};
+            uint64_t retiredSampled[PHASE_COUNT] = {};
+            size_t threads = 0;
+            Clock::time_point resetTime = Clock::now();
+        };
+
+        Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        // 标定起点，在静态初始化时记录
+        struct Calibration {
+            uint64_t ticks;
+            Clock::time_point time;
+        };
+
+        const Calibration& anchor() {
+            static const Calibration instance{ ticks(), Clock::now() };
+            return instance;
+        }
+
+        const Calibration& startupAnchor = anchor();
+
+        // ticks() 与秒的换算：比较标定起点以来（至少 20 ms）的 TSC 增量与 steady_clock，只标定一次
+        double secondsPerTick() {
+            static const double value = [] {
+#if (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))) || \
+    ((defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__)))
+                const Calibration& start = anchor();
+                const auto minimum = std::chrono::milliseconds(20);
+                Clock::duration elapsed = Clock::now() - start.time;
+                if (elapsed < minimum) {
+                    std::this_thread::sleep_for(minimum - elapsed);
+                }
+                uint64_t t = ticks();
+                double seconds = std::chrono::duration<double>(Clock::now() - start.time).count();
+                return seconds / static_cast<double>(t - start.ticks);
+#else
+                return 1e-9;
+#endif
+            }();
+            return value;
+        }
+
+        const char* const COUNTER_NAMES[COUNTER_COUNT] = {
+            "force_evaluations", "pair_interactions", "steps", "rejected_steps", "bytes_written"
+        };
+        const char* const PHASE_NAMES[PHASE_COUNT] = {
+            "force", "stage_update", "io", "events"
+        };
+
+    } // namespace
+
+    const char* counterName(Counter counter) {
+        return COUNTER_NAMES[static_cast<size_t>(counter)];
+    }
+
+    const char* phaseName(Phase phase) {
+        return PHASE_NAMES[static_cast<size_t>(phase)];
+    }
+
+    ThreadBlockHandle::ThreadBlockHandle() : block(new ThreadBlock()) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(block);
+        ++r.threads;
+    }
+
+    ThreadBlockHandle::~ThreadBlockHandle() {
+        Registry& r = registry();
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (size_t i = 0; i < COUNTER_COUNT; ++i) r.retiredCounters[i] += block->counters[i].load();
+            for (size_t i = 0; i < PHASE_COUNT; ++i) {
+                r.retiredTicks[i] += block->phaseTicks[i].load();
+                r.retiredCalls[i] += block->phaseCalls[i].load();
+                r.retiredSampled[i] += block->phaseSampledCalls[i].load();
+            }
+            for (size_t i = 0; i < r.live.size(); ++i) {
+                if (r.live[i] == block) {
+                    r.live[i] = r.live.back();
+                    r.live.pop_back();
+                    break;
+                }
+            }
+        }
+        delete block;
+    }
+
+    Snapshot snapshot() {
+        (void)startupAnchor;
+        double scale = secondsPerTick();
+
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        Snapshot snap;
+        uint64_t phaseTicks[PHASE_COUNT] = {};
+        uint64_t sampled[PHASE_COUNT] = {};
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) snap.counters[i] = r.retiredCounters[i];
+        for (size_t i = 0; i < PHASE_COUNT; ++i) {
+            phaseTicks[i] = r.retiredTicks[i];
+            snap.phaseCalls[i] = r.retiredCalls[i];
+            sampled[i] = r.retiredSampled[i];
+        }
+        for (const ThreadBlock* block : r.live) {
+            for (size_t i = 0; i < COUNTER_COUNT; ++i) snap.counters[i] += block->counters[i].load(std::memory_order_relaxed);
+            for (size_t i = 0; i < PHASE_COUNT; ++i) {
+                phaseTicks[i] += block->phaseTicks[i].load(std::memory_order_relaxed);
+                snap.phaseCalls[i] += block->phaseCalls[i].load(std::memory_order_relaxed);
+                sampled[i] += block->phaseSampledCalls[i].load(std::memory_order_relaxed);
+            }
+        }
+        for (size_t i = 0; i < PHASE_COUNT; ++i) {
+            if (sampled[i] == 0) continue;
+            snap.phaseSeconds[i] = phaseTicks[i] * scale * (static_cast<double>(snap.phaseCalls[i]) / sampled[i]);
+        }
+        snap.wallSeconds = std::chrono::duration<double>(Clock::now() - r.resetTime).count();
+        snap.threads = r.threads;
+        return snap;
+    }
+
+    void reset() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) r.retiredCounters[i] = 0;
+        for (size_t i = 0; i < PHASE_COUNT; ++i) r.retiredTicks[i] = r.retiredCalls[i] = r.retiredSampled[i] = 0;
+        for (ThreadBlock* block : r.live) {
+            for (auto& c : block->counters) c.store(0, std::memory_order_relaxed);
+            for (auto& c : block->phaseTicks) c.store(0, std::memory_order_relaxed);
+            for (auto& c : block->phaseCalls) c.store(0, std::memory_order_relaxed);
+            for (auto& c : block->phaseSampledCalls) c.store(0, std::memory_order_relaxed);
+        }
+        r.threads = r.live.size();
+        r.resetTime = Clock::now();
+    }
+
+    void writeJson(std::ostream& out, const Snapshot& snap) {
+        out << "{\n  \"wall_seconds\": " << snap.wallSeconds << ",\n  \"threads\": " << snap.threads
+            << ",\n  \"counters\": {";
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            out << (i ? ", " : "") << '"' << COUNTER_NAMES[i] << "\": " << snap.counters[i];
+        }
+        out << "},\n  \"phases\": {";
+        for (size_t i = 0; i < PHASE_COUNT; ++i) {
+            out << (i ? ", " : "") << '"' << PHASE_NAMES[i] << "\": {\"seconds\": " << snap.phaseSeconds[i]
+                << ", \"calls\": " << snap.phaseCalls[i] << '}';
+        }
+        out << "}\n}\n";
+    }
+
+    void writePrometheus(std::ostream& out, const Snapshot& snap) {
+        for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+            out << "# TYPE threebody_" << COUNTER_NAMES[i] << "_total counter\n"
+                << "threebody_" << COUNTER_NAMES[i] << "_total " << snap.counters[i] << '\n';
+        }
+        out << "# TYPE threebody_phase_seconds_total counter\n";
+        for (size_t i = 0; i < PHASE_COUNT; ++i) {
+            out << "threebody_phase_seconds_total{phase=\"" << PHASE_NAMES[i] << "\"} " << snap.phaseSeconds[i] << '\n';
+        }
+        out << "# TYPE threebody_phase_calls_total counter\n";
+        for (size_t i = 0; i < PHASE_COUNT; ++i) {
+            out << "threebody_phase_calls_total{phase=\"" << PHASE_NAMES[i] << "\"} " << snap.phaseCalls[i] << '\n';
+        }
+        out << "# TYPE threebody_wall_seconds gauge\nthreebody_wall_seconds " << snap.wallSeconds << '\n';
+    }
+
+    void saveSnapshot(const std::string& path, const Snapshot& snap) {
+        bool prometheus = path.size() >= 5 && path.compare(path.size() - 5, 5, ".prom") == 0;
+        std::string temp = path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::trunc);
+            if (!out) {
+                throw std::runtime_error("Cannot open metrics file for writing: " + temp);
+            }
+            out.precision(9);
+            if (prometheus) writePrometheus(out, snap);
+            else writeJson(out, snap);
+            if (!out) {
+                throw std::runtime_error("Failed writing metrics file: " + temp);
+            }
+        }
+        if (!replaceFile(temp, path)) {
+            throw std::runtime_error("Cannot replace metrics file: " + path);
+        }
+    }
+
+} // namespace Instrumentation
+} // namespace Utils
@@ -0,0 +1,341 @@
+﻿#include "utils/Json.h"
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace Utils {
+
+    namespace {
+
+        class Parser {
+        public:
+            explicit Parser(const std::string& text) : text(text) {}
+
+            JsonValue parseDocument() {
+                JsonValue value = parseValue(0);
+                skipWhitespace();
+                if (pos != text.size()) fail("Unexpected trailing characters");
+                return value;
+            }
+
+        private:
+            static constexpr int MAX_DEPTH = 64;
+
+            [[noreturn]] void fail(const std::string& message) const {
+                size_t line = 1;
+                for (size_t i = 0; i < pos && i < text.size(); ++i) {
+                    if (text[i] == '\n') ++line;
+                }
+                throw std::runtime_error("JSON parse error at line " + std::to_string(line) + ": " + message);
+            }
+
+            void skipWhitespace() {
+                while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' || text[pos] == '\n' || text[pos] == '\r')) {
+                    ++pos;
+                }
+            }
+
+            void expect(char c) {
+                skipWhitespace();
+                if (pos >= text.size() || text[pos] != c) fail(std::string("Expected '") + c + "'");
+                ++pos;
+            }
+
+            bool consumeLiteral(const char* literal) {
+                size_t n = std::char_traits<char>::length(literal);
+                if (text.compare(pos, n, literal) == 0) {
+                    pos += n;
+                    return true;
+                }
+                return false;
+            }
+
+            JsonValue parseValue(int depth) {
+                if (depth > MAX_DEPTH) fail("Nesting too deep");
+                skipWhitespace();
+                if (pos >= text.size()) fail("Unexpected end of input");
+
+                char c = text[pos];
+                if (c == '{') return parseObject(depth);
+                if (c == '[') return parseArray(depth);
+                if (c == '"') return JsonValue(parseString());
+                if (consumeLiteral("true")) return JsonValue(true);
+                if (consumeLiteral("false")) return JsonValue(false);
+                if (consumeLiteral("null")) return JsonValue();
+                return JsonValue(parseNumber());
+            }
+
+            JsonValue parseObject(int depth) {
+                JsonValue object = JsonValue::object();
+                ++pos;
+                skipWhitespace();
+                if (pos < text.size() && text[pos] == '}') {
+                    ++pos;
+                    return object;
+                }
+                for (;;) {
+                    skipWhitespace();
+                    if (pos >= text.size() || text[pos] != '"') fail("Expected member name");
+                    std::string key = parseString();
+                    expect(':');
+                    object.set(key, parseValue(depth + 1));
+                    skipWhitespace();
+                    if (pos < text.size() && text[pos] == ',') { ++pos; continue; }
+                    expect('}');
+                    return object;
+                }
+            }
+
+            JsonValue parseArray(int depth) {
+                JsonValue array = JsonValue::array();
+                ++pos;
+                skipWhitespace();
+                if (pos < text.size() && text[pos] == ']') {
+                    ++pos;
+                    return array;
+                }
+                for (;;) {
+                    array.push(parseValue(depth + 1));
+                    skipWhitespace();
+                    if (pos < text.size() && text[pos] == ',') { ++pos; continue; }
+                    expect(']');
+                    return array;
+                }
+            }
+
+            double parseNumber() {
+                size_t start = pos;
+                if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) ++pos;
+                while (pos < text.size() && (std::isdigit(static_cast<unsigned char>(text[pos])) ||
+                    text[pos] == '.' || text[pos] == 'e' || text[pos] == 'E' || text[pos] == '-' || text[pos] == '+')) {
+                    ++pos;
+                }
+                if (start == pos) fail("Unexpected character");
+                // 直接在原文上解析，不复制 token（std::string 保证以 '\0' 结尾，strtod 不会越界）
+                char* end = nullptr;
+                double value = std::strtod(text.c_str() + start, &end);
+                if (end != text.c_str() + pos) fail("Malformed number '" + text.substr(start, pos - start) + "'");
+                return value;
+            }
+
+            void appendUtf8(std::string& out, unsigned code) {
+                if (code < 0x80) {
+                    out += static_cast<char>(code);
+                } else if (code < 0x800) {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                } else {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+
+            std::string parseString() {
+                ++pos; // 开头的引号
+                std::string out;
+                while (pos < text.size()) {
+                    char c = text[pos++];
+                    if (c == '"') return out;
+                    if (c != '\\') {
+                        out += c;
+                        continue;
+                    }
+                    if (pos >= text.size()) break;
+                    char e = text[pos++];
+                    switch (e) {
+                    case '"': out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/': out += '/'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u': {
+                        if (pos + 4 > text.size()) fail("Truncated \\u escape");
+                        unsigned code = static_cast<unsigned>(std::strtoul(text.substr(pos, 4).c_str(), nullptr, 16));
+                        pos += 4;
+                        appendUtf8(out, code);
+                        break;
+                    }
+                    default:
+                        fail(std::string("Invalid escape '\\") + e + "'");
+                    }
+                }
+                fail("Unterminated string");
+            }
+
+            const std::string& text;
+            size_t pos = 0;
+        };
+
+        void writeString(std::ostream& out, const std::string& s) {
+            out << '"';
+            for (char c : s) {
+                switch (c) {
+                case '"': out << "\\\""; break;
+                case '\\': out << "\\\\"; break;
+                case '\n': out << "\\n"; break;
+                case '\t': out << "\\t"; break;
+                case '\r': out << "\\r"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char buffer[8];
+                        std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                        out << buffer;
+                    } else {
+                        out << c;
+                    }
+                }
+            }
+            out << '"';
+        }
+
+    } // namespace
+
+    JsonValue JsonValue::parse(const std::string& text) {
+        return Parser(text).parseDocument();
+    }
+
+    JsonValue JsonValue::parseFile(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open JSON file: " + path);
+        }
+        std::ostringstream buffer;
+        buffer << in.rdbuf();
+        std::string text = buffer.str();
+        if (text.size() >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0) text.erase(0, 3);
+        try {
+            return parse(text);
+        }
+        catch (const std::runtime_error& e) {
+            throw std::runtime_error(path + ": " + e.what());
+        }
+    }
+
+    bool JsonValue::asBool() const {
+        if (type != BOOLEAN) throw std::runtime_error("JSON value is not a boolean");
+        return boolean;
+    }
+
+    double JsonValue::asNumber() const {
+        if (type != NUMBER) throw std::runtime_error("JSON value is not a number");
+        return number;
+    }
+
+    const std::string& JsonValue::asString() const {
+        if (type != STRING) throw std::runtime_error("JSON value is not a string");
+        return text;
+    }
+
+    size_t JsonValue::size() const {
+        if (type == ARRAY) return items.size();
+        if (type == OBJECT) return fields.size();
+        return 0;
+    }
+
+    const JsonValue& JsonValue::operator[](size_t i) const {
+        if (type != ARRAY) throw std::runtime_error("JSON value is not an array");
+        if (i >= items.size()) throw std::out_of_range("JSON array index out of range");
+        return items[i];
+    }
+
+    const std::vector<std::pair<std::string, JsonValue>>& JsonValue::members() const {
+        if (type != OBJECT) throw std::runtime_error("JSON value is not an object");
+        return fields;
+    }
+
+    const JsonValue* JsonValue::find(const std::string& key) const {
+        if (type != OBJECT) return nullptr;
+        for (const auto& field : fields) {
+            if (field.first == key) return &field.second;
+        }
+        return nullptr;
+    }
+
+    const JsonValue& JsonValue::at(const std::string& key) const {
+        const JsonValue* value = find(key);
+        if (value == nullptr) throw std::runtime_error("Missing JSON member '" + key + "'");
+        return *value;
+    }
+
+    double JsonValue::numberOr(const std::string& key, double fallback) const {
+        const JsonValue* value = find(key);
+        return value != nullptr ? value->asNumber() : fallback;
+    }
+
+    std::string JsonValue::stringOr(const std::string& key, const std::string& fallback) const {
+        const JsonValue* value = find(key);
+        return value != nullptr ? value->asString() : fallback;
+    }
+
+    void JsonValue::push(JsonValue value) {
+        if (type != ARRAY) throw std::runtime_error("JSON value is not an array");
+        items.push_back(std::move(value));
+    }
+
+    void JsonValue::set(const std::string& key, JsonValue value) {
+        if (type != OBJECT) throw std::runtime_error("JSON value is not an object");
+        for (auto& field : fields) {
+            if (field.first == key) {
+                field.second = std::move(value);
+                return;
+            }
+        }
+        fields.emplace_back(key, std::move(value));
+    }
+
+    void JsonValue::write(std::ostream& out, int indent) const {
+        writeIndented(out, indent, 0);
+        out << '\n';
+    }
+
+    void JsonValue::writeIndented(std::ostream& out, int indent, int depth) const {
+        auto newline = [&](int level) {
+            if (indent > 0) out << '\n' << std::string(static_cast<size_t>(indent * level), ' ');
+        };
+        switch (type) {
+        case NUL: out << "null"; break;
+        case BOOLEAN: out << (boolean ? "true" : "false"); break;
+        case NUMBER: {
+            if (!std::isfinite(number)) { out << "null"; break; }
+            // 取能精确往返的最短表示
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.15g", number);
+            if (std::strtod(buffer, nullptr) != number) std::snprintf(buffer, sizeof(buffer), "%.17g", number);
+            out << buffer;
+            break;
+        }
+        case STRING: writeString(out, text); break;
+        case ARRAY:
+            out << '[';
+            for (size_t i = 0; i < items.size(); ++i) {
+                if (i) out << ',';
+                newline(depth + 1);
+                items[i].writeIndented(out, indent, depth + 1);
+            }
+            if (!items.empty()) newline(depth);
+            out << ']';
+            break;
+        case OBJECT:
+            out << '{';
+            for (size_t i = 0; i < fields.size(); ++i) {
+                if (i) out << ',';
+                newline(depth + 1);
+                writeString(out, fields[i].first);
+                out << (indent > 0 ? ": " : ":");
+                fields[i].second.writeIndented(out, indent, depth + 1);
+            }
+            if (!fields.empty()) newline(depth);
+            out << '}';
+            break;
+        }
+    }
+
+} // namespace Utils
@@ -0,0 +1,101 @@
+﻿#include "utils/SlidingStats.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace Utils {
+
+    SlidingStats::SlidingStats(size_t window) {
+        if (window == 0) throw std::invalid_argument("Sliding window must hold at least one sample");
+        values.assign(window, 0.0);
+        maxQueue.slots.assign(window, Candidate{ 0.0, 0 });
+        minQueue.slots.assign(window, Candidate{ 0.0, 0 });
+    }
+
+    void SlidingStats::clear() {
+        pushed = 0;
+        cursor = 0;
+        filled = 0;
+        average = 0.0;
+        m2 = 0.0;
+        maxQueue.head = maxQueue.size = 0;
+        minQueue.head = minQueue.size = 0;
+    }
+
+    void SlidingStats::push(double x) {
+        const size_t window = values.size();
+        double& slot = values[cursor];
+        if (filled < window) {
+            ++filled;
+            double delta = x - average;
+            average += delta / static_cast<double>(filled);
+            m2 += delta * (x - average);
+        } else {
+            // 以新样本替换最旧的样本
+            double old = slot;
+            double previousMean = average;
+            average += (x - old) / static_cast<double>(window);
+            m2 += (x - old) * (x - average + old - previousMean);
+        }
+        slot = x;
+
+        pushExtremum(maxQueue, x, true);
+        pushExtremum(minQueue, x, false);
+        ++pushed;
+
+        if (++cursor == window) {
+            cursor = 0;
+            resync();
+        }
+    }
+
+    void SlidingStats::pushExtremum(MonotonicQueue& queue, double x, bool keepLarger) {
+        const size_t window = values.size();
+        // 队首已滑出窗口
+        if (queue.size > 0 && queue.slots[queue.head].index + window <= pushed) {
+            if (++queue.head == window) queue.head = 0;
+            --queue.size;
+        }
+        // 队尾不再可能成为极值
+        while (queue.size > 0) {
+            size_t back = queue.head + queue.size - 1;
+            if (back >= window) back -= window;
+            double value = queue.slots[back].value;
+            if (keepLarger ? value > x : value < x) break;
+            --queue.size;
+        }
+        size_t tail = queue.head + queue.size;
+        if (tail >= window) tail -= window;
+        queue.slots[tail] = Candidate{ x, pushed };
+        ++queue.size;
+    }
+
+    void SlidingStats::resync() {
+        double sum = 0.0;
+        for (size_t k = 0; k < filled; ++k) sum += values[k];
+        average = sum / static_cast<double>(filled);
+        double squares = 0.0;
+        for (size_t k = 0; k < filled; ++k) {
+            double d = values[k] - average;
+            squares += d * d;
+        }
+        m2 = squares;
+    }
+
+    double SlidingStats::variance() const {
+        return filled > 0 ? std::max(m2, 0.0) / static_cast<double>(filled) : 0.0;
+    }
+
+    double SlidingStats::stddev() const {
+        return std::sqrt(variance());
+    }
+
+    double SlidingStats::min() const {
+        return minQueue.size > 0 ? minQueue.slots[minQueue.head].value : 0.0;
+    }
+
+    double SlidingStats::max() const {
+        return maxQueue.size > 0 ? maxQueue.slots[maxQueue.head].value : 0.0;
+    }
+
+} // namespace Utils
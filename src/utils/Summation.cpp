@@ -0,0 +1,19 @@
+#include "utils/Summation.h"
+
+namespace Utils {
+
+    double pairwiseReduce(const double* values, size_t count) {
+        if (count == 0) return 0.0;
+        if (count == 1) return values[0];
+        size_t half = count / 2;
+        return pairwiseReduce(values, half) + pairwiseReduce(values + half, count - half);
+    }
+
+    Vector3D pairwiseReduce(const Vector3D* values, size_t count) {
+        if (count == 0) return Vector3D::zero();
+        if (count == 1) return values[0];
+        size_t half = count / 2;
+        return pairwiseReduce(values, half) + pairwiseReduce(values + half, count - half);
+    }
+
+} // namespace Utils
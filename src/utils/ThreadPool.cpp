@@ -0,0 +1,79 @@
+#include "utils/ThreadPool.h"
+#include "utils/Trace.h"
+#include <algorithm>
+#include <exception>
+
+namespace Utils {
+
+    ThreadPool::ThreadPool(size_t numThreads) {
+        if (numThreads == 0) {
+            numThreads = std::thread::hardware_concurrency();
+            if (numThreads == 0) numThreads = 1;
+        }
+        workers.reserve(numThreads);
+        for (size_t i = 0; i < numThreads; ++i) {
+            workers.emplace_back([this, i]() { workerLoop(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        available.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::enqueue(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push(std::move(job));
+        }
+        available.notify_one();
+    }
+
+    void ThreadPool::workerLoop(size_t index) {
+        THREEBODY_TRACE_THREAD_NAME("pool worker " + std::to_string(index));
+        (void)index;
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                available.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop();
+            }
+            THREEBODY_TRACE_SCOPE("task", "pool");
+            job();
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t begin, size_t end, size_t chunkSize,
+        const std::function<void(size_t, size_t)>& body) {
+        if (begin >= end) return;
+        if (chunkSize == 0) chunkSize = 1;
+
+        std::vector<std::future<void>> pending;
+        pending.reserve((end - begin + chunkSize - 1) / chunkSize);
+        for (size_t chunk = begin; chunk < end; chunk += chunkSize) {
+            size_t chunkEnd = std::min(chunk + chunkSize, end);
+            pending.push_back(submit([&body, chunk, chunkEnd]() { body(chunk, chunkEnd); }));
+        }
+        THREEBODY_TRACE_SCOPE("parallel_for_wait", "pool");
+        // 任务引用了 body 和调用者栈上的变量，必须全部结束后才能返回，异常留到最后重新抛出
+        std::exception_ptr failure;
+        for (std::future<void>& f : pending) {
+            try {
+                f.get();
+            } catch (...) {
+                if (!failure) failure = std::current_exception();
+            }
+        }
+        if (failure) std::rethrow_exception(failure);
+    }
+
+} // namespace Utils
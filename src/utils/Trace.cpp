@@ -0,0 +1,180 @@
+﻿#include "utils/Trace.h"
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace Utils {
+namespace Trace {
+
+    namespace detail {
+        std::atomic<bool> enabled(false);
+    }
+
+    namespace {
+
+        using Clock = std::chrono::steady_clock;
+
+        struct Event {
+            const char* name;
+            const char* category;
+            uint64_t begin;   // ns，相对于 start()
+            uint64_t end;
+        };
+
+        // 单生产者环形缓冲区：只有所属线程写入，写完一条后以 release 发布 head。
+        // 创建后大小不再改变；start() 不动旧缓冲区，各线程下次记录时发现代数变了再换新的
+        struct ThreadBuffer {
+            std::vector<Event> events;
+            std::atomic<uint64_t> head{ 0 };
+            uint64_t generation = 0;
+            uint32_t tid = 0;
+            std::string threadName;
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;   // 本代的缓冲区，线程退出后仍保留到下一次 start()
+            size_t capacity = 1 << 16;
+            std::atomic<uint64_t> generation{ 0 };                  // 每次 start() 加一
+            std::atomic<int64_t> originNs{ 0 };                     // start() 时刻，记录线程无锁读取
+        };
+
+        Registry& registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        thread_local std::shared_ptr<ThreadBuffer> localBuffer;
+
+        ThreadBuffer& buffer() {
+            Registry& r = registry();
+            if (!localBuffer || localBuffer->generation != r.generation.load(std::memory_order_acquire)) {
+                std::lock_guard<std::mutex> lock(r.mutex);
+                auto created = std::make_shared<ThreadBuffer>();
+                created->events.resize(r.capacity);
+                created->generation = r.generation.load(std::memory_order_relaxed);
+                created->tid = static_cast<uint32_t>(r.buffers.size() + 1);
+                if (localBuffer) created->threadName = localBuffer->threadName;
+                r.buffers.push_back(created);
+                localBuffer = created;
+            }
+            return *localBuffer;
+        }
+
+        void writeEscaped(std::ostream& out, const std::string& text) {
+            for (char c : text) {
+                if (c == '"' || c == '\\') out << '\\' << c;
+                else if (static_cast<unsigned char>(c) < 0x20) out << ' ';
+                else out << c;
+            }
+        }
+
+    } // namespace
+
+    uint64_t detail::now() {
+        int64_t t = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+        int64_t elapsed = t - registry().originNs.load(std::memory_order_relaxed);
+        return elapsed > 0 ? static_cast<uint64_t>(elapsed) : 0;
+    }
+
+    void detail::record(const char* name, const char* category, uint64_t begin, uint64_t end) {
+        ThreadBuffer& b = buffer();
+        uint64_t h = b.head.load(std::memory_order_relaxed);
+        b.events[h % b.events.size()] = Event{ name, category, begin, end < begin ? begin : end };
+        b.head.store(h + 1, std::memory_order_release);
+    }
+
+    void start(size_t eventsPerThread) {
+        if (eventsPerThread == 0) {
+            throw std::invalid_argument("Trace buffer needs a positive capacity");
+        }
+        Registry& r = registry();
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.capacity = eventsPerThread;
+            r.originNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now().time_since_epoch()).count(), std::memory_order_relaxed);
+            // 其他线程可能仍在写自己的旧缓冲区，这里只把它们移出登记表（由 shared_ptr 保活）
+            r.buffers.clear();
+            r.generation.fetch_add(1, std::memory_order_release);
+        }
+        detail::enabled.store(true, std::memory_order_release);
+    }
+
+    void stop() {
+        detail::enabled.store(false, std::memory_order_release);
+    }
+
+    void setThreadName(const std::string& name) {
+        ThreadBuffer& b = buffer();
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        b.threadName = name;
+    }
+
+    uint64_t droppedEvents() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        uint64_t dropped = 0;
+        for (const auto& b : r.buffers) {
+            uint64_t h = b->head.load(std::memory_order_acquire);
+            if (h > b->events.size()) dropped += h - b->events.size();
+        }
+        return dropped;
+    }
+
+    void writeChromeTrace(std::ostream& out) {
+        // 记录线程写环形缓冲区不加锁，边记录边导出会读到写了一半的事件
+        if (isEnabled()) {
+            throw std::logic_error("writeChromeTrace requires tracing to be stopped");
+        }
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+
+        out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+        bool first = true;
+        uint64_t dropped = 0;
+        char number[64];
+        for (const auto& b : r.buffers) {
+            uint64_t h = b->head.load(std::memory_order_acquire);
+            uint64_t capacity = b->events.size();
+            uint64_t count = h < capacity ? h : capacity;
+            dropped += h - count;
+            if (count == 0 && b->threadName.empty()) continue;
+
+            if (!b->threadName.empty()) {
+                out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << b->tid
+                    << ",\"args\":{\"name\":\"";
+                writeEscaped(out, b->threadName);
+                out << "\"}}";
+                first = false;
+            }
+            for (uint64_t k = h - count; k < h; ++k) {
+                const Event& e = b->events[k % capacity];
+                // ts / dur 以微秒为单位，保留纳秒精度
+                std::snprintf(number, sizeof(number), "%.3f,\"dur\":%.3f",
+                    e.begin * 1e-3, (e.end - e.begin) * 1e-3);
+                out << (first ? "" : ",\n") << "{\"name\":\"" << e.name << "\",\"cat\":\"" << e.category
+                    << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << b->tid << ",\"ts\":" << number << '}';
+                first = false;
+            }
+        }
+        out << "\n],\"otherData\":{\"dropped_events\":" << dropped << "}}\n";
+    }
+
+    void saveChromeTrace(const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot open trace file for writing: " + path);
+        }
+        writeChromeTrace(out);
+        if (!out) {
+            throw std::runtime_error("Failed writing trace file: " + path);
+        }
+    }
+
+} // namespace Trace
+} // namespace Utils
@@ -0,0 +1,409 @@
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include "simulation/Calendar.h"
+#include "simulation/CalendarService.h"
+#include "simulation/Ephemeris.h"
+#include "simulation/EraClassifier.h"
+#include "simulation/IncrementalCalendar.h"
+#include "simulation/Insolation.h"
+#include "utils/LruCache.h"
+#include "utils/SlidingStats.h"
+#include "utils/ThreadPool.h"
+#include "physics/PhysicsConstants.h"
+
+#define ASSERT(cond, msg) \
+    do { if (!(cond)) { std::cerr << "ASSERT FAILED: " << msg << " (" << __FILE__ << ":" << __LINE__ << ")\n"; return 1; } } while(0)
+
+// Planet (index 0) on a circular 1 AU orbit around a solar-mass sun (index 1) at the origin.
+static const double R = PhysicsConstants::AU;
+static const double V = std::sqrt(PhysicsConstants::G * PhysicsConstants::SOLAR_MASS / R);
+static const double W = V / R;
+
+static void circularSystem(double t, Physics::SystemState& state) {
+    state.positions.assign(2, Vector3D::zero());
+    state.velocities.assign(2, Vector3D::zero());
+    state.positions[0] = Vector3D(R * std::cos(W * t), R * std::sin(W * t), 0.0);
+    state.velocities[0] = Vector3D(-V * std::sin(W * t), V * std::cos(W * t), 0.0);
+    state.time = t;
+}
+
+static const std::vector<double> MASSES = { PhysicsConstants::EARTH_MASS, PhysicsConstants::SOLAR_MASS };
+
+static std::string readBytes(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void writeBytes(const std::string& path, const std::string& bytes) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+int test_lru_cache_evicts_least_recently_used() {
+    Utils::LruCache<int, int> cache(2);
+    cache.put(1, 10);
+    cache.put(2, 20);
+    int value = 0;
+    ASSERT(cache.get(1, value) && value == 10, "Expected hit for key 1");
+    cache.put(3, 30);
+    ASSERT(!cache.get(2, value), "Key 2 should have been evicted");
+    ASSERT(cache.get(1, value) && cache.get(3, value), "Keys 1 and 3 should remain");
+    ASSERT(cache.size() == 2, "Cache size should stay at capacity");
+    return 0;
+}
+
+int test_one_sunrise_per_day_in_stable_orbit() {
+    Simulation::CalendarConfig config;
+    Simulation::CalendarCalculator calendar(config, MASSES, circularSystem);
+
+    std::vector<Simulation::CalendarEvent> events = calendar.generate(0.0, 10.0 * PhysicsConstants::DAY_SECONDS);
+    int sunrises = 0, sunsets = 0, eraChanges = 0;
+    for (const auto& e : events) {
+        if (e.type == Simulation::CalendarEventType::SUNRISE) ++sunrises;
+        if (e.type == Simulation::CalendarEventType::SUNSET) ++sunsets;
+        if (e.type == Simulation::CalendarEventType::ERA_CHANGE) ++eraChanges;
+    }
+    ASSERT(sunrises >= 9 && sunrises <= 10, "Expected about ten sunrises, got " << sunrises);
+    ASSERT(sunsets >= 9 && sunsets <= 10, "Expected about ten sunsets, got " << sunsets);
+    ASSERT(eraChanges == 0, "Circular orbit should stay in one era");
+    ASSERT(calendar.eraAt(0.0) == Simulation::EraType::STABLE, "Circular orbit should be a stable era");
+
+    Simulation::CalendarEvent next;
+    ASSERT(calendar.findNextSunrise(0.0, 2.0 * PhysicsConstants::DAY_SECONDS, next), "No sunrise found");
+    Physics::SystemState state;
+    circularSystem(next.time, state);
+    ASSERT(std::fabs(calendar.sunElevation(state, 0)) < 1e-3, "Sunrise should be on the horizon");
+    return 0;
+}
+
+int test_two_equal_suns_is_chaotic() {
+    std::vector<double> masses = { PhysicsConstants::EARTH_MASS, PhysicsConstants::SOLAR_MASS, PhysicsConstants::SOLAR_MASS };
+    Simulation::CalendarConfig config;
+    Simulation::CalendarCalculator calendar(config, masses, [](double t, Physics::SystemState& state) {
+        state.positions = { Vector3D::zero(), Vector3D(R, 0, 0), Vector3D(-R, 0, 0) };
+        state.velocities.assign(3, Vector3D::zero());
+        state.time = t;
+    });
+    ASSERT(calendar.eraAt(0.0) == Simulation::EraType::CHAOTIC, "Equal illumination from two suns should be chaotic");
+
+    // Non-positive scan parameters would stall the scanning loops.
+    for (int field = 0; field < 4; ++field) {
+        Simulation::CalendarConfig bad;
+        if (field == 0) bad.rotationPeriod = 0.0;
+        if (field == 1) bad.scanStepsPerRotation = -1;
+        if (field == 2) bad.timeTolerance = std::nan("");
+        if (field == 3) bad.eraScanStep = -1.0;
+        bool threw = false;
+        try {
+            Simulation::CalendarCalculator rejected(bad, masses, [](double, Physics::SystemState&) {});
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        ASSERT(threw, "Invalid calendar config field " << field << " was accepted");
+    }
+    return 0;
+}
+
+int test_service_answers_requests() {
+    std::vector<Physics::SystemState> trajectory;
+    for (double t = 0.0; t <= 20.0 * PhysicsConstants::DAY_SECONDS; t += 3600.0) {
+        Physics::SystemState s;
+        circularSystem(t, s);
+        trajectory.push_back(s);
+    }
+    const char* path = "CalendarTests_service.bin";
+    Simulation::Ephemeris::fit(trajectory, { "Planet", "Sun" }, MASSES).save(path);
+
+    {
+        Simulation::CalendarConfig config;
+        Simulation::CalendarService service(path, config, 16);
+
+        ASSERT(service.handle("7 STATE 1000").rfind("7 OK STATE 1000 Planet", 0) == 0, "STATE response malformed");
+        ASSERT(service.handle("8 NEXT_SUNRISE 0").rfind("8 OK SUNRISE:", 0) == 0, "NEXT_SUNRISE response malformed");
+        ASSERT(service.handle("9 NEXT_ERA 0") == "9 OK NONE", "Stable orbit should have no era change");
+        ASSERT(service.handle("10 CALENDAR 0 86400").rfind("10 OK CALENDAR STABLE 2", 0) == 0, "CALENDAR response malformed");
+        ASSERT(service.handle("11 STATE 1e12").rfind("11 ERROR", 0) == 0, "Out-of-range query should fail");
+        ASSERT(service.handle("12 BOGUS").rfind("12 ERROR", 0) == 0, "Unknown command should fail");
+        service.setMaxCalendarSpan(2.0 * PhysicsConstants::DAY_SECONDS);
+        ASSERT(service.handle("13 CALENDAR 0 864000").rfind("13 ERROR", 0) == 0, "Over-long CALENDAR span should fail");
+        ASSERT(service.handle("14 CALENDAR 0 86400").rfind("14 OK", 0) == 0, "Spans within the limit are served");
+        // The sun rises once a day; a horizon of a quarter rotation can miss it.
+        service.setSunriseHorizon(0.25);
+        bool missed = false;
+        for (int hour = 0; hour < 24 && !missed; hour += 3) {
+            missed = service.handle("15 NEXT_SUNRISE " + std::to_string(hour * 3600)) == "15 OK NONE";
+        }
+        ASSERT(missed, "NEXT_SUNRISE should give up past the horizon");
+        service.setSunriseHorizon(100.0);
+
+        std::istringstream in("1 STATE 0\n2 STATE 10\n3 NEXT_SUNRISE 5\nQUIT\n4 STATE 0\n");
+        std::ostringstream out;
+        service.serve(in, out, 2);
+        std::istringstream lines(out.str());
+        std::string line;
+        int count = 0;
+        while (std::getline(lines, line)) ++count;
+        ASSERT(count == 3, "Expected three responses before QUIT, got " << count);
+        ASSERT(service.getEphemeris().getCache().size() > 0, "Segment cache should be populated");
+    }
+    std::remove(path);
+    return 0;
+}
+
+int test_incremental_calendar_never_reintegrates() {
+    const double day = PhysicsConstants::DAY_SECONDS;
+    const char* path = "CalendarTests_incremental.bin";
+    const std::string eventsPath = std::string(path) + ".events";
+    std::remove(path);
+    std::remove(eventsPath.c_str());
+
+    Physics::SystemState initial;
+    circularSystem(0.0, initial);
+    Simulation::CalendarConfig config;
+
+    size_t eventsUpTo8Days = 0;
+    {
+        Simulation::IncrementalCalendar calendar(initial, MASSES, config, 600.0,
+            Physics::Integrator::RUNGE_KUTTA_4, path);
+        std::vector<Simulation::CalendarEvent> first = calendar.generate(0.0, 5.0 * day);
+        size_t steps = calendar.getStepsIntegrated();
+        ASSERT(steps == 720, "Expected 720 steps for five days, got " << steps);
+        ASSERT(first.size() >= 9, "Expected sunrises and sunsets in the first five days");
+
+        calendar.generate(2.0 * day, 4.0 * day);
+        ASSERT(calendar.getStepsIntegrated() == steps, "Covered range must not be re-integrated");
+
+        calendar.generate(3.0 * day, 8.0 * day);
+        ASSERT(calendar.getStepsIntegrated() == 1152, "Extension should integrate only the new three days");
+        ASSERT(calendar.eraAt(7.0 * day) == Simulation::EraType::STABLE, "Two-body orbit should stay stable");
+        eventsUpTo8Days = calendar.generate(0.0, 8.0 * day).size();
+    }
+
+    Simulation::IncrementalCalendar reloaded(initial, MASSES, config, 600.0,
+        Physics::Integrator::RUNGE_KUTTA_4, path);
+    ASSERT(reloaded.getCoveredUntil() >= 8.0 * PhysicsConstants::DAY_SECONDS, "Coverage should be restored from cache");
+    ASSERT(reloaded.generate(0.0, 8.0 * day).size() == eventsUpTo8Days, "Reloaded events differ");
+    ASSERT(reloaded.getStepsIntegrated() == 0, "Reloaded calendar should not integrate covered time");
+
+    // Extending a reloaded calendar appends the new events instead of rewriting the history:
+    // a marker planted in the first stored event (after the 16-byte header) survives.
+    std::string eventsUpTo8DaysBytes = readBytes(eventsPath);
+    eventsUpTo8DaysBytes[16] ^= 0x01;
+    writeBytes(eventsPath, eventsUpTo8DaysBytes);
+    reloaded.generate(0.0, 10.0 * day);
+    const std::string eventsUpTo10DaysBytes = readBytes(eventsPath);
+    ASSERT(eventsUpTo10DaysBytes.size() > eventsUpTo8DaysBytes.size() &&
+        eventsUpTo10DaysBytes.compare(0, eventsUpTo8DaysBytes.size(), eventsUpTo8DaysBytes) == 0,
+        "Extension should only append to the event file");
+
+    // A cache written for other inputs is ignored.
+    Simulation::CalendarConfig brighter = config;
+    brighter.luminosities = { 2.0 * PhysicsConstants::SOLAR_LUMINOSITY };
+    Simulation::IncrementalCalendar otherConfig(initial, MASSES, brighter, 600.0,
+        Physics::Integrator::RUNGE_KUTTA_4, path);
+    ASSERT(otherConfig.getCoveredUntil() == 0.0, "Cache from a different calendar config was reused");
+    std::vector<double> heavier = MASSES;
+    heavier[0] *= 1.01;
+    Simulation::IncrementalCalendar otherMasses(initial, heavier, config, 600.0,
+        Physics::Integrator::RUNGE_KUTTA_4, path);
+    ASSERT(otherMasses.getCoveredUntil() == 0.0, "Cache from different masses was reused");
+
+    // Events appended by a save that never got to replace the state file are ignored.
+    reloaded.save(path);
+    const std::string state = readBytes(path);
+    writeBytes(eventsPath, eventsUpTo10DaysBytes + std::string(100, '\x7f'));
+    {
+        Simulation::IncrementalCalendar interrupted(initial, MASSES, config, 600.0,
+            Physics::Integrator::RUNGE_KUTTA_4, path);
+        std::vector<Simulation::CalendarEvent> restored = interrupted.generate(0.0, 10.0 * day);
+        std::vector<Simulation::CalendarEvent> expected = reloaded.generate(0.0, 10.0 * day);
+        ASSERT(interrupted.getStepsIntegrated() == 0 && restored.size() == expected.size() &&
+            restored.back().time == expected.back().time, "Trailing bytes in the event file should be ignored");
+    }
+
+    // A truncated cache is treated as missing instead of failing construction.
+    writeBytes(path, state.substr(0, state.size() / 2));
+    Simulation::IncrementalCalendar truncated(initial, MASSES, config, 600.0,
+        Physics::Integrator::RUNGE_KUTTA_4, path);
+    ASSERT(truncated.getCoveredUntil() == 0.0, "Truncated cache should be ignored");
+    writeBytes(path, state);
+    writeBytes(eventsPath, eventsUpTo10DaysBytes.substr(0, eventsUpTo10DaysBytes.size() / 2));
+    Simulation::IncrementalCalendar truncatedEvents(initial, MASSES, config, 600.0,
+        Physics::Integrator::RUNGE_KUTTA_4, path);
+    ASSERT(truncatedEvents.getCoveredUntil() == 0.0, "Truncated event file should be ignored");
+    std::remove(path);
+    std::remove(eventsPath.c_str());
+    return 0;
+}
+
+int test_insolation_timeline_streams_in_order() {
+    const double day = PhysicsConstants::DAY_SECONDS;
+    const double pi = 3.14159265358979323846;
+    Simulation::CalendarConfig config;
+    Simulation::InsolationOptions options;
+    options.endTime = 30.0 * day;
+    options.outputStep = 3600.0;
+    options.chunkSamples = 100;
+    Simulation::InsolationTimeline timeline(config, MASSES, options, circularSystem);
+    ASSERT(timeline.sampleCount() == 721, "Expected 721 hourly samples, got " << timeline.sampleCount());
+
+    std::vector<double> serial;
+    timeline.generate([&](const Simulation::InsolationChunk& chunk) {
+        for (size_t i = 0; i < chunk.sampleCount; ++i) {
+            serial.push_back(chunk.time[i]);
+            serial.push_back(chunk.totalFlux[i]);
+            serial.push_back(chunk.phaseOf(0, i));
+        }
+    });
+    ASSERT(serial.size() == 3 * 721, "Every sample should reach the sink once");
+
+    const double solarConstant = PhysicsConstants::SOLAR_LUMINOSITY / (4.0 * pi * R * R);
+    for (size_t i = 0; i < 721; ++i) {
+        double t = serial[3 * i];
+        ASSERT(t == timeline.sampleTime(i), "Samples out of order at " << i);
+        ASSERT(std::fabs(serial[3 * i + 1] / solarConstant - 1.0) < 1e-12, "Flux off at " << t);
+        // The sun sits at the origin, so seen from the planet it leads the orbital angle by pi.
+        double expected = std::remainder(W * t + pi, 2.0 * pi);
+        ASSERT(std::fabs(std::remainder(serial[3 * i + 2] - expected, 2.0 * pi)) < 1e-9, "Phase off at " << t);
+    }
+
+    Utils::ThreadPool pool(3);
+    std::vector<double> parallel;
+    size_t expectedFirst = 0;
+    bool ordered = true;
+    timeline.generate([&](const Simulation::InsolationChunk& chunk) {
+        ordered = ordered && chunk.firstSample == expectedFirst;
+        expectedFirst += chunk.sampleCount;
+        for (size_t i = 0; i < chunk.sampleCount; ++i) {
+            parallel.push_back(chunk.time[i]);
+            parallel.push_back(chunk.totalFlux[i]);
+            parallel.push_back(chunk.phaseOf(0, i));
+        }
+    }, &pool);
+    ASSERT(ordered, "Parallel chunks must reach the sink in time order");
+    ASSERT(parallel == serial, "Parallel timeline differs from serial");
+
+    std::ostringstream csv, binary;
+    Simulation::InsolationWriter csvWriter(csv, Simulation::InsolationFormat::CSV, { "Sun" });
+    Simulation::InsolationWriter binaryWriter(binary, Simulation::InsolationFormat::BINARY, { "Sun" });
+    timeline.generate([&](const Simulation::InsolationChunk& chunk) {
+        csvWriter(chunk);
+        binaryWriter(chunk);
+    }, &pool);
+    std::string text = csv.str();
+    ASSERT(text.compare(0, 47, "time,total_flux,Sun_distance,Sun_flux,Sun_phase") == 0, "Unexpected CSV header");
+    ASSERT(std::count(text.begin(), text.end(), '\n') == 722, "CSV should have a header plus one row per sample");
+    ASSERT(binary.str().size() == 8 + 4 + 4 + 3 + 721 * 5 * sizeof(double), "Unexpected binary size");
+    ASSERT(binaryWriter.getRowsWritten() == 721, "Writer should count rows");
+    return 0;
+}
+
+int test_sliding_stats_match_brute_force() {
+    const size_t window = 7;
+    Utils::SlidingStats stats(window);
+    std::vector<double> history;
+    unsigned long long seed = 42;
+    for (int i = 0; i < 1000; ++i) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        double x = static_cast<double>(seed >> 11) / 9007199254740992.0 + 1e3 * (i / 250);
+        stats.push(x);
+        history.push_back(x);
+
+        size_t n = std::min(history.size(), window);
+        double sum = 0.0, lo = history.back(), hi = history.back();
+        for (size_t k = history.size() - n; k < history.size(); ++k) {
+            sum += history[k];
+            lo = std::min(lo, history[k]);
+            hi = std::max(hi, history[k]);
+        }
+        double mean = sum / n, squares = 0.0;
+        for (size_t k = history.size() - n; k < history.size(); ++k) squares += (history[k] - mean) * (history[k] - mean);
+        ASSERT(stats.count() == n, "Window size wrong at " << i);
+        ASSERT(std::fabs(stats.mean() - mean) < 1e-9 * (1.0 + std::fabs(mean)), "Mean off at " << i);
+        ASSERT(std::fabs(stats.variance() - squares / n) < 1e-6, "Variance off at " << i);
+        ASSERT(stats.min() == lo && stats.max() == hi, "Extrema off at " << i);
+    }
+    return 0;
+}
+
+// Planet on the 1 AU circular orbit of circularSystem, with a second sun that is far away except
+// during [from, to), when it sits as close to the planet as the first sun.
+static void companionSystem(double t, Physics::SystemState& state, double from, double to) {
+    Physics::SystemState orbit;
+    circularSystem(t, orbit);
+    state.positions = { orbit.positions[0], orbit.positions[1], Vector3D(1000.0 * R, 0, 0) };
+    state.velocities = { orbit.velocities[0], orbit.velocities[1], Vector3D::zero() };
+    if (t >= from && t < to) state.positions[2] = orbit.positions[0] * 2.0;
+    state.time = t;
+}
+
+int test_era_classifier_streams_boundaries() {
+    const double day = PhysicsConstants::DAY_SECONDS;
+    std::vector<double> masses = { PhysicsConstants::EARTH_MASS, PhysicsConstants::SOLAR_MASS, PhysicsConstants::SOLAR_MASS };
+    Simulation::CalendarConfig calendar;
+    Simulation::EraClassifierConfig config;
+    config.window = 48;
+    std::vector<Simulation::CalendarEvent> events;
+    Simulation::EraClassifier classifier(calendar, masses, config,
+        [&events](const Simulation::CalendarEvent& e) { events.push_back(e); });
+
+    Physics::SystemState state;
+    for (double t = 0.0; t <= 60.0 * day; t += 3600.0) {
+        companionSystem(t, state, 20.0 * day, 30.0 * day);
+        classifier.push(state);
+        if (t == 10.0 * day) {
+            ASSERT(std::fabs(classifier.distanceStats(0).mean() / R - 1.0) < 1e-12, "Distance to the near sun should be 1 AU");
+            ASSERT(classifier.eccentricityStats().max() < 1e-5, "Circular orbit should have near-zero eccentricity");
+        }
+    }
+
+    ASSERT(events.size() == 3, "Expected stable, chaotic, stable; got " << events.size() << " boundaries");
+    ASSERT(events[0].era == Simulation::EraType::STABLE && events[0].time == 0.0, "First era should start stable at t=0");
+    ASSERT(events[1].era == Simulation::EraType::CHAOTIC && events[1].time == 20.0 * day,
+        "Chaotic era should start when the companion arrives, got " << events[1].time / day);
+    ASSERT(events[2].era == Simulation::EraType::STABLE &&
+        events[2].time >= 30.0 * day && events[2].time <= 30.0 * day + 49.0 * 3600.0,
+        "Stable era should return within one window after the companion leaves, got " << events[2].time / day);
+    ASSERT(classifier.currentEra() == Simulation::EraType::STABLE, "Classifier should end stable");
+    ASSERT(classifier.getStepsConsumed() == 1441, "Every step should be consumed once");
+    return 0;
+}
+
+int main() {
+    struct Test { const char* name; int(*func)(); };
+    Test tests[] = {
+        {"lru_cache_evicts_least_recently_used", test_lru_cache_evicts_least_recently_used},
+        {"one_sunrise_per_day_in_stable_orbit", test_one_sunrise_per_day_in_stable_orbit},
+        {"two_equal_suns_is_chaotic", test_two_equal_suns_is_chaotic},
+        {"service_answers_requests", test_service_answers_requests},
+        {"incremental_calendar_never_reintegrates", test_incremental_calendar_never_reintegrates},
+        {"insolation_timeline_streams_in_order", test_insolation_timeline_streams_in_order},
+        {"sliding_stats_match_brute_force", test_sliding_stats_match_brute_force},
+        {"era_classifier_streams_boundaries", test_era_classifier_streams_boundaries}
+    };
+
+    int failed = 0;
+    for (auto &t : tests) {
+        std::cout << "[ RUN      ] " << t.name << std::endl;
+        int r = t.func();
+        if (r == 0) {
+            std::cout << "[       OK ] " << t.name << std::endl;
+        } else {
+            std::cout << "[  FAILED  ] " << t.name << std::endl;
+            ++failed;
+        }
+    }
+
+    if (failed == 0) {
+        std::cout << "ALL TESTS PASSED\n";
+        return 0;
+    } else {
+        std::cerr << failed << " test(s) failed\n";
+        return 1;
+    }
+}
@@ -0,0 +1,175 @@
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <stdexcept>
+#include "simulation/Ephemeris.h"
+#include "physics/PhysicsConstants.h"
+#include "core/Vector3D.h"
+
+#define ASSERT(cond, msg) \
+    do { if (!(cond)) { std::cerr << "ASSERT FAILED: " << msg << " (" << __FILE__ << ":" << __LINE__ << ")\n"; return 1; } } while(0)
+
+// Analytic circular orbit of radius R and period P, plus a body at rest.
+static const double R = PhysicsConstants::AU;
+static const double P = PhysicsConstants::yearsToSeconds(1.0);
+static const double W = 2.0 * 3.14159265358979323846 / P;
+
+static void circularState(double t, Vector3D& pos, Vector3D& vel) {
+    pos = Vector3D(R * std::cos(W * t), R * std::sin(W * t), 0.0);
+    vel = Vector3D(-R * W * std::sin(W * t), R * W * std::cos(W * t), 0.0);
+}
+
+static std::vector<Physics::SystemState> makeTrajectory(double span, double dt) {
+    std::vector<Physics::SystemState> trajectory;
+    for (double t = 0.0; t <= span + 0.5 * dt; t += dt) {
+        Physics::SystemState s(2);
+        s.time = t;
+        circularState(t, s.positions[0], s.velocities[0]);
+        s.positions[1] = Vector3D(1.0, 2.0, 3.0);
+        trajectory.push_back(s);
+    }
+    return trajectory;
+}
+
+static Simulation::Ephemeris makeEphemeris() {
+    Simulation::EphemerisFitOptions options;
+    options.positionTolerance = 10.0;
+    return Simulation::Ephemeris::fit(makeTrajectory(P, PhysicsConstants::DAY_SECONDS / 4.0),
+        { "Planet", "Sun" }, { PhysicsConstants::EARTH_MASS, PhysicsConstants::SOLAR_MASS }, options);
+}
+
+int test_fit_reproduces_orbit_between_samples() {
+    Simulation::Ephemeris eph = makeEphemeris();
+    for (double t = 1234.5; t < P; t += 3.7 * PhysicsConstants::DAY_SECONDS) {
+        Vector3D pos, vel, expectedPos, expectedVel;
+        eph.evaluate(0, t, pos, vel);
+        circularState(t, expectedPos, expectedVel);
+        ASSERT((pos - expectedPos).magnitude() < 100.0, "Position error too large at t=" << t);
+        ASSERT((vel - expectedVel).magnitude() < 1e-3, "Velocity error too large at t=" << t);
+    }
+    return 0;
+}
+
+int test_segments_adapt_to_tolerance() {
+    Simulation::Ephemeris eph = makeEphemeris();
+    const Simulation::BodyEphemeris& planet = eph.getBody(0);
+    const Simulation::BodyEphemeris& sun = eph.getBody(1);
+    size_t granules = planet.granuleIndex.size() - 1;
+    ASSERT(sun.segmentCount() == granules, "Static body should need one segment per granule");
+    ASSERT(planet.segmentCount() >= granules, "Planet segment count below granule count");
+    return 0;
+}
+
+int test_save_load_roundtrip() {
+    Simulation::Ephemeris eph = makeEphemeris();
+    const char* path = "EphemerisTests_roundtrip.bin";
+    eph.save(path);
+    Simulation::Ephemeris loaded = Simulation::Ephemeris::load(path);
+    std::remove(path);
+
+    ASSERT(loaded.getBodyCount() == 2, "Body count mismatch after load");
+    ASSERT(loaded.findBody("Sun") == 1, "Body name lookup failed after load");
+    ASSERT(loaded.getBody(0).mass == PhysicsConstants::EARTH_MASS, "Mass mismatch after load");
+
+    Vector3D p1, v1, p2, v2;
+    double t = 0.3 * P;
+    eph.evaluate(0, t, p1, v1);
+    loaded.evaluate(0, t, p2, v2);
+    ASSERT(p1.x == p2.x && p1.y == p2.y && v1.x == v2.x, "Loaded ephemeris evaluates differently");
+    return 0;
+}
+
+int test_corrupt_files_are_rejected() {
+    const char* path = "EphemerisTests_corrupt.bin";
+    makeEphemeris().save(path);
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    auto field = [&bytes](size_t offset, auto value) {
+        std::string patched = bytes;
+        std::memcpy(&patched[offset], &value, sizeof(value));
+        return patched;
+    };
+    auto rejected = [path](const std::string& content) {
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out.write(content.data(), static_cast<std::streamsize>(content.size()));
+        }
+        try {
+            Simulation::Ephemeris::load(path);
+        } catch (const std::runtime_error&) {
+            return true;
+        }
+        return false;
+    };
+
+    // Header: magic(8) version(4) bodies(4) degree(4) granules(4) start(8) end(8) granule(8).
+    // Then "Planet": name length(4) name(6) mass(8) segments(4), and "Sun" (19 bytes).
+    uint32_t granules, segments;
+    std::memcpy(&granules, &bytes[20], 4);
+    std::memcpy(&segments, &bytes[66], 4);
+    const size_t granuleIndex = 89 + (segments + 1) * 8;
+
+    ASSERT(rejected(field(16, int32_t(-1))), "Negative degree accepted");
+    ASSERT(rejected(field(16, int32_t(1000))), "Huge degree accepted");
+    ASSERT(rejected(field(40, 0.0)), "Zero granule accepted");
+    ASSERT(rejected(field(40, std::nan(""))), "NaN granule accepted");
+    ASSERT(rejected(field(32, 0.0)), "Empty time span accepted");
+    ASSERT(rejected(field(66, uint32_t(0x7fffffff))), "Huge segment count accepted");
+    ASSERT(rejected(field(granuleIndex + 4, uint32_t(0xffffffff))), "Out-of-range granule index accepted");
+    ASSERT(rejected(field(granuleIndex + granules * 4, segments - 1)), "Granule index not ending at the segment count accepted");
+    ASSERT(rejected(bytes.substr(0, bytes.size() - 8)), "Truncated coefficients accepted");
+    ASSERT(!rejected(bytes), "The intact file should still load");
+    std::remove(path);
+    return 0;
+}
+
+int test_out_of_range_throws() {
+    Simulation::Ephemeris eph = makeEphemeris();
+    Vector3D pos, vel;
+    try {
+        eph.evaluate(0, 2.0 * P, pos, vel);
+    } catch (const std::out_of_range&) {
+        return 0;
+    }
+    ASSERT(false, "Evaluation outside coverage should throw");
+    return 1;
+}
+
+int main() {
+    struct Test { const char* name; int(*func)(); };
+    Test tests[] = {
+        {"fit_reproduces_orbit_between_samples", test_fit_reproduces_orbit_between_samples},
+        {"segments_adapt_to_tolerance", test_segments_adapt_to_tolerance},
+        {"save_load_roundtrip", test_save_load_roundtrip},
+        {"corrupt_files_are_rejected", test_corrupt_files_are_rejected},
+        {"out_of_range_throws", test_out_of_range_throws}
+    };
+
+    int failed = 0;
+    for (auto &t : tests) {
+        std::cout << "[ RUN      ] " << t.name << std::endl;
+        int r = t.func();
+        if (r == 0) {
+            std::cout << "[       OK ] " << t.name << std::endl;
+        } else {
+            std::cout << "[  FAILED  ] " << t.name << std::endl;
+            ++failed;
+        }
+    }
+
+    if (failed == 0) {
+        std::cout << "ALL TESTS PASSED\n";
+        return 0;
+    } else {
+        std::cerr << failed << " test(s) failed\n";
+        return 1;
+    }
+}
@@ -1,9 +1,15 @@
 #include <iostream>
+#include <algorithm>
 #include <cmath>
+#include <sstream>
 #include "physics/GravityEngine.h"
+#include "physics/ChaosIndicator.h"
+#include "physics/ConservationMonitor.h"
+#include "physics/EjectionDetector.h"
 #include "physics/PhysicsConstants.h"
 #include "physics/Integrator.h"
 #include "core/Vector3D.h"
+#include "utils/ThreadPool.h"
 
 static bool approxEqualDouble(double a, double b, double relTol = 1e-9, double absTol = 1e-12) {
     double diff = std::fabs(a - b);
@@ -107,6 +113,409 @@ int test_calculateGravitationalDerivatives_basic() {
     return 0;
 }
 
+// Deterministic pseudo-random cluster of n solar-mass bodies within ~10 AU.
+static void makeCluster(size_t n, std::vector<Vector3D>& positions, std::vector<Vector3D>& velocities, std::vector<double>& masses) {
+    unsigned long long seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>(seed >> 11) / 9007199254740992.0 - 0.5;
+    };
+    positions.resize(n); velocities.resize(n); masses.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        positions[i] = Vector3D(next(), next(), next()) * (20.0 * PhysicsConstants::AU);
+        velocities[i] = Vector3D(next(), next(), next()) * 3.0e4;
+        masses[i] = PhysicsConstants::SOLAR_MASS * (0.5 + next());
+    }
+}
+
+int test_reproducible_reductions_independent_of_thread_count() {
+    std::vector<Vector3D> positions, velocities;
+    std::vector<double> masses;
+    makeCluster(1500, positions, velocities, masses);
+
+    Utils::SummationMode modes[] = { Utils::SummationMode::NAIVE, Utils::SummationMode::KAHAN, Utils::SummationMode::PAIRWISE };
+    for (Utils::SummationMode mode : modes) {
+        Physics::ExecutionPolicy serial;
+        serial.summation = mode;
+        serial.blockSize = 64;
+        double energy = Physics::GravityEngine::calculateTotalEnergy(positions, velocities, masses, serial);
+        Vector3D momentum = Physics::GravityEngine::calculateTotalMomentum(velocities, masses, serial);
+
+        size_t threadCounts[] = { 1, 3, 8 };
+        for (size_t threads : threadCounts) {
+            Utils::ThreadPool pool(threads);
+            Physics::ExecutionPolicy parallel = serial;
+            parallel.pool = &pool;
+            double e = Physics::GravityEngine::calculateTotalEnergy(positions, velocities, masses, parallel);
+            Vector3D p = Physics::GravityEngine::calculateTotalMomentum(velocities, masses, parallel);
+            ASSERT(e == energy, "Energy not bit-identical with " << threads << " threads");
+            ASSERT(p.x == momentum.x && p.y == momentum.y && p.z == momentum.z,
+                "Momentum not bit-identical with " << threads << " threads");
+        }
+
+        double reference = Physics::GravityEngine::calculateTotalEnergy(positions, velocities, masses);
+        ASSERT(approxEqualDouble(energy, reference, 1e-10), "Blocked energy deviates from serial reference");
+    }
+    return 0;
+}
+
+int test_parallel_derivatives_match_serial() {
+    using namespace Physics;
+    std::vector<Vector3D> positions, velocities;
+    std::vector<double> masses;
+    makeCluster(300, positions, velocities, masses);
+
+    SystemState state(positions.size()), serial(positions.size()), parallel(positions.size());
+    state.positions = positions;
+    state.velocities = velocities;
+
+    GravityEngine::calculateGravitationalDerivatives(state, serial, masses);
+
+    Utils::ThreadPool pool(4);
+    ExecutionPolicy policy;
+    policy.pool = &pool;
+    policy.blockSize = 16;
+    GravityEngine::calculateGravitationalDerivatives(state, parallel, masses, policy);
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        ASSERT(parallel.velocities[i].x == serial.velocities[i].x &&
+               parallel.velocities[i].y == serial.velocities[i].y &&
+               parallel.velocities[i].z == serial.velocities[i].z,
+               "Parallel acceleration differs for body " << i);
+        ASSERT(approxEqualVec(parallel.positions[i], velocities[i]), "Position derivative should equal velocity");
+    }
+    return 0;
+}
+
+int test_mixed_precision_matches_double_within_float_accuracy() {
+    using namespace Physics;
+    std::vector<Vector3D> positions, velocities;
+    std::vector<double> masses;
+    makeCluster(700, positions, velocities, masses);
+
+    SystemState state(positions.size()), reference(positions.size()), mixed(positions.size()), fallback(positions.size());
+    state.positions = positions;
+    state.velocities = velocities;
+    GravityEngine::calculateGravitationalDerivatives(state, reference, masses);
+
+    ExecutionPolicy policy;
+    policy.precision = ForcePrecision::MIXED;
+    GravityEngine::calculateGravitationalDerivatives(state, mixed, masses, policy);
+
+    // Every pair is "close": the mixed kernel must reduce to the double path.
+    policy.closePairDistance = 1e3 * PhysicsConstants::AU;
+    GravityEngine::calculateGravitationalDerivatives(state, fallback, masses, policy);
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        ASSERT((mixed.velocities[i] - reference.velocities[i]).magnitude() < 1e-5 * reference.velocities[i].magnitude(),
+               "Mixed-precision acceleration too far from double for body " << i);
+        ASSERT((fallback.velocities[i] - reference.velocities[i]).magnitude() < 1e-12 * reference.velocities[i].magnitude(),
+               "Close-pair fallback should match double for body " << i);
+        ASSERT(approxEqualVec(mixed.positions[i], velocities[i]), "Position derivative should equal velocity");
+    }
+
+    // A body beyond float range (r^2 > FLT_MAX) must still feel and exert gravity.
+    SystemState far(positions.size() + 1), farReference(far.positions.size()), farMixed(far.positions.size());
+    std::copy(positions.begin(), positions.end(), far.positions.begin());
+    std::copy(velocities.begin(), velocities.end(), far.velocities.begin());
+    far.positions.back() = Vector3D(1e20, 0, 0);
+    std::vector<double> farMasses = masses;
+    farMasses.push_back(PhysicsConstants::SOLAR_MASS);
+    GravityEngine::calculateGravitationalDerivatives(far, farReference, farMasses);
+    policy.closePairDistance = 0.0;
+    GravityEngine::calculateGravitationalDerivatives(far, farMixed, farMasses, policy);
+    const Vector3D& expected = farReference.velocities.back();
+    ASSERT(expected.magnitude() > 0.0, "Reference acceleration of the distant body should be non-zero");
+    ASSERT((farMixed.velocities.back() - expected).magnitude() < 1e-12 * expected.magnitude(),
+           "Distant body acceleration lost in mixed precision: " << farMixed.velocities.back().x);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        ASSERT((farMixed.velocities[i] - farReference.velocities[i]).magnitude() < 1e-5 * farReference.velocities[i].magnitude(),
+               "Mixed-precision acceleration with a distant body is off for body " << i);
+    }
+    return 0;
+}
+
+int test_fused_diagnostics_match_separate_passes() {
+    using namespace Physics;
+    std::vector<Vector3D> positions, velocities;
+    std::vector<double> masses;
+    makeCluster(200, positions, velocities, masses);
+
+    SystemState state(positions.size()), reference(positions.size()), fused(positions.size());
+    state.positions = positions;
+    state.velocities = velocities;
+    GravityEngine::calculateGravitationalDerivatives(state, reference, masses);
+
+    ForceDiagnostics diagnostics;
+    GravityEngine::calculateGravitationalDerivatives(state, fused, masses, diagnostics);
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        ASSERT(approxEqualVec(fused.velocities[i], reference.velocities[i], 1e-10), "Fused acceleration differs for body " << i);
+        ASSERT(approxEqualVec(fused.positions[i], velocities[i]), "Position derivative should equal velocity");
+    }
+    double energy = GravityEngine::calculateTotalEnergy(positions, velocities, masses);
+    ASSERT(approxEqualDouble(diagnostics.totalEnergy(), energy, 1e-10), "Fused energy differs from calculateTotalEnergy");
+    ASSERT(approxEqualDouble(diagnostics.virial, diagnostics.potentialEnergy, 1e-12), "Gravitational virial should equal potential");
+    ASSERT(approxEqualVec(diagnostics.momentum, GravityEngine::calculateTotalMomentum(velocities, masses), 1e-10),
+        "Fused momentum differs from calculateTotalMomentum");
+    return 0;
+}
+
+int test_variational_derivatives_match_finite_differences() {
+    using namespace Physics;
+    std::vector<Vector3D> positions, velocities;
+    std::vector<double> masses;
+    makeCluster(6, positions, velocities, masses);
+    const size_t n = positions.size();
+
+    SystemState augmented(2 * n), derivatives;
+    for (size_t i = 0; i < n; ++i) {
+        augmented.positions[i] = positions[i];
+        augmented.velocities[i] = velocities[i];
+        augmented.positions[n + i] = Vector3D(1.0 + i, -2.0 * i, 0.5) * 1e3;
+        augmented.velocities[n + i] = Vector3D(0.1, 0.2 * i, -0.3);
+    }
+    GravityEngine::calculateVariationalDerivatives(augmented, derivatives, masses);
+
+    // Central difference of the accelerations along the position offset
+    const double eps = 1e4;
+    SystemState plus(n), minus(n), reference(n), aPlus(n), aMinus(n);
+    plus.velocities = minus.velocities = reference.velocities = velocities;
+    reference.positions = positions;
+    for (size_t i = 0; i < n; ++i) {
+        plus.positions[i] = positions[i] + augmented.positions[n + i] * (eps / 1e3);
+        minus.positions[i] = positions[i] - augmented.positions[n + i] * (eps / 1e3);
+    }
+    GravityEngine::calculateGravitationalDerivatives(reference, aPlus, masses);
+    for (size_t i = 0; i < n; ++i) {
+        ASSERT(approxEqualVec(derivatives.velocities[i], aPlus.velocities[i], 1e-12), "System acceleration differs for body " << i);
+        ASSERT(approxEqualVec(derivatives.positions[n + i], augmented.velocities[n + i]), "Tangent position derivative should be dv");
+    }
+    GravityEngine::calculateGravitationalDerivatives(plus, aPlus, masses);
+    GravityEngine::calculateGravitationalDerivatives(minus, aMinus, masses);
+    for (size_t i = 0; i < n; ++i) {
+        Vector3D numeric = (aPlus.velocities[i] - aMinus.velocities[i]) * (1e3 / (2.0 * eps));
+        ASSERT(approxEqualVec(derivatives.velocities[n + i], numeric, 1e-6, 1e-30),
+            "Tangent acceleration differs for body " << i << ": " << derivatives.velocities[n + i].toString()
+            << " vs " << numeric.toString());
+    }
+    return 0;
+}
+
+int test_megno_separates_regular_and_chaotic_orbits() {
+    using namespace Physics;
+    const double year = PhysicsConstants::yearsToSeconds(1);
+
+    // Sun and Earth: quasi-periodic, <Y> tends to 2
+    std::vector<double> masses = { PhysicsConstants::SOLAR_MASS, PhysicsConstants::EARTH_MASS };
+    SystemState kepler(2);
+    kepler.positions[1] = Vector3D(PhysicsConstants::AU, 0, 0);
+    kepler.velocities[1] = Vector3D(0, std::sqrt(PhysicsConstants::G * masses[0] / PhysicsConstants::AU), 0);
+    ChaosIndicator regular(kepler, masses);
+    regular.advance(100.0 * year, PhysicsConstants::DAY_SECONDS);
+    ASSERT(std::fabs(regular.megno() - 2.0) < 0.2, "Kepler orbit MEGNO should approach 2, got " << regular.megno());
+    SystemState plain = kepler;
+    Integrator::integrate(plain, [&masses](const SystemState& s, SystemState& d) {
+        GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+    }, 100.0 * year, PhysicsConstants::DAY_SECONDS, Integrator::RUNGE_KUTTA_4);
+    // The pair loop sums in a different order from the plain kernel, so allow rounding-level drift
+    ASSERT((regular.getPosition(1) - plain.positions[1]).magnitude() < 1e-10 * PhysicsConstants::AU,
+        "Tangent integration must not disturb the orbit");
+
+    // Burrau's Pythagorean problem (G m = 3, 4, 5 at rest on a 3-4-5 triangle): chaotic
+    std::vector<double> burrau = { 3.0 / PhysicsConstants::G, 4.0 / PhysicsConstants::G, 5.0 / PhysicsConstants::G };
+    SystemState triangle(3);
+    triangle.positions = { Vector3D(1, 3, 0), Vector3D(-2, -1, 0), Vector3D(1, -1, 0) };
+    ChaosIndicator chaotic(triangle, burrau, Integrator::DORMAND_PRINCE_45);
+    chaotic.advance(20.0, 1e-4);
+    ASSERT(chaotic.megno() > 5.0, "Pythagorean problem MEGNO should grow well past 2, got " << chaotic.megno());
+    ASSERT(chaotic.lyapunovExponent() > 0.3, "Pythagorean problem should have a positive Lyapunov exponent, got "
+        << chaotic.lyapunovExponent());
+    return 0;
+}
+
+int test_conservation_monitor_samples_during_integration() {
+    using namespace Physics;
+    using PhysicsConstants::G;
+    using PhysicsConstants::AU;
+    using PhysicsConstants::SOLAR_MASS;
+    std::vector<double> masses = { SOLAR_MASS, PhysicsConstants::EARTH_MASS };
+    SystemState state(2);
+    state.positions[1] = Vector3D(AU, 0, 0);
+    state.velocities[1] = Vector3D(0, std::sqrt(G * SOLAR_MASS / AU), 0);
+
+    std::ostringstream csv;
+    ConservationMonitor monitor(masses, &csv, 10);
+    Integrator::integrate(state, monitor.derivative(), 100.0 * 86400.0, 3600.0,
+        Integrator::RUNGE_KUTTA_4, monitor.stepCallback());
+    monitor.sample(state);
+
+    // 2400 steps sampled every 10 steps (first sample at t=0), plus the final explicit sample.
+    ASSERT(monitor.getSampleCount() == 241, "Unexpected sample count " << monitor.getSampleCount());
+    ASSERT(monitor.getLast().time == state.time, "Final sample should be at the end state");
+    ASSERT(monitor.getMaxEnergyError() < 1e-8, "RK4 energy error too large: " << monitor.getMaxEnergyError());
+    ASSERT(monitor.getLast().momentumDrift < 1e-10, "Momentum drift too large: " << monitor.getLast().momentumDrift);
+    ASSERT(std::fabs(monitor.getLast().diagnostics.virialRatio() - 1.0) < 1e-3, "Circular orbit should be virialised");
+
+    size_t lines = 0;
+    std::string line;
+    std::istringstream in(csv.str());
+    while (std::getline(in, line)) ++lines;
+    ASSERT(lines == 242, "CSV should have a header plus one line per sample");
+    return 0;
+}
+
+int test_conservation_monitor_samples_accepted_adaptive_states() {
+    using namespace Physics;
+    using PhysicsConstants::G;
+    using PhysicsConstants::AU;
+    using PhysicsConstants::SOLAR_MASS;
+    std::vector<double> masses = { SOLAR_MASS, PhysicsConstants::EARTH_MASS, 1.9e27 };
+    SystemState state(3);
+    state.positions[1] = Vector3D(AU, 0, 0);
+    state.velocities[1] = Vector3D(0, std::sqrt(G * SOLAR_MASS / AU), 0);
+    state.positions[2] = Vector3D(0, 5.2 * AU, 0);
+    state.velocities[2] = Vector3D(-std::sqrt(G * SOLAR_MASS / (5.2 * AU)), 0, 0.1 * std::sqrt(G * SOLAR_MASS / (5.2 * AU)));
+
+    // With FSAL the first derivative after a step is an intermediate stage; every sample must
+    // still be an accepted state. The sample for a step is taken before the following step ends.
+    ConservationMonitor monitor(masses);
+    StepCallback monitorStep = monitor.stepCallback();
+    std::vector<double> acceptedTimes = { state.time };
+    std::vector<double> acceptedEnergies = { GravityEngine::calculateTotalEnergy(state.positions, state.velocities, masses) };
+    size_t mismatches = 0;
+    StepCallback onStep = [&](const SystemState& s) {
+        const ConservationSample& last = monitor.getLast();
+        if (last.time != acceptedTimes.back() ||
+            std::fabs(last.diagnostics.totalEnergy() / acceptedEnergies.back() - 1.0) > 1e-12) {
+            ++mismatches;
+        }
+        acceptedTimes.push_back(s.time);
+        acceptedEnergies.push_back(GravityEngine::calculateTotalEnergy(s.positions, s.velocities, masses));
+        monitorStep(s);
+    };
+    AdaptiveStats stats = Integrator::integrateAdaptive(state, monitor.derivative(), 2.0 * 365.25 * 86400.0,
+        AdaptiveOptions(), onStep);
+    monitor.sample(state);
+
+    ASSERT(stats.acceptedSteps > 10, "Expected a few accepted steps, got " << stats.acceptedSteps);
+    ASSERT(mismatches == 0, mismatches << " samples were not taken at the accepted state");
+    ASSERT(monitor.getSampleCount() == acceptedTimes.size(), "Expected one sample per accepted state, got "
+        << monitor.getSampleCount() << " for " << acceptedTimes.size());
+    ASSERT(monitor.getLast().time == state.time, "Final sample should be at the end state");
+    return 0;
+}
+
+int test_vector_constexpr_and_fused_ops() {
+    constexpr Vector3D a(1.0, 2.0, 3.0);
+    constexpr Vector3D b(4.0, -5.0, 6.0);
+    static_assert(a.dot(b) == 12.0, "dot is usable in constant expressions");
+    static_assert(Vector3D::axpy(a, b, 2.0).y == -8.0, "axpy is usable in constant expressions");
+    static_assert((a / 0.0).z == 3.0, "division by zero keeps the vector");
+
+    Vector3D acc = a;
+    acc.addScaled(b, 0.5);
+    ASSERT(approxEqualVec(acc, a + b * 0.5), "addScaled matches the operator form");
+    acc -= b * 0.5;
+    acc += -a;
+    ASSERT(approxEqualVec(acc, Vector3D::zero()), "compound operators invert each other");
+    return 0;
+}
+
+int test_kepler_propagation_matches_integration() {
+    using namespace Physics;
+    using PhysicsConstants::G;
+    using PhysicsConstants::AU;
+    using PhysicsConstants::SOLAR_MASS;
+    const double year = PhysicsConstants::yearsToSeconds(1);
+    // The force kernel gives a massless body no acceleration, so use a 1 kg probe
+    std::vector<double> masses = { SOLAR_MASS, 1.0 };
+    const double mu = G * (SOLAR_MASS + 1.0);
+
+    // Eccentric ellipse (e = 0.6 from perihelion) and a hyperbola at 1.5x escape speed
+    const double speeds[] = { std::sqrt(1.6 * mu / AU), 1.5 * std::sqrt(2.0 * mu / AU) };
+    for (double speed : speeds) {
+        SystemState state(2);
+        state.positions[1] = Vector3D(AU, 0, 0);
+        state.velocities[1] = Vector3D(0, speed, 0.1 * speed);
+        Vector3D r = state.positions[1], v = state.velocities[1];
+        Integrator::integrate(state, [&masses](const SystemState& s, SystemState& d) {
+            GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        }, 3.7 * year, 600.0, Integrator::RUNGE_KUTTA_4);
+        // integrate() stops on a whole number of steps
+        propagateKepler(r, v, mu, state.time);
+        double error = (r - state.positions[1]).magnitude() / state.positions[1].magnitude();
+        ASSERT(error < 1e-7, "Kepler position differs from integration by " << error << " (v0 = " << speed << ")");
+        ASSERT((v - state.velocities[1]).magnitude() < 1e-7 * v.magnitude(), "Kepler velocity differs from integration");
+
+        propagateKepler(r, v, mu, -state.time);
+        ASSERT((r - Vector3D(AU, 0, 0)).magnitude() < 1e-9 * AU, "Backward propagation returns to the start");
+    }
+    return 0;
+}
+
+int test_escape_propagator_drops_ejected_body() {
+    using namespace Physics;
+    using PhysicsConstants::G;
+    using PhysicsConstants::AU;
+    using PhysicsConstants::SOLAR_MASS;
+    const double year = PhysicsConstants::yearsToSeconds(1);
+
+    // Circular equal-mass binary 1 AU wide; a 0.1 solar-mass star leaves radially on a hyperbola
+    std::vector<double> masses = { SOLAR_MASS, SOLAR_MASS, 0.1 * SOLAR_MASS };
+    const double v = 0.5 * std::sqrt(G * 2.0 * SOLAR_MASS / AU);
+    SystemState initial(3);
+    initial.positions = { Vector3D(-0.5 * AU, 0, 0), Vector3D(0.5 * AU, 0, 0), Vector3D(0, 3.0 * AU, 0) };
+    initial.velocities = { Vector3D(0, -v, 0), Vector3D(0, v, 0),
+        Vector3D(3000.0, 1.5 * std::sqrt(2.0 * G * 2.1 * SOLAR_MASS / (3.0 * AU)), 0) };
+
+    EjectionDetector detector(masses);
+    EjectionEvent event;
+    ASSERT(!detector.check(initial, event), "3 AU is not yet hierarchical (needs 30x the binary's 0.5 AU)");
+    SystemState approaching = initial;
+    approaching.positions[2] = Vector3D(0, 30.0 * AU, 0);
+    approaching.velocities[2] = initial.velocities[2] * -1.0;
+    ASSERT(!detector.check(approaching, event), "Incoming bodies are not ejections");
+
+    SystemState full = initial;
+    const double dt = 0.25 * PhysicsConstants::DAY_SECONDS;
+    const double duration = 30.0 * year;
+    Integrator::integrate(full, [&masses](const SystemState& s, SystemState& d) {
+        GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+    }, duration, dt, Integrator::RUNGE_KUTTA_4);
+
+    EscapePropagator propagator(initial, masses);
+    size_t integratedSteps = 0;
+    const size_t steps = static_cast<size_t>(duration / dt + 0.5);
+    for (size_t k = 0; k < steps; ++k) {
+        if (propagator.activeCount() > 0) ++integratedSteps;
+        propagator.step(dt);
+    }
+    ASSERT(propagator.getEvents().size() == 1 && propagator.getEvents()[0].body == 2, "The light star is ejected");
+    const EjectionEvent& ejected = propagator.getEvents()[0];
+    ASSERT(ejected.remainderBound && ejected.distance > 15.0 * AU, "Ejection leaves a bound binary behind");
+    ASSERT(propagator.isEscaped(2) && !propagator.isEscaped(0), "Escape flags");
+    ASSERT(propagator.activeCount() == 0 && integratedSteps < steps / 4,
+        "Only " << integratedSteps << " of " << steps << " steps should be integrated");
+
+    SystemState state = propagator.getState();
+    ASSERT(std::fabs(state.time - full.time) < 1e-3, "Propagator keeps time");
+    double escaperError = (state.positions[2] - full.positions[2]).magnitude() / full.positions[2].magnitude();
+    ASSERT(escaperError < 1e-3, "Escaper drifted from the full integration by " << escaperError);
+    // What remains is the phase drift from the tide neglected after the split, ~(1/distanceFactor)^3
+    for (size_t i = 0; i < 2; ++i) {
+        double error = (state.positions[i] - full.positions[i]).magnitude() / AU;
+        ASSERT(error < 2e-2, "Binary member " << i << " off by " << error << " AU");
+    }
+    Vector3D momentum = Vector3D::zero(), fullMomentum = Vector3D::zero();
+    for (size_t i = 0; i < 3; ++i) {
+        momentum.addScaled(state.velocities[i], masses[i]);
+        fullMomentum.addScaled(full.velocities[i], masses[i]);
+    }
+    ASSERT((momentum - fullMomentum).magnitude() < 1e-9 * SOLAR_MASS * v, "Barycentre motion is preserved");
+    return 0;
+}
+
 int main() {
     struct Test { const char* name; int(*func)(); };
     Test tests[] = {
@@ -116,7 +525,18 @@ int main() {
         {"calculateNetForce_three_body_symmetry", test_calculateNetForce_three_body_symmetry_zero},
         {"calculateTotalEnergy_two_body_static", test_calculateTotalEnergy_two_body_static},
         {"calculateTotalMomentum", test_calculateTotalMomentum},
-        {"calculateGravitationalDerivatives_basic", test_calculateGravitationalDerivatives_basic}
+        {"calculateGravitationalDerivatives_basic", test_calculateGravitationalDerivatives_basic},
+        {"reproducible_reductions_independent_of_thread_count", test_reproducible_reductions_independent_of_thread_count},
+        {"parallel_derivatives_match_serial", test_parallel_derivatives_match_serial},
+        {"mixed_precision_matches_double_within_float_accuracy", test_mixed_precision_matches_double_within_float_accuracy},
+        {"fused_diagnostics_match_separate_passes", test_fused_diagnostics_match_separate_passes},
+        {"conservation_monitor_samples_during_integration", test_conservation_monitor_samples_during_integration},
+        {"conservation_monitor_samples_accepted_adaptive_states", test_conservation_monitor_samples_accepted_adaptive_states},
+        {"vector_constexpr_and_fused_ops", test_vector_constexpr_and_fused_ops},
+        {"variational_derivatives_match_finite_differences", test_variational_derivatives_match_finite_differences},
+        {"megno_separates_regular_and_chaotic_orbits", test_megno_separates_regular_and_chaotic_orbits},
+        {"kepler_propagation_matches_integration", test_kepler_propagation_matches_integration},
+        {"escape_propagator_drops_ejected_body", test_escape_propagator_drops_ejected_body}
     };
 
     int failed = 0;
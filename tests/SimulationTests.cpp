@@ -0,0 +1,984 @@
+#include <iostream>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+#include "simulation/CheckpointIndex.h"
+#include "simulation/Scenario.h"
+#include "simulation/SimulationWorld.h"
+#include "simulation/StabilityMap.h"
+#include "simulation/AdaptiveStabilityMap.h"
+#include "physics/FixedSystem.h"
+#include "physics/GravityEngine.h"
+#include "physics/Integrator.h"
+#include "physics/PhysicsConstants.h"
+#include "physics/TestParticles.h"
+#include "utils/Instrumentation.h"
+#include "utils/Json.h"
+#include "utils/ThreadPool.h"
+#include "utils/Trace.h"
+
+#define ASSERT(cond, msg) \
+    do { if (!(cond)) { std::cerr << "ASSERT FAILED: " << msg << " (" << __FILE__ << ":" << __LINE__ << ")\n"; return 1; } } while(0)
+
+static const double DAY = PhysicsConstants::DAY_SECONDS;
+
+// Sun at rest, an Earth-like planet at 1 AU and a heavier planet at 5 AU.
+static Physics::SystemState makeSystem(std::vector<double>& masses) {
+    using PhysicsConstants::G;
+    using PhysicsConstants::AU;
+    using PhysicsConstants::SOLAR_MASS;
+    masses = { SOLAR_MASS, PhysicsConstants::EARTH_MASS, 1.9e27 };
+    Physics::SystemState state(3);
+    state.positions[1] = Vector3D(AU, 0, 0);
+    state.velocities[1] = Vector3D(0, std::sqrt(G * SOLAR_MASS / AU), 0);
+    state.positions[2] = Vector3D(0, 5.2 * AU, 0);
+    state.velocities[2] = Vector3D(-std::sqrt(G * SOLAR_MASS / (5.2 * AU)), 0, 0);
+    return state;
+}
+
+int test_checkpoint_spacing_is_dense_then_sparse() {
+    Simulation::CheckpointPolicy policy;
+    policy.denseInterval = DAY;
+    policy.denseSpan = 10.0 * DAY;
+    policy.growthFactor = 2.0;
+    policy.maxInterval = 64.0 * DAY;
+
+    Simulation::CheckpointIndex index(policy);
+    ASSERT(index.intervalAfter(0.0) == DAY, "Spacing should start dense");
+
+    Physics::SystemState state(1);
+    for (int step = 0; step <= 1000; ++step) {
+        state.time = step * (DAY / 4.0);
+        if (index.isDue(state.time)) index.record(state, Physics::IntegratorState());
+    }
+    // 0..10 days dense (11), then 20, 40, 80, 144, 208 (capped at 64 days).
+    ASSERT(index.size() == 16, "Unexpected checkpoint count " << index.size());
+    ASSERT(index[index.size() - 1].state.time - index[index.size() - 2].state.time == 64.0 * DAY,
+        "Spacing should be capped by maxInterval");
+    ASSERT(index.findBefore(50.0 * DAY)->state.time == 40.0 * DAY, "findBefore picked the wrong checkpoint");
+
+    // Without an explicit cap the spacing is still bounded.
+    policy.maxInterval = 0.0;
+    Simulation::CheckpointIndex defaulted(policy);
+    defaulted.record(Physics::SystemState(1), Physics::IntegratorState());
+    ASSERT(defaulted.intervalAfter(1e6 * DAY) == 64.0 * DAY, "Default cap should be 64 dense intervals");
+    return 0;
+}
+
+int test_seek_matches_continuous_integration() {
+    std::vector<double> masses;
+    Physics::SystemState initial = makeSystem(masses);
+    const double dt = 3600.0;
+
+    Simulation::CheckpointPolicy policy;
+    policy.denseInterval = DAY;
+    policy.denseSpan = 10.0 * DAY;
+    policy.maxInterval = 32.0 * DAY;
+
+    Simulation::SeekableSimulation sim(initial, masses, dt, Physics::Integrator::RUNGE_KUTTA_4, policy);
+    sim.advanceTo(400.0 * DAY);
+
+    Physics::SystemState reference = initial;
+    Physics::DerivativeFunction f = [&masses](const Physics::SystemState& s, Physics::SystemState& d) {
+        Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+    };
+    Physics::Integrator integrator;
+    for (int i = 0; i < 123 * 24; ++i) {
+        integrator.step(reference, f, dt);
+        reference.time += dt;
+    }
+
+    Physics::SystemState sought = sim.seek(reference.time);
+    ASSERT(sim.getLastSeekSteps() <= static_cast<size_t>(32 * 24), "Seek integrated more than the checkpoint gap");
+    for (size_t i = 0; i < initial.positions.size(); ++i) {
+        ASSERT(sought.positions[i].x == reference.positions[i].x &&
+               sought.positions[i].y == reference.positions[i].y &&
+               sought.velocities[i].x == reference.velocities[i].x,
+               "Seek result differs from continuous integration for body " << i);
+    }
+
+    Physics::SystemState beyond = sim.seek(500.0 * DAY + 1800.0);
+    ASSERT(std::fabs(beyond.time - (500.0 * DAY + 1800.0)) < 1e-6, "Seek past the frontier should land on t");
+    ASSERT(sim.getFrontier().time >= 500.0 * DAY, "Seek past the frontier should advance it");
+    return 0;
+}
+
+int test_adaptive_dormand_prince_closes_kepler_orbit() {
+    using PhysicsConstants::G;
+    using PhysicsConstants::AU;
+    using PhysicsConstants::SOLAR_MASS;
+    const double pi = std::acos(-1.0);
+    std::vector<double> masses = { SOLAR_MASS, 1.0 };
+    Physics::SystemState state(2);
+    state.positions[1] = Vector3D(AU, 0, 0);
+    state.velocities[1] = Vector3D(0, std::sqrt(G * SOLAR_MASS / AU), 0);
+    const Physics::SystemState initial = state;
+    const double period = 2.0 * pi * std::sqrt(AU * AU * AU / (G * SOLAR_MASS));
+
+    Physics::DerivativeFunction f = [&masses](const Physics::SystemState& s, Physics::SystemState& d) {
+        Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+    };
+    Physics::AdaptiveOptions options;
+    options.relativeTolerance = 1e-10;
+    size_t callbacks = 0;
+    Physics::AdaptiveStats stats = Physics::Integrator::integrateAdaptive(state, f, period, options,
+        [&callbacks](const Physics::SystemState&) { ++callbacks; });
+
+    ASSERT(state.time == period, "Adaptive integration should stop exactly at the end time");
+    ASSERT(callbacks == stats.acceptedSteps, "onStep should run once per accepted step");
+    ASSERT(stats.evaluations == 1 + 6 * (stats.acceptedSteps + stats.rejectedSteps),
+        "FSAL stepping should cost six evaluations per attempted step");
+    double error = (state.positions[1] - initial.positions[1]).magnitude() / AU;
+    ASSERT(error < 1e-7, "Orbit did not close: error " << error << " AU");
+
+    // Tighter tolerance must cost more and be more accurate.
+    Physics::SystemState tight = initial;
+    options.relativeTolerance = 1e-12;
+    Physics::AdaptiveStats tightStats = Physics::Integrator::integrateAdaptive(tight, f, period, options);
+    double tightError = (tight.positions[1] - initial.positions[1]).magnitude() / AU;
+    ASSERT(tightStats.acceptedSteps > stats.acceptedSteps, "Tighter tolerance should take more steps");
+    ASSERT(tightError < error, "Tighter tolerance should be more accurate");
+    return 0;
+}
+
+int test_adaptive_final_step_of_a_few_ulp() {
+    using PhysicsConstants::G;
+    using PhysicsConstants::AU;
+    using PhysicsConstants::SOLAR_MASS;
+    std::vector<double> masses = { SOLAR_MASS, 1.0 };
+    Physics::SystemState state(2);
+    state.time = 1e6;
+    state.positions[1] = Vector3D(AU, 0, 0);
+    state.velocities[1] = Vector3D(0, std::sqrt(G * SOLAR_MASS / AU), 0);
+    Physics::DerivativeFunction f = [&masses](const Physics::SystemState& s, Physics::SystemState& d) {
+        Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+    };
+
+    // The first step lands four ULP short of the end, leaving a tiny last step.
+    const double endTime = state.time + 3600.0;
+    double shortOfEnd = endTime;
+    for (int i = 0; i < 4; ++i) shortOfEnd = std::nextafter(shortOfEnd, 0.0);
+    Physics::AdaptiveOptions options;
+    options.relativeTolerance = 1e-6;
+    options.initialStep = shortOfEnd - state.time;
+    options.minStep = 1e-3;
+    Physics::AdaptiveStats stats = Physics::Integrator::integrateAdaptive(state, f, 3600.0, options);
+
+    ASSERT(state.time == endTime, "Integration should end exactly at the end time");
+    ASSERT(stats.acceptedSteps == 2, "Expected the full step plus the remainder, got " << stats.acceptedSteps);
+    ASSERT(stats.lastStep >= 3600.0, "lastStep should not come from the truncated remainder: " << stats.lastStep);
+    return 0;
+}
+
+int test_integrator_instances_are_independent() {
+    using PhysicsConstants::G;
+    using PhysicsConstants::AU;
+    using PhysicsConstants::SOLAR_MASS;
+    const double pi = std::acos(-1.0);
+    std::vector<double> masses = { SOLAR_MASS, 1.0 };
+    Physics::SystemState initial(2);
+    initial.positions[1] = Vector3D(AU, 0, 0);
+    initial.velocities[1] = Vector3D(0, std::sqrt(G * SOLAR_MASS / AU), 0);
+    const double period = 2.0 * pi * std::sqrt(AU * AU * AU / (G * SOLAR_MASS));
+    Physics::DerivativeFunction f = [&masses](const Physics::SystemState& s, Physics::SystemState& d) {
+        Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+    };
+
+    // Back-to-back runs must not share Verlet history.
+    Physics::SystemState first = initial, second = initial;
+    Physics::Integrator::integrate(first, f, period, period / 500.0, Physics::Integrator::VERLET);
+    Physics::Integrator::integrate(second, f, period, period / 500.0, Physics::Integrator::VERLET);
+    ASSERT(first.positions[1].x == second.positions[1].x && first.velocities[1].y == second.velocities[1].y,
+        "Repeated runs should be identical");
+
+    // Concurrent simulations on separate threads, each with its own instance.
+    const size_t threads = 4;
+    std::vector<Physics::SystemState> results(threads, initial);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            Physics::Integrator integrator(Physics::Integrator::VERLET);
+            integrator.advance(results[t], f, period, period / 500.0);
+        });
+    }
+    for (std::thread& w : workers) w.join();
+    for (size_t t = 0; t < threads; ++t) {
+        ASSERT(results[t].positions[1].x == first.positions[1].x && results[t].velocities[1].y == first.velocities[1].y,
+            "Thread " << t << " diverged from the serial run");
+    }
+
+    // The first step advances and the reported velocity belongs to the new positions,
+    // so both errors shrink at second order.
+    double previousError = 0.0, previousVelocityError = 0.0;
+    for (int steps : { 250, 500 }) {
+        Physics::SystemState state = initial;
+        Physics::Integrator::integrate(state, f, period, period / steps, Physics::Integrator::VERLET);
+        double error = (state.positions[1] - initial.positions[1]).magnitude();
+        double velocityError = (state.velocities[1] - initial.velocities[1]).magnitude();
+        if (previousError > 0.0) {
+            ASSERT(previousError / error > 3.0, "Verlet position error ratio " << previousError / error);
+            ASSERT(previousVelocityError / velocityError > 3.0,
+                "Verlet velocity error ratio " << previousVelocityError / velocityError);
+        }
+        previousError = error;
+        previousVelocityError = velocityError;
+    }
+
+    // captureState / restoreState continue a run exactly.
+    Physics::Integrator a(Physics::Integrator::VERLET);
+    Physics::SystemState split = initial;
+    a.advance(split, f, period / 2.0, period / 500.0);
+    Physics::Integrator b(Physics::Integrator::VERLET);
+    b.restoreState(a.captureState());
+    b.advance(split, f, period / 2.0, period / 500.0);
+    ASSERT(split.positions[1].x == first.positions[1].x, "Restored history should continue the run exactly");
+    return 0;
+}
+
+int test_instrumentation_aggregates_threads_and_exports() {
+    using namespace Utils::Instrumentation;
+    reset();
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < 4; ++w) {
+        workers.emplace_back([]() {
+            for (int i = 0; i < 1000; ++i) add(Counter::PAIR_INTERACTIONS, 3);
+            ScopedPhase phase(Phase::IO);
+            add(Counter::BYTES_WRITTEN, 10);
+        });
+    }
+    for (std::thread& t : workers) t.join();
+    add(Counter::STEPS);
+
+    Snapshot snap = snapshot();
+    ASSERT(snap.counter(Counter::PAIR_INTERACTIONS) == 12000, "Counts from exited threads were lost");
+    ASSERT(snap.counter(Counter::BYTES_WRITTEN) == 40, "Unexpected bytes_written");
+    ASSERT(snap.counter(Counter::STEPS) == 1, "Unexpected steps");
+    ASSERT(snap.calls(Phase::IO) == 4, "Each scoped phase should count one call");
+    ASSERT(snap.seconds(Phase::IO) >= 0.0 && snap.seconds(Phase::IO) < snap.wallSeconds * 4.0 + 1.0,
+        "Phase time out of range");
+
+    std::ostringstream prom;
+    writePrometheus(prom, snap);
+    ASSERT(prom.str().find("threebody_pair_interactions_total 12000") != std::string::npos, "Prometheus counter missing");
+    ASSERT(prom.str().find("threebody_phase_calls_total{phase=\"io\"} 4") != std::string::npos, "Prometheus phase missing");
+
+    // An existing snapshot is replaced in place, not removed first.
+    const char* path = "instrumentation_test.json";
+    { std::ofstream stale(path); stale << "stale"; }
+    saveSnapshot(path, snap);
+    std::ifstream in(path);
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::remove(path);
+    ASSERT(json.find("\"bytes_written\": 40") != std::string::npos, "JSON snapshot missing counter");
+    ASSERT(!std::ifstream(std::string(path) + ".tmp"), "Temporary snapshot file left behind");
+
+#ifdef THREEBODY_ENABLE_INSTRUMENTATION
+    reset();
+    std::vector<double> masses;
+    Physics::SystemState state = makeSystem(masses);
+    Physics::DerivativeFunction f = [&masses](const Physics::SystemState& s, Physics::SystemState& d) {
+        Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+    };
+    Physics::Integrator::integrate(state, f, 10 * 3600.0, 3600.0, Physics::Integrator::RUNGE_KUTTA_4);
+    snap = snapshot();
+    ASSERT(snap.counter(Counter::STEPS) == 10, "Integrator steps not counted");
+    ASSERT(snap.counter(Counter::FORCE_EVALUATIONS) == 40, "RK4 should count four force evaluations per step");
+    ASSERT(snap.counter(Counter::PAIR_INTERACTIONS) == 40 * 6, "Pair interactions not counted");
+#endif
+    reset();
+    return 0;
+}
+
+int test_parallel_for_waits_for_all_chunks_before_rethrowing() {
+    Utils::ThreadPool pool(2);
+    std::atomic<int> finished(0);
+    bool threw = false;
+    try {
+        pool.parallelFor(0, 16, 1, [&finished](size_t begin, size_t) {
+            if (begin == 0) throw std::runtime_error("first chunk fails");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            ++finished;
+        });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "The chunk's exception should reach the caller");
+    ASSERT(finished == 15, "parallelFor returned with " << 15 - finished << " chunks still pending");
+    return 0;
+}
+
+int test_trace_records_per_thread_events_as_chrome_json() {
+    Utils::Trace::start(16);
+    Utils::Trace::setThreadName("test \"main\"");
+    {
+        Utils::ThreadPool pool(3);
+        pool.parallelFor(0, 12, 1, [](size_t, size_t) {
+            Utils::Trace::Scope scope("chunk", "test");
+        });
+    }
+    for (int i = 0; i < 20; ++i) {
+        Utils::Trace::Scope scope("main_event", "test");
+    }
+    Utils::Trace::stop();
+    { Utils::Trace::Scope ignored("after_stop", "test"); }
+
+    std::ostringstream out;
+    Utils::Trace::writeChromeTrace(out);
+    std::string json = out.str();
+
+    size_t chunks = 0;
+    for (size_t pos = json.find("\"chunk\""); pos != std::string::npos; pos = json.find("\"chunk\"", pos + 1)) ++chunks;
+    size_t mainEvents = 0;
+    for (size_t pos = json.find("\"main_event\""); pos != std::string::npos; pos = json.find("\"main_event\"", pos + 1)) ++mainEvents;
+
+#ifndef THREEBODY_ENABLE_TRACING
+    ASSERT(chunks == 12, "Expected one event per chunk, got " << chunks);
+#endif
+    ASSERT(chunks >= 1, "Worker events missing");
+    ASSERT(mainEvents == 16, "Ring buffer should keep the last 16 main-thread events, got " << mainEvents);
+    ASSERT(Utils::Trace::droppedEvents() >= 4, "Overwritten events should be reported as dropped");
+    ASSERT(json.find("after_stop") == std::string::npos, "Events after stop() should not be recorded");
+    ASSERT(json.find("\"ph\":\"X\"") != std::string::npos, "Complete events missing");
+    ASSERT(json.find("test \\\"main\\\"") != std::string::npos, "Thread name should be escaped");
+    ASSERT(json.find("\"traceEvents\"") != std::string::npos && json.find("dropped_events") != std::string::npos,
+        "Chrome trace envelope missing");
+
+    // Restarting while another thread records must not touch that thread's buffer.
+    std::atomic<bool> running(true);
+    std::thread recorder([&running]() {
+        while (running) { Utils::Trace::Scope scope("background", "test"); }
+    });
+    for (int i = 0; i < 200; ++i) Utils::Trace::start(i % 2 ? 8 : 32);
+    bool threw = false;
+    try {
+        Utils::Trace::writeChromeTrace(out);
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    running = false;
+    recorder.join();
+    Utils::Trace::stop();
+    ASSERT(threw, "Exporting while tracing is enabled should be refused");
+    std::ostringstream restarted;
+    Utils::Trace::writeChromeTrace(restarted);
+    ASSERT(restarted.str().find("\"chunk\"") == std::string::npos, "start() should discard the previous trace");
+    return 0;
+}
+
+int test_json_parse_and_round_trip() {
+    Utils::JsonValue doc = Utils::JsonValue::parse(
+        "{ \"name\": \"figure \\\"8\\\"\", \"masses\": [1, 2.5e-3, -4], \"nested\": {\"ok\": true, \"none\": null},"
+        "  \"unicode\": \"\\u00e9\" }");
+    ASSERT(doc.isObject() && doc.size() == 4, "Expected four members");
+    ASSERT(doc.at("name").asString() == "figure \"8\"", "String escapes not decoded");
+    ASSERT(doc.at("masses").size() == 3 && doc.at("masses")[1].asNumber() == 2.5e-3, "Array parsing failed");
+    ASSERT(doc.at("nested").at("ok").asBool() && doc.at("nested").at("none").isNull(), "Nested object parsing failed");
+    ASSERT(doc.at("unicode").asString() == "\xC3\xA9", "\\u escape should decode to UTF-8");
+    ASSERT(doc.numberOr("missing", 7.0) == 7.0 && doc.find("missing") == nullptr, "Fallback lookup failed");
+
+    std::ostringstream out;
+    doc.write(out);
+    Utils::JsonValue again = Utils::JsonValue::parse(out.str());
+    ASSERT(again.at("name").asString() == doc.at("name").asString() &&
+           again.at("masses")[1].asNumber() == 2.5e-3, "Round trip changed values");
+
+    const char* bad[] = { "{\"a\": }", "[1, 2", "{\"a\" 1}", "\"open", "1 2", "{\"a\": 1e}" };
+    for (const char* text : bad) {
+        bool threw = false;
+        try { Utils::JsonValue::parse(text); } catch (const std::runtime_error&) { threw = true; }
+        ASSERT(threw, "Malformed JSON accepted: " << text);
+    }
+    bool threw = false;
+    try { doc.at("name").asNumber(); } catch (const std::runtime_error&) { threw = true; }
+    ASSERT(threw, "Type mismatch should throw");
+    return 0;
+}
+
+int test_fixed_size_path_matches_dynamic_integrator() {
+    std::vector<double> masses;
+    Physics::SystemState initial = makeSystem(masses);
+
+    const Physics::Integrator::Method methods[] = {
+        Physics::Integrator::RUNGE_KUTTA_4, Physics::Integrator::VERLET, Physics::Integrator::DORMAND_PRINCE_45
+    };
+    for (Physics::Integrator::Method method : methods) {
+        Physics::SystemState dynamic = initial;
+        Physics::Integrator::integrate(dynamic,
+            [&masses](const Physics::SystemState& s, Physics::SystemState& d) {
+                Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+            }, 200.0 * DAY, DAY, method);
+
+        Physics::SystemState fixed = initial;
+        ASSERT(Physics::integrateFixedSize(fixed, masses, 200.0 * DAY, DAY, method), "N=3 has a fixed-size path");
+        ASSERT(std::fabs(fixed.time - dynamic.time) < 1e-6, "time advances identically");
+        for (size_t i = 0; i < 3; ++i) {
+            double scale = dynamic.positions[i].magnitude() + PhysicsConstants::AU;
+            ASSERT((fixed.positions[i] - dynamic.positions[i]).magnitude() < 1e-9 * scale,
+                "fixed and dynamic positions agree for method " << method);
+            double vscale = dynamic.velocities[i].magnitude() + 1.0;
+            ASSERT((fixed.velocities[i] - dynamic.velocities[i]).magnitude() < 1e-9 * vscale,
+                "fixed and dynamic velocities agree for method " << method);
+        }
+    }
+
+    Physics::FixedSystemState<3> converted(initial);
+    Physics::SystemState back = converted.toDynamic();
+    ASSERT(back.positions[2].y == initial.positions[2].y && back.velocities[1].y == initial.velocities[1].y,
+        "conversion round-trips exactly");
+
+    bool threw = false;
+    try {
+        Physics::FixedSystemState<4> wrong(initial);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT(threw, "size mismatch is rejected");
+
+    Physics::SystemState large(7);
+    std::vector<double> largeMasses(7, 1.0);
+    ASSERT(!Physics::integrateFixedSize(large, largeMasses, 1.0, 0.1, Physics::Integrator::RUNGE_KUTTA_4),
+        "unsupported N falls back to the caller");
+    return 0;
+}
+
+int test_simulation_world_integrates_in_place() {
+    std::vector<double> masses;
+    Physics::SystemState initial = makeSystem(masses);
+    const char* names[] = { "Sun", "Earth", "Jupiter" };
+
+    Simulation::SimulationWorld world(Physics::Integrator::RUNGE_KUTTA_4);
+    for (size_t i = 0; i < 3; ++i) {
+        world.addBody(names[i], masses[i], 1.0e6, initial.positions[i], initial.velocities[i]);
+    }
+    ASSERT(world.size() == 3 && world.find("Jupiter") == 2, "Bodies are registered in order");
+
+    Simulation::BodyView earth = world.body(world.find("Earth"));
+    ASSERT(&earth.getPosition() == &world.getState().positions[1], "Views reference the contiguous state");
+    ASSERT(&earth.getName() == &world.getName(1), "Names are not copied");
+
+    world.advance(100.0 * DAY, DAY);
+    Physics::SystemState reference = initial;
+    Physics::Integrator::integrate(reference,
+        [&masses](const Physics::SystemState& s, Physics::SystemState& d) {
+            Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        }, 100.0 * DAY, DAY, Physics::Integrator::RUNGE_KUTTA_4);
+    ASSERT(earth.getPosition().x == reference.positions[1].x && earth.getVelocity().y == reference.velocities[1].y,
+        "World integration matches integrating the SystemState directly");
+    ASSERT(world.getTime() == reference.time, "World time advances");
+
+    Physics::SystemState derivatives(3);
+    Physics::GravityEngine::calculateGravitationalDerivatives(world.getState(), derivatives, masses);
+    ASSERT(earth.getAcceleration().x == derivatives.velocities[1].x, "Acceleration is evaluated at the current state");
+
+    CelestialBody exported("Earth", masses[1], 6.371e6);
+    world.copyTo(1, exported);
+    ASSERT(exported.getPosition().x == earth.getPosition().x, "copyTo writes the state back");
+    ASSERT(world.addBody(exported) == 3 && world.body(3).getRadius() == 6.371e6, "CelestialBody can be imported");
+
+    bool threw = false;
+    try {
+        world.find("Pluto");
+    } catch (const std::out_of_range&) {
+        threw = true;
+    }
+    ASSERT(threw, "Unknown names should throw");
+    return 0;
+}
+
+int test_scenario_loader_reads_json_and_csv() {
+    const std::string json = R"({
+        "defaults": { "integrator": "verlet", "step": 3600, "duration": 864000,
+                      "tolerance": { "relative": 1e-8 } },
+        "scenarios": [
+            { "name": "binary",
+              "bodies": [ { "name": "A", "mass": 2e30, "position": [0, 0, 0] },
+                          { "name": "B", "mass": 1e24, "radius": 6e6,
+                            "position": [1.5e11, 0, 0], "velocity": [0, 29780, 0] } ] },
+            { "integrator": "adaptive", "duration": 1e5,
+              "bodies": [ { "mass": 1e30 }, { "mass": 1e30, "position": [1e11, 0, 0] } ] }
+        ]
+    })";
+    std::vector<Simulation::Scenario> scenarios = Simulation::ScenarioLoader::parseJson(json);
+    ASSERT(scenarios.size() == 2, "Two JSON scenarios");
+    ASSERT(scenarios[0].name == "binary" && scenarios[0].method == Physics::Integrator::VERLET, "Defaults apply");
+    ASSERT(scenarios[0].bodies[1].radius == 6e6 && scenarios[0].bodies[1].velocity.y == 29780.0, "Body fields");
+    ASSERT(scenarios[1].adaptive && scenarios[1].duration == 1e5, "Scenario fields override defaults");
+    ASSERT(scenarios[1].tolerances.relativeTolerance == 1e-8, "Tolerance defaults apply");
+    ASSERT(scenarios[1].name == "scenario1" && scenarios[1].bodies[0].name == "body0", "Missing names are generated");
+
+    const std::string csv =
+        "# sweep\n"
+        "scenario,name,mass,x,y,z,vx,vy,vz,method,step,duration\n"
+        "s0,Sun,1.989e30,0,0,0,0,0,0,rk4,3600,86400\n"
+        "s0,Earth,5.97e24,1.496e11,0,0,0,29780,0,,,\n"
+        "\n"
+        "s1, Sun ,1.989e30,0,0,0,0,0,0,euler,60,600\r\n"
+        "s1,Comet,1e12,2e11,0,0,0,1e4,0,,,\n";
+    scenarios = Simulation::ScenarioLoader::parseCsv(csv);
+    ASSERT(scenarios.size() == 2, "Two CSV scenarios");
+    ASSERT(scenarios[0].bodies.size() == 2 && scenarios[0].bodies[1].position.x == 1.496e11, "CSV body values");
+    ASSERT(scenarios[1].method == Physics::Integrator::EULER && scenarios[1].timeStep == 60.0, "CSV scenario columns");
+    ASSERT(scenarios[1].bodies[0].name == "Sun", "CSV fields are trimmed");
+
+    bool threw = false;
+    try {
+        Simulation::ScenarioLoader::parseCsv("scenario,name,mass,x,y,z,vx,vy,vz\ns,a,1,2,3,oops,0,0,0\n");
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()).find("line 2") != std::string::npos;
+    }
+    ASSERT(threw, "Malformed CSV numbers report the line");
+
+    threw = false;
+    try {
+        Simulation::ScenarioLoader::parseJson(R"({"duration": 10, "bodies": [{"mass": 1}], "integrator": "leapfrog"})");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "Unknown integrators are rejected");
+
+    const std::string shared = R"({
+        "defaults": { "duration": 10, "step": 1, "bodies": [{"mass": 1}],
+                      "outputs": [{"type": "final_state_json", "path": "out_{name}.json"}] },
+        "scenarios": [ {"name": "a"}, {"name": "b"} ]
+    })";
+    scenarios = Simulation::ScenarioLoader::parseJson(shared);
+    ASSERT(scenarios[0].sinks[0].path == "out_a.json" && scenarios[1].sinks[0].path == "out_b.json",
+        "{name} expands to the scenario name");
+
+    std::string clashing = shared;
+    clashing.replace(clashing.find("{name}"), 6, "all");
+    threw = false;
+    try {
+        Simulation::ScenarioLoader::parseJson(clashing);
+    } catch (const std::runtime_error& e) {
+        threw = std::string(e.what()).find("out_all.json") != std::string::npos;
+    }
+    ASSERT(threw, "Scenarios sharing an output file are rejected");
+    return 0;
+}
+
+int test_scenario_run_writes_outputs() {
+    std::vector<double> masses;
+    Physics::SystemState initial = makeSystem(masses);
+    Simulation::Scenario scenario;
+    scenario.name = "solar";
+    for (size_t i = 0; i < 3; ++i) {
+        Simulation::ScenarioBody body;
+        body.name = "b" + std::to_string(i);
+        body.mass = masses[i];
+        body.position = initial.positions[i];
+        body.velocity = initial.velocities[i];
+        scenario.bodies.push_back(body);
+    }
+    scenario.timeStep = DAY;
+    scenario.duration = 30.0 * DAY;
+    Simulation::ScenarioSink trajectory;
+    trajectory.type = Simulation::ScenarioSink::TRAJECTORY_CSV;
+    trajectory.path = "scenario_test_trajectory.csv";
+    trajectory.every = 10;
+    Simulation::ScenarioSink final;
+    final.type = Simulation::ScenarioSink::FINAL_STATE_JSON;
+    final.path = "scenario_test_final.json";
+    scenario.sinks = { trajectory, final };
+
+    Simulation::ScenarioResult result = Simulation::runScenario(scenario);
+    Physics::SystemState reference = initial;
+    Physics::Integrator::integrate(reference,
+        [&masses](const Physics::SystemState& s, Physics::SystemState& d) {
+            Physics::GravityEngine::calculateGravitationalDerivatives(s, d, masses);
+        }, 30.0 * DAY, DAY);
+    ASSERT(result.steps == 30, "One callback per step");
+    ASSERT(result.finalState.positions[1].x == reference.positions[1].x, "Scenario run matches direct integration");
+    ASSERT(result.relativeEnergyError < 1e-8, "Energy error " << result.relativeEnergyError);
+
+    std::ifstream csv(trajectory.path);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(csv, line)) ++lines;
+    ASSERT(lines == 1 + 3 * 4, "Trajectory has a header plus the initial and every 10th step: " << lines);
+
+    Utils::JsonValue saved = Utils::JsonValue::parseFile(final.path);
+    ASSERT(saved.at("bodies")[1].at("position")[0].asNumber() == reference.positions[1].x, "Final state round-trips");
+    csv.close();
+    std::remove(trajectory.path.c_str());
+    std::remove(final.path.c_str());
+    return 0;
+}
+
+// Two bodies on a head-on course, closing at 20 km/s from 1e8 m apart.
+static Simulation::SimulationWorld makeHeadOn(Simulation::CollisionResponse response) {
+    Simulation::SimulationWorld world(Physics::Integrator::RUNGE_KUTTA_4);
+    world.addBody("heavy", 3.0e24, 1.0e7, Vector3D(0, 0, 0), Vector3D(1.0e4, 0, 0));
+    world.addBody("light", 1.0e24, 1.0e7, Vector3D(1.0e8, 1.0e6, 0), Vector3D(-1.0e4, 0, 0));
+    world.addBody("bystander", 1.0e20, 1.0e3, Vector3D(0, 1.0e10, 0), Vector3D(0, 0, 0));
+    world.setCollisionResponse(response);
+    return world;
+}
+
+int test_collisions_merge_conserving_momentum() {
+    Simulation::SimulationWorld world = makeHeadOn(Simulation::CollisionResponse::MERGE);
+    auto momentum = [&world]() {
+        Vector3D p;
+        for (size_t i = 0; i < world.size(); ++i) p.addScaled(world.getVelocity(i), world.getMass(i));
+        return p;
+    };
+    Vector3D before = momentum();
+    double massBefore = world.getMass(0) + world.getMass(1) + world.getMass(2);
+
+    world.advance(6000.0, 60.0);
+    ASSERT(world.size() == 2, "Colliding bodies should merge: " << world.size());
+    ASSERT(world.getCollisions().size() == 1, "One collision recorded");
+    const Simulation::CollisionEvent& event = world.getCollisions()[0];
+    ASSERT(event.first == "heavy" && event.second == "light", "Merge keeps the heavier body");
+    ASSERT(event.time < 4200.0, "Collision detected late: " << event.time);
+    ASSERT(world.getName(0) == "heavy" && world.getName(1) == "bystander", "Survivors are compacted in order");
+    ASSERT(std::fabs(world.getMass(0) + world.getMass(1) - massBefore) < 1e-6 * massBefore, "Mass is conserved");
+    ASSERT((momentum() - before).magnitude() < 1e-9 * 4.0e28, "Momentum is conserved");
+    ASSERT(std::fabs(world.getRadius(0) - std::cbrt(2.0) * 1.0e7) < 1.0, "Volumes add");
+    ASSERT(world.getState().positions.size() == 2 && world.getMasses().size() == 2, "Arrays are compacted");
+    return 0;
+}
+
+int test_collisions_stop_and_swept_detection() {
+    Simulation::SimulationWorld world = makeHeadOn(Simulation::CollisionResponse::STOP);
+    world.advance(6000.0, 60.0);
+    ASSERT(world.isHalted() && world.getCollisions().size() == 1, "STOP should halt at the collision");
+    ASSERT(world.size() == 3, "STOP must not merge");
+    double haltedAt = world.getTime();
+    world.advance(6000.0, 60.0);
+    ASSERT(world.getTime() == haltedAt, "A halted world does not advance");
+
+    // A fast body crossing a planet within one step is still caught by the swept test.
+    std::vector<Vector3D> previous = { Vector3D(0, 0, 0), Vector3D(-1.0e8, 0, 0) };
+    std::vector<Vector3D> current = { Vector3D(0, 0, 0), Vector3D(1.0e8, 0, 0) };
+    std::vector<double> radii = { 6.0e6, 1.0e3 };
+    Physics::CollisionDetector detector;
+    const std::vector<Physics::CollisionPair>& pairs = detector.detect(previous, current, radii);
+    ASSERT(pairs.size() == 1 && std::fabs(pairs[0].fraction - 0.47) < 1e-3, "Tunnelling body is detected");
+    return 0;
+}
+
+int test_collision_grid_matches_brute_force() {
+    unsigned long long seed = 777;
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>(seed >> 11) / 9007199254740992.0;
+    };
+    const size_t n = 3000;
+    std::vector<Vector3D> previous(n), current(n);
+    std::vector<double> radii(n);
+    for (size_t i = 0; i < n; ++i) {
+        previous[i] = Vector3D(next(), next(), next()) * 1.0e9;
+        current[i] = previous[i] + Vector3D(next() - 0.5, next() - 0.5, next() - 0.5) * 2.0e7;
+        radii[i] = 1.0e6 * (0.2 + next() * next() * 5.0);
+    }
+    radii[17] = 1.5e8;   // one star-sized body takes the large-body path
+    current[42] = previous[42];
+
+    Physics::CollisionDetector detector;
+    std::vector<Physics::CollisionPair> grid = detector.detect(previous, current, radii);
+    std::vector<Physics::CollisionPair> brute = Physics::CollisionDetector::detectBruteForce(previous, current, radii);
+    ASSERT(grid.size() == brute.size(), "Grid found " << grid.size() << " pairs, brute force " << brute.size());
+    ASSERT(!brute.empty(), "The test configuration should contain collisions");
+    for (size_t k = 0; k < grid.size(); ++k) {
+        ASSERT(grid[k].i == brute[k].i && grid[k].j == brute[k].j && grid[k].fraction == brute[k].fraction,
+            "Pair " << k << " differs");
+    }
+    return 0;
+}
+
+int test_test_particles_follow_massive_bodies() {
+    using PhysicsConstants::G;
+    using PhysicsConstants::AU;
+    using PhysicsConstants::SOLAR_MASS;
+    std::vector<double> masses;
+    const Physics::SystemState initial = makeSystem(masses);
+    // Drop the Earth from the massive set: Sun + Jupiter only.
+    Physics::SystemState massive(2);
+    massive.positions = { initial.positions[0], initial.positions[2] };
+    massive.velocities = { initial.velocities[0], initial.velocities[2] };
+    std::vector<double> massiveMasses = { masses[0], masses[2] };
+
+    // Reference: the probe as a 1 kg body of a full three-body integration with a short RK4 step.
+    const Vector3D probePosition(0, -1.5 * AU, 0);
+    const Vector3D probeVelocity(std::sqrt(G * SOLAR_MASS / (1.5 * AU)), 0, 0);
+    Physics::SystemState full(3);
+    full.positions = { massive.positions[0], massive.positions[1], probePosition };
+    full.velocities = { massive.velocities[0], massive.velocities[1], probeVelocity };
+    std::vector<double> fullMasses = { masses[0], masses[2], 1.0 };
+    Physics::Integrator::integrate(full,
+        [&fullMasses](const Physics::SystemState& s, Physics::SystemState& d) {
+            Physics::GravityEngine::calculateGravitationalDerivatives(s, d, fullMasses);
+        }, 365.0 * DAY, 600.0);
+
+    Physics::TestParticleSwarm serial;
+    for (int k = 0; k < 3000; ++k) {
+        double scale = 1.0 + 1e-4 * k;
+        serial.add(probePosition * scale, probeVelocity * (1.0 / std::sqrt(scale)));
+    }
+    Physics::TestParticleSwarm parallel = serial;
+
+    Physics::SystemState massiveSerial = massive, massiveParallel = massive;
+    Physics::Integrator serialIntegrator, parallelIntegrator;
+    serial.advance(massiveSerial, massiveMasses, serialIntegrator, 365.0 * DAY, 3600.0);
+    Utils::ThreadPool pool(3);
+    parallel.advance(massiveParallel, massiveMasses, parallelIntegrator, 365.0 * DAY, 3600.0, &pool);
+
+    double error = (serial.getPosition(0) - full.positions[2]).magnitude() / AU;
+    ASSERT(error < 1e-5, "Probe drifted from the full integration by " << error << " AU");
+    ASSERT((massiveSerial.positions[1] - full.positions[1]).magnitude() < 1e-6 * AU,
+        "Massive bodies are unaffected by the swarm");
+    for (size_t i = 0; i < serial.size(); ++i) {
+        ASSERT(serial.getPosition(i).x == parallel.getPosition(i).x && serial.getVelocity(i).y == parallel.getVelocity(i).y,
+            "Parallel swarm step differs for particle " << i);
+    }
+    return 0;
+}
+
+int test_scenario_ejection_modes() {
+    using PhysicsConstants::G;
+    using PhysicsConstants::AU;
+    using PhysicsConstants::SOLAR_MASS;
+    // Circular binary 1 AU wide and a light star leaving on a hyperbola
+    const double v = 0.5 * std::sqrt(G * 2.0 * SOLAR_MASS / AU);
+    const double vEscape = 1.5 * std::sqrt(2.0 * G * 2.1 * SOLAR_MASS / (3.0 * AU));
+    std::ostringstream json;
+    json.precision(17);
+    json << R"({"integrator": "rk4", "step": 21600, "duration": )" << 20.0 * 365.25 * DAY << R"(,
+        "bodies": [ {"name": "A", "mass": )" << SOLAR_MASS << ", \"position\": [" << -0.5 * AU << ", 0, 0], \"velocity\": [0, " << -v << R"(, 0]},
+                    {"name": "B", "mass": )" << SOLAR_MASS << ", \"position\": [" << 0.5 * AU << ", 0, 0], \"velocity\": [0, " << v << R"(, 0]},
+                    {"name": "C", "mass": )" << 0.1 * SOLAR_MASS << ", \"position\": [0, " << 3.0 * AU << ", 0], \"velocity\": [3000, " << vEscape << R"(, 0]} ] })";
+    Simulation::Scenario plain = Simulation::ScenarioLoader::parseJson(json.str())[0];
+    Simulation::Scenario stop = plain, analytic = plain;
+    stop.ejection = Simulation::EjectionMode::STOP;
+    analytic.ejection = Simulation::EjectionMode::ANALYTIC;
+
+    Simulation::ScenarioResult full = Simulation::runScenario(plain);
+    Simulation::ScenarioResult stopped = Simulation::runScenario(stop);
+    Simulation::ScenarioResult propagated = Simulation::runScenario(analytic);
+    ASSERT(full.ejections.empty(), "Detection is off by default");
+    ASSERT(stopped.ejections.size() == 1 && stopped.ejections[0].body == 2, "STOP reports the ejected star");
+    ASSERT(stopped.steps < full.steps / 4 && stopped.finalState.time == stopped.ejections[0].time, "STOP ends at the detection");
+    ASSERT(propagated.ejections.size() == 1 && propagated.steps == full.steps, "ANALYTIC runs to the end");
+    ASSERT(propagated.finalState.time == full.finalState.time, "ANALYTIC keeps the clock");
+    double error = (propagated.finalState.positions[2] - full.finalState.positions[2]).magnitude() /
+        full.finalState.positions[2].magnitude();
+    ASSERT(error < 1e-3, "Analytic escaper is off by " << error);
+
+    bool threw = false;
+    try {
+        Simulation::ScenarioLoader::parseJson(R"({"integrator": "adaptive", "duration": 10, "ejection": "stop", "bodies": [{"mass": 1}]})");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "Ejection handling requires a fixed step");
+    return 0;
+}
+
+// Equal-mass circular binary 1 AU apart with a planet around the first star;
+// a cells x cells map over semi-major axis and eccentricity spanning the stable and unstable zones.
+static Simulation::StabilityMapConfig makeStabilityMap(int cells = 4) {
+    using PhysicsConstants::G;
+    using PhysicsConstants::AU;
+    using PhysicsConstants::SOLAR_MASS;
+    std::ostringstream json;
+    json.precision(17);
+    const double v = 0.5 * std::sqrt(G * 2.0 * SOLAR_MASS / AU);
+    json << R"({"system": {"integrator": "rk4", "step": 21600, "duration": )" << 20.0 * 258.0 * DAY << R"(,
+        "bodies": [ {"name": "A", "mass": )" << SOLAR_MASS << R"(, "radius": 7e8, "position": [)" << -0.5 * AU << R"(, 0, 0],
+                     "velocity": [0, )" << -v << R"(, 0]},
+                    {"name": "B", "mass": )" << SOLAR_MASS << R"(, "radius": 7e8, "position": [)" << 0.5 * AU << R"(, 0, 0],
+                     "velocity": [0, )" << v << R"(, 0]} ] },
+        "planet": {"host": "A", "mass": 6e24, "radius": 6.4e6},
+        "x": {"parameter": "a", "min": )" << 0.1 * AU << R"(, "max": )" << 0.7 * AU << R"(, "cells": )" << cells << R"(},
+        "y": {"parameter": "eccentricity", "min": 0, "max": 0.6, "cells": )" << cells << R"(},
+        "tile": 2, "escape_distance": )" << 3.0 * AU << "}";
+    return Simulation::StabilityMapConfig::fromJson(Utils::JsonValue::parse(json.str()));
+}
+
+static std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+int test_stability_map_resumes_and_detects_instability() {
+    Simulation::StabilityMapConfig config = makeStabilityMap();
+    ASSERT(config.x.parameter == Simulation::StabilityParameter::SEMI_MAJOR_AXIS && config.planet.host == 0,
+        "Axis and host names are parsed");
+    ASSERT(config.masses().size() == 3 && config.initialState(config.x.min, 0.0).positions.size() == 3,
+        "The planet is appended as the last body");
+
+    const std::string fullPath = "stability_full.bin", resumedPath = "stability_resumed.bin";
+    std::remove(fullPath.c_str());
+    std::remove(resumedPath.c_str());
+
+    Utils::ThreadPool pool(3);
+    Simulation::StabilityRunOptions options;
+    options.pool = &pool;
+    size_t full = 0;
+    {
+        Simulation::StabilityRaster raster(fullPath, config);
+        ASSERT(raster.tileCount() == 4, "A 4x4 grid in 2x2 tiles");
+        full = Simulation::runStabilityMap(config, raster, options);
+        ASSERT(full == 4 && raster.tilesDone() == 4, "All tiles computed");
+
+        std::vector<Simulation::CellResult> bottom = raster.readRow(0);
+        ASSERT(bottom[0].outcome == Simulation::CellOutcome::SURVIVED, "Close, nearly circular planet survives");
+        ASSERT(bottom[0].endTime == 5160.0 * DAY, "Survivors run to the time limit");
+        std::vector<Simulation::CellResult> top = raster.readRow(3);
+        ASSERT(top[3].outcome == Simulation::CellOutcome::EJECTED || top[3].outcome == Simulation::CellOutcome::COLLIDED,
+            "Wide, eccentric planet is unstable, got " << Simulation::toString(top[3].outcome));
+        ASSERT(top[3].endTime < 5160.0 * DAY, "Unstable cells stop early");
+
+        raster.writeImage("stability.pgm", config.system.duration, config.system.timeStep);
+        ASSERT(readFile("stability.pgm").compare(0, 11, "P5\n4 4\n255\n") == 0, "PGM header");
+        ASSERT(readFile("stability.pgm").size() == 11 + 16, "One byte per cell");
+    }
+
+    // Interrupt after the first tile, then resume from the file.
+    std::atomic<bool> stop(false);
+    options.pool = nullptr;
+    options.stop = &stop;
+    options.onTile = [&stop](size_t, size_t, size_t) { stop = true; };
+    {
+        Simulation::StabilityRaster raster(resumedPath, config);
+        ASSERT(Simulation::runStabilityMap(config, raster, options) == 1, "Stop flag halts after one tile");
+    }
+    options.stop = nullptr;
+    size_t progress = 0;
+    options.onTile = [&progress](size_t, size_t done, size_t total) { progress = done * 10 + total; };
+    {
+        Simulation::StabilityRaster raster(resumedPath, config);
+        ASSERT(raster.tilesDone() == 1, "Finished tile survives reopening");
+        ASSERT(Simulation::runStabilityMap(config, raster, options) == 3, "Resume computes only the missing tiles");
+        ASSERT(progress == 44, "Progress counts tiles from the earlier run");
+    }
+    ASSERT(readFile(fullPath) == readFile(resumedPath), "Resumed raster matches the uninterrupted one");
+
+    config.planet.mass *= 2.0;
+    bool threw = false;
+    try {
+        Simulation::StabilityRaster raster(fullPath, config);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    ASSERT(threw, "A raster from a different configuration is rejected");
+
+    std::remove(fullPath.c_str());
+    std::remove(resumedPath.c_str());
+    std::remove("stability.pgm");
+    return 0;
+}
+
+int test_adaptive_stability_map_matches_uniform_grid() {
+    const Simulation::StabilityMapConfig config = makeStabilityMap(16);
+    Utils::ThreadPool pool(3);
+    std::vector<Simulation::CellResult> uniform(256);
+    pool.parallelFor(0, uniform.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            uniform[i] = Simulation::runStabilityCell(config, config.x.valueAt(double(i % 16)), config.y.valueAt(double(i / 16)));
+        }
+    });
+
+    Simulation::AdaptiveMapOptions options;
+    options.levels = 2;
+    options.pool = &pool;
+    Simulation::AdaptiveStabilityMap map(config, options);
+    map.run();
+
+    size_t area = 0, finest = 0;
+    for (const Simulation::AdaptiveLeaf& leaf : map.leaves()) {
+        area += size_t(leaf.size) * leaf.size;
+        if (leaf.size == 1) ++finest;
+    }
+    ASSERT(area == 256, "Leaves tile the fine grid exactly");
+    ASSERT(finest > 0, "The stability boundary is refined to full resolution");
+    ASSERT(map.getSimulations() < 180, "Refinement saved simulations: " << map.getSimulations() << " of 256");
+
+    size_t mismatched = 0;
+    for (uint32_t y = 0; y < 16; ++y) {
+        for (uint32_t x = 0; x < 16; ++x) {
+            const Simulation::CellResult& cell = map.at(x, y);
+            if (cell.outcome != uniform[y * 16 + x].outcome) ++mismatched;
+            if (map.blockSizeAt(x, y) == 1) {
+                ASSERT(cell.endTime == uniform[y * 16 + x].endTime, "Finest cells are the uniform grid's cells");
+            }
+        }
+    }
+    ASSERT(mismatched <= 8, mismatched << " of 256 cells disagree with the uniform grid");
+
+    std::ostringstream csv;
+    map.writeLeaves(csv);
+    ASSERT(csv.str().compare(0, 5, "x,y,s") == 0, "Leaf CSV header");
+
+    options.pool = nullptr;
+    options.maxSimulations = 20;
+    Simulation::AdaptiveStabilityMap capped(config, options);
+    capped.run();
+    ASSERT(capped.getSimulations() == 20, "Budget allows the coarse grid plus one refinement");
+    ASSERT(capped.blockSizeAt(0, 0) == 4 || capped.blockSizeAt(0, 0) == 2, "Capped map still covers the grid");
+
+    bool threw = false;
+    try {
+        options.levels = 3;
+        Simulation::AdaptiveStabilityMap(makeStabilityMap(12), options);
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    ASSERT(threw, "Grid must be divisible by 2^levels");
+    return 0;
+}
+
+int main() {
+    struct Test { const char* name; int(*func)(); };
+    Test tests[] = {
+        {"checkpoint_spacing_is_dense_then_sparse", test_checkpoint_spacing_is_dense_then_sparse},
+        {"seek_matches_continuous_integration", test_seek_matches_continuous_integration},
+        {"adaptive_dormand_prince_closes_kepler_orbit", test_adaptive_dormand_prince_closes_kepler_orbit},
+        {"adaptive_final_step_of_a_few_ulp", test_adaptive_final_step_of_a_few_ulp},
+        {"integrator_instances_are_independent", test_integrator_instances_are_independent},
+        {"instrumentation_aggregates_threads_and_exports", test_instrumentation_aggregates_threads_and_exports},
+        {"parallel_for_waits_for_all_chunks_before_rethrowing", test_parallel_for_waits_for_all_chunks_before_rethrowing},
+        {"trace_records_per_thread_events_as_chrome_json", test_trace_records_per_thread_events_as_chrome_json},
+        {"json_parse_and_round_trip", test_json_parse_and_round_trip},
+        {"fixed_size_path_matches_dynamic_integrator", test_fixed_size_path_matches_dynamic_integrator},
+        {"simulation_world_integrates_in_place", test_simulation_world_integrates_in_place},
+        {"scenario_loader_reads_json_and_csv", test_scenario_loader_reads_json_and_csv},
+        {"scenario_run_writes_outputs", test_scenario_run_writes_outputs},
+        {"collisions_merge_conserving_momentum", test_collisions_merge_conserving_momentum},
+        {"collisions_stop_and_swept_detection", test_collisions_stop_and_swept_detection},
+        {"collision_grid_matches_brute_force", test_collision_grid_matches_brute_force},
+        {"test_particles_follow_massive_bodies", test_test_particles_follow_massive_bodies},
+        {"scenario_ejection_modes", test_scenario_ejection_modes},
+        {"stability_map_resumes_and_detects_instability", test_stability_map_resumes_and_detects_instability},
+        {"adaptive_stability_map_matches_uniform_grid", test_adaptive_stability_map_matches_uniform_grid}
+    };
+
+    int failed = 0;
+    for (auto &t : tests) {
+        std::cout << "[ RUN      ] " << t.name << std::endl;
+        int r = t.func();
+        if (r == 0) {
+            std::cout << "[       OK ] " << t.name << std::endl;
+        } else {
+            std::cout << "[  FAILED  ] " << t.name << std::endl;
+            ++failed;
+        }
+    }
+
+    if (failed == 0) {
+        std::cout << "ALL TESTS PASSED\n";
+        return 0;
+    } else {
+        std::cerr << failed << " test(s) failed\n";
+        return 1;
+    }
+}